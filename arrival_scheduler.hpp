@@ -0,0 +1,106 @@
+/// @file arrival_scheduler.hpp
+/// @brief Планировщик прибытия запросов (открытая модель нагрузки)
+
+#ifndef ARRIVAL_SCHEDULER_HPP
+#define ARRIVAL_SCHEDULER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "fast_random.hpp"
+
+/**
+ * @enum ArrivalProcess
+ * @brief Распределение моментов прибытия запросов
+ */
+enum class ArrivalProcess {
+    Uniform,    //< Равномерные интервалы 1/rate
+    Poisson     //< Пуассоновский поток (экспоненциальные интервалы)
+};
+
+/**
+ * @struct RateSegment
+ * @brief Участок профиля нагрузки с линейным изменением интенсивности
+ */
+struct RateSegment {
+    double duration_seconds = 0;    //< Длительность участка
+    double start_rps = 0;           //< Интенсивность в начале участка
+    double end_rps = 0;             //< Интенсивность в конце участка
+};
+
+/**
+ * @class RateProfile
+ * @brief Профиль интенсивности запросов во времени
+ *
+ * Задаётся последовательностью участков. После последнего участка
+ * интенсивность остаётся равной его конечному значению.
+ */
+class RateProfile {
+public:
+    /// @brief Постоянная интенсивность
+    static RateProfile constant(double rps);
+
+    /// @brief Линейный рост (или спад) интенсивности за заданное время
+    static RateProfile ramp(double start_rps, double end_rps, double ramp_seconds);
+
+    /// @brief Ступенчатый профиль: пары (интенсивность, длительность)
+    static RateProfile steps(const std::vector<std::pair<double, double>>& steps);
+
+    /// @brief Добавляет участок в конец профиля
+    void addSegment(const RateSegment& segment);
+
+    /// @brief Проверяет, задан ли профиль
+    bool empty() const;
+
+    /// @brief Мгновенная интенсивность в момент t (секунды от старта)
+    double rateAt(double t) const;
+
+    /// @brief Момент, к которому ожидается n запросов (обратная функция накопленного числа)
+    /// @return Секунды от старта или бесконечность, если столько запросов не будет
+    double timeOfArrival(double n) const;
+
+    const std::vector<RateSegment>& segments() const { return segments_; }
+
+private:
+    std::vector<RateSegment> segments_;     //< Участки профиля
+};
+
+/**
+ * @class ArrivalScheduler
+ * @brief Выдаёт запланированные моменты отправки на общей шкале времени
+ *
+ * Все потоки берут следующий момент из общего курсора, измеряемого в
+ * накопленном числе запросов. Курсор сдвигается CAS-ом без блокировок:
+ * на 1 для равномерного потока и на Exp(1) для пуассоновского. Момент
+ * отправки получается обращением накопленной функции профиля, поэтому
+ * переменная интенсивность и пуассоновский поток обрабатываются единообразно.
+ * Отставший от графика поток не снижает предлагаемую нагрузку: следующий
+ * запрос уходит сразу, а задержка считается от запланированного момента.
+ */
+class ArrivalScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ArrivalScheduler(const RateProfile& profile, ArrivalProcess process);
+
+    /// @brief Задаёт момент начала шкалы и сбрасывает курсор
+    void start(Clock::time_point start_time);
+
+    /// @brief Выдаёт очередной запланированный момент отправки
+    /// @return false, если по профилю запросов больше не будет
+    /// @param rng Генератор вызывающего потока (интервалы пуассоновского потока)
+    bool next(Xoshiro256& rng, Clock::time_point& intended);
+
+    /// @brief Ожидает наступления момента с субмиллисекундной точностью
+    static void waitUntil(Clock::time_point deadline);
+
+private:
+    RateProfile profile_;                   //< Профиль интенсивности
+    ArrivalProcess process_;                //< Распределение интервалов
+    Clock::time_point start_time_;          //< Начало шкалы
+    std::atomic<double> cursor_{0.0};       //< Накопленное число выданных запросов
+};
+
+#endif // ARRIVAL_SCHEDULER_HPP
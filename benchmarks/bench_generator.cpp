@@ -0,0 +1,291 @@
+/// @file bench_generator.cpp
+/// @brief Бенчмарк генератора нагрузки против локальной заглушки
+///
+/// Заглушка (StubServer) запускается в дочернем процессе, поэтому
+/// процессорное время родителя - это время одного генератора. Замеряются:
+///   overhead - задержка и процессорное время потока на один запрос
+///              sendRequest против голого curl_easy_perform. Одиночный
+///              sendRequest заводит контекст потока с новым хэндлом и
+///              соединением, поэтому и голый curl берёт новый хэндл на каждый
+///              запрос: разница - собственная цена генератора;
+///   runTest  - предельная интенсивность (без ограничения RPS) и
+///              процессорное время процесса на запрос для обеих моделей
+///              отправки при 1, 2, 4 и 8 потоках.
+/// С --json результаты пишутся в файл; с --baseline сравниваются с прошлым
+/// файлом, и при падении RPS больше допуска код возврата - 1 (для CI).
+///
+/// Сборка: cmake --build build --target bench_generator
+/// Запуск: ./bench_generator [--duration S] [--requests N] [--server-threads N]
+///         [--json out.json] [--baseline old.json] [--tolerance 0.1]
+
+#include "../load_tester.hpp"
+#include "../stub_server.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+#include <curl/curl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+/// @brief Поток вывода в никуда: итоги runTest не нужны в отчёте бенчмарка
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+/// @brief Перенаправляет std::cout, пока жив объект
+class MuteStdout {
+public:
+    MuteStdout() : saved_(std::cout.rdbuf(&null_)) {}
+    ~MuteStdout() { std::cout.rdbuf(saved_); }
+
+private:
+    NullBuffer null_;
+    std::streambuf* saved_;
+};
+
+double threadCpuSeconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+double processCpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+/// @brief Запускает заглушку в дочернем процессе
+/// @return pid ребёнка (-1 - ошибка); port - занятый порт
+pid_t spawnStub(int threads, int& port) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        StubServerConfig config;
+        config.port = 0;
+        config.threads = threads;
+        StubServer server;
+        int actual = server.start(config) ? server.port() : -1;
+        ssize_t written = write(fds[1], &actual, sizeof(actual));
+        (void)written;
+        close(fds[1]);
+        if (actual < 0) {
+            _exit(1);
+        }
+        while (true) {
+            pause();
+        }
+    }
+    close(fds[1]);
+    port = -1;
+    ssize_t got = read(fds[0], &port, sizeof(port));
+    close(fds[0]);
+    if (got != sizeof(port) || port < 0) {
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+    return pid;
+}
+
+size_t discardBody(char*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+/// @brief Задержка и процессорное время потока на запрос, мкс
+struct PerRequest {
+    double latency_us = 0;
+    double cpu_us = 0;
+};
+
+/// @brief Один запрос на новом хэндле: новое соединение, как у одиночного sendRequest
+void rawCurlRequest(const std::string& url) {
+    CURL* curl = curl_easy_init();
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "{}");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardBody);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+}
+
+PerRequest benchRawCurl(const std::string& url, int requests) {
+    rawCurlRequest(url);    // Прогрев: глобальная инициализация и кэш DNS до замера
+
+    double cpu_start = threadCpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; ++i) {
+        rawCurlRequest(url);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpu = threadCpuSeconds() - cpu_start;
+    return {elapsed / requests * 1e6, cpu / requests * 1e6};
+}
+
+PerRequest benchSendRequest(const std::string& url, int requests) {
+    LoadTester tester;
+    tester.setTargetUrl(url);
+    tester.setLogCallback([](const LogRecord&, const std::string&) {});
+    MuteStdout mute;
+    tester.sendRequest(0, 0);
+
+    double cpu_start = threadCpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= requests; ++i) {
+        tester.sendRequest(0, i);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpu = threadCpuSeconds() - cpu_start;
+    return {elapsed / requests * 1e6, cpu / requests * 1e6};
+}
+
+/// @brief Итог одного прогона runTest
+struct RunResult {
+    double rps = 0;
+    double cpu_us_per_request = 0;
+    double p99_ms = 0;
+};
+
+RunResult benchRunTest(const std::string& url, EngineMode mode, int threads, int duration) {
+    LoadTester tester;
+    tester.setTargetUrl(url);
+    tester.setEngineMode(mode);
+    tester.setLogCallback([](const LogRecord&, const std::string&) {});
+
+    double cpu_start = processCpuSeconds();
+    {
+        MuteStdout mute;
+        tester.runTest(threads, duration);
+    }
+    double cpu = processCpuSeconds() - cpu_start;
+
+    CounterTotals totals = tester.collectCounters();
+    LatencyHistogram latency;
+    tester.collectLatency(latency);
+    long completed = totals.requests_sent + totals.requests_failed;
+    RunResult result;
+    if (completed > 0 && tester.testDuration() > 0) {
+        result.rps = completed / tester.testDuration();
+        result.cpu_us_per_request = cpu / completed * 1e6;
+        result.p99_ms = latency.percentile(99.0) / 1e6;
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int duration = 2;
+    int requests = 20000;
+    int server_threads = 4;
+    std::string json_path;
+    std::string baseline_path;
+    double tolerance = 0.1;
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--duration") == 0 && has_value) {
+            duration = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--requests") == 0 && has_value) {
+            requests = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--server-threads") == 0 && has_value) {
+            server_threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--json") == 0 && has_value) {
+            json_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && has_value) {
+            baseline_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && has_value) {
+            tolerance = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--duration S] [--requests N] [--server-threads N] "
+                         "[--json out.json] [--baseline old.json] [--tolerance 0.1]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int port = 0;
+    pid_t stub = spawnStub(server_threads, port);
+    if (stub < 0) {
+        std::fprintf(stderr, "Failed to start stub server\n");
+        return 1;
+    }
+    const std::string url = "http://127.0.0.1:" + std::to_string(port) + "/";
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    nlohmann::json report;
+    std::printf("stub server: 127.0.0.1:%d, %d threads\n\n", port, server_threads);
+
+    PerRequest raw = benchRawCurl(url, requests);
+    PerRequest send = benchSendRequest(url, requests);
+    std::printf("%-22s %14s %14s\n", "per request", "latency us", "thread cpu us");
+    std::printf("%-22s %14.1f %14.1f\n", "curl_easy_perform new", raw.latency_us, raw.cpu_us);
+    std::printf("%-22s %14.1f %14.1f\n", "sendRequest", send.latency_us, send.cpu_us);
+    std::printf("%-22s %14.1f %14.1f\n\n", "overhead", send.latency_us - raw.latency_us,
+                send.cpu_us - raw.cpu_us);
+    report["overhead"] = {{"raw_latency_us", raw.latency_us}, {"raw_cpu_us", raw.cpu_us},
+                          {"send_latency_us", send.latency_us}, {"send_cpu_us", send.cpu_us}};
+
+    std::printf("%-10s %8s %12s %14s %10s\n", "engine", "threads", "rps", "cpu us/req", "p99 ms");
+    for (EngineMode mode : {EngineMode::Blocking, EngineMode::Multi}) {
+        const char* engine = mode == EngineMode::Multi ? "multi" : "blocking";
+        for (int threads : {1, 2, 4, 8}) {
+            RunResult run = benchRunTest(url, mode, threads, duration);
+            std::printf("%-10s %8d %12.0f %14.1f %10.3f\n", engine, threads, run.rps,
+                        run.cpu_us_per_request, run.p99_ms);
+            report["runs"][std::string(engine) + "/" + std::to_string(threads)] =
+                {{"rps", run.rps}, {"cpu_us_per_request", run.cpu_us_per_request}, {"p99_ms", run.p99_ms}};
+        }
+    }
+
+    kill(stub, SIGTERM);
+    waitpid(stub, nullptr, 0);
+    curl_global_cleanup();
+
+    if (!json_path.empty()) {
+        std::ofstream(json_path) << report.dump(2) << std::endl;
+    }
+
+    int exit_code = 0;
+    if (!baseline_path.empty()) {
+        std::ifstream input(baseline_path);
+        nlohmann::json baseline = nlohmann::json::parse(input, nullptr, false);
+        if (baseline.is_discarded() || !baseline.contains("runs")) {
+            std::fprintf(stderr, "Invalid baseline file: %s\n", baseline_path.c_str());
+            return 2;
+        }
+        std::printf("\nbaseline comparison (tolerance %.0f%%)\n", tolerance * 100);
+        for (const auto& item : baseline["runs"].items()) {
+            if (!report["runs"].contains(item.key())) {
+                continue;
+            }
+            double before = item.value().value("rps", 0.0);
+            double now = report["runs"][item.key()].value("rps", 0.0);
+            bool regressed = before > 0 && now < before * (1 - tolerance);
+            std::printf("%-12s %12.0f -> %12.0f %s\n", item.key().c_str(), before, now,
+                        regressed ? "REGRESSION" : "ok");
+            if (regressed) {
+                exit_code = 1;
+            }
+        }
+    }
+    return exit_code;
+}
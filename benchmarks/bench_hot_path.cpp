@@ -0,0 +1,166 @@
+/// @file bench_hot_path.cpp
+/// @brief Микробенчмарк учёта запроса: общие атомики против шардов потоков
+///
+/// Каждая итерация повторяет то, что рабочий поток делает на каждый запрос
+/// помимо сети: берёт номер запроса, генерирует случайное значение поля и
+/// обновляет четыре счётчика. Сравниваются два варианта:
+///   shared  - общие std::atomic<long> на одной кэш-линии, общий номер
+///             запроса и общий std::mt19937 под мьютексом (прежняя схема
+///             без гонки данных);
+///   sharded - WorkerCounters и Xoshiro256 в контексте потока, как в LoadTester.
+/// Параллельно поток отчётов раз в миллисекунду суммирует счётчики.
+///
+/// Сборка: g++ -std=c++17 -O2 -I.. bench_hot_path.cpp -o bench_hot_path -lpthread
+/// Запуск: ./bench_hot_path [итераций_на_поток]
+
+#include "../fast_random.hpp"
+#include "../worker_stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// @brief Прежняя схема: все счётчики - поля одного объекта
+struct SharedState {
+    std::atomic<long> requests_sent{0};
+    std::atomic<long> success_responses{0};
+    std::atomic<long> error_responses{0};
+    std::atomic<long> requests_started{0};
+    std::atomic<int> global_request_id{0};
+    std::mutex gen_mutex;
+    std::mt19937 gen{12345};
+};
+
+/// @brief Контекст потока в новой схеме
+struct ShardedWorker {
+    WorkerCounters counters;
+    Xoshiro256 rng;
+    int next_request_id = 0;
+};
+
+volatile long sink = 0;     //< Не даёт компилятору выбросить результат
+
+template <typename Body, typename Reader>
+double runThreads(int num_threads, long iterations, Body body, Reader reader) {
+    std::atomic<bool> done{false};
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+
+    std::thread reporter([&]() {
+        while (!done.load(std::memory_order_relaxed)) {
+            sink = reader();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            ready++;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            body(t, iterations);
+        });
+    }
+    while (ready.load() < num_threads) {
+        std::this_thread::yield();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : threads) {
+        th.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    done = true;
+    reporter.join();
+    return num_threads * static_cast<double>(iterations) / elapsed / 1e6;
+}
+
+double benchShared(int num_threads, long iterations) {
+    SharedState state;
+    return runThreads(num_threads, iterations,
+        [&](int, long n) {
+            long local = 0;
+            for (long i = 0; i < n; ++i) {
+                int request_id = state.global_request_id++;
+                int value;
+                {
+                    std::lock_guard<std::mutex> lock(state.gen_mutex);
+                    std::uniform_int_distribution<> dis(1000, 9999);
+                    value = dis(state.gen);
+                }
+                local += value + request_id;
+                state.requests_sent++;
+                state.success_responses++;
+                state.requests_started++;
+                if ((value & 1023) == 0) {
+                    state.error_responses++;
+                }
+            }
+            sink = local;
+        },
+        [&]() {
+            return state.requests_sent.load() + state.success_responses.load() +
+                   state.error_responses.load();
+        });
+}
+
+double benchSharded(int num_threads, long iterations) {
+    std::vector<std::unique_ptr<ShardedWorker>> workers;
+    for (int t = 0; t < num_threads; ++t) {
+        workers.push_back(std::make_unique<ShardedWorker>());
+        workers.back()->rng.reseed(12345 + t);
+        workers.back()->next_request_id = t;
+    }
+    return runThreads(num_threads, iterations,
+        [&](int t, long n) {
+            ShardedWorker& w = *workers[t];
+            long local = 0;
+            for (long i = 0; i < n; ++i) {
+                int request_id = w.next_request_id;
+                w.next_request_id += num_threads;
+                int value = static_cast<int>(w.rng.uniformInt(1000, 9999));
+                local += value + request_id;
+                bumpCounter(w.counters.requests_sent);
+                bumpCounter(w.counters.success_responses);
+                bumpCounter(w.counters.requests_started);
+                if ((value & 1023) == 0) {
+                    bumpCounter(w.counters.error_responses);
+                }
+            }
+            sink = local;
+        },
+        [&]() {
+            CounterTotals totals;
+            for (const auto& w : workers) {
+                totals.add(w->counters);
+            }
+            return totals.requests_sent + totals.success_responses + totals.error_responses;
+        });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 2000000;
+
+    std::printf("iterations per thread: %ld\n", iterations);
+    std::printf("%8s %16s %16s %10s\n", "threads", "shared Mops/s", "sharded Mops/s", "speedup");
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        double shared = benchShared(threads, iterations);
+        double sharded = benchSharded(threads, iterations);
+        std::printf("%8d %16.2f %16.2f %9.1fx\n", threads, shared, sharded, sharded / shared);
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+/// @file body_template.cpp
+/// @brief Реализация предкомпилированного шаблона тела запроса
+
+#include "body_template.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+/// @brief Маркер, которым слот временно представлен в JSON
+static std::string slotMarker(size_t index) {
+    // Управляющий символ не встречается в обычных данных и после dump()
+    // превращается в однозначную последовательность \u0001
+    return "\x01" + std::to_string(index) + "\x01";
+}
+
+BodyTemplate BodyTemplate::compile(const TestDataConfig& config, const DataPools& pools) {
+    json document = json::object();
+    std::vector<Slot> slots;
+    std::vector<std::shared_ptr<const DataPool>> pool_refs;
+
+    for (const auto& [field_name, field] : config) {
+        json value;
+        if (!field.generator.empty()) {
+            FieldGenerator generator;
+            std::shared_ptr<const DataPool> pool_ref;
+            if (!FieldGenerator::parse(field.generator, pools, generator, pool_ref)) {
+                throw std::invalid_argument("unknown generator '" + field.generator + "' for field " + field_name);
+            }
+            value = slotMarker(slots.size());
+            slots.push_back(std::move(generator));
+            pool_refs.push_back(std::move(pool_ref));
+        } else if (field.is_random) {
+            value = slotMarker(slots.size());
+            slots.push_back(FieldGenerator::uniform(field.min_val, field.max_val, true));
+        } else {
+            value = field.value;
+        }
+
+        if (!field_name.empty() && field_name[0] == '/') {
+            document[json::json_pointer(field_name)] = value;
+        } else {
+            document[field_name] = value;
+        }
+    }
+
+    return fromMarked(document, std::move(slots), std::move(pool_refs));
+}
+
+/// @brief Заменяет строки-заполнители "{{SPEC}}" маркерами слотов
+/// @details Неизвестный вид генератора - ошибка: опечатка в шаблоне не должна уходить в тела как текст
+static void replacePlaceholders(json& node, const DataPools& pools, std::vector<FieldGenerator>& slots,
+                                std::vector<std::shared_ptr<const DataPool>>& pool_refs) {
+    if (node.is_object() || node.is_array()) {
+        for (auto& child : node) {
+            replacePlaceholders(child, pools, slots, pool_refs);
+        }
+        return;
+    }
+    if (!node.is_string()) {
+        return;
+    }
+
+    const std::string& text = node.get_ref<const std::string&>();
+    if (text.size() < 5 || text.compare(0, 2, "{{") != 0 || text.compare(text.size() - 2, 2, "}}") != 0) {
+        return;
+    }
+
+    FieldGenerator generator;
+    std::shared_ptr<const DataPool> pool_ref;
+    const std::string spec = text.substr(2, text.size() - 4);
+    if (!FieldGenerator::parse(spec, pools, generator, pool_ref)) {
+        throw std::invalid_argument("unknown generator '" + spec + "' in body template");
+    }
+    node = slotMarker(slots.size());
+    slots.push_back(std::move(generator));
+    pool_refs.push_back(std::move(pool_ref));
+}
+
+BodyTemplate BodyTemplate::fromJson(const std::string& json_text, const DataPools& pools) {
+    json document = json::parse(json_text);
+
+    std::vector<Slot> slots;
+    std::vector<std::shared_ptr<const DataPool>> pool_refs;
+    replacePlaceholders(document, pools, slots, pool_refs);
+    return fromMarked(document, std::move(slots), std::move(pool_refs));
+}
+
+BodyTemplate BodyTemplate::fromMarked(const json& document, std::vector<Slot> slots,
+                                      std::vector<std::shared_ptr<const DataPool>> pools) {
+    BodyTemplate result;
+    result.slots_ = std::move(slots);
+
+    // Состояние в потоке: своя позиция у каждой последовательности и
+    // одна строка на таблицу, общая для всех её полей в теле
+    for (auto& slot : result.slots_) {
+        if (slot.kind == GeneratorKind::Sequence) {
+            slot.state_index = result.sequence_count_++;
+        }
+    }
+    for (auto& pool : pools) {
+        if (pool && std::find(result.pools_.begin(), result.pools_.end(), pool) == result.pools_.end()) {
+            result.pools_.push_back(std::move(pool));
+        }
+    }
+    for (auto& slot : result.slots_) {
+        if (slot.kind == GeneratorKind::Pool) {
+            auto it = std::find_if(result.pools_.begin(), result.pools_.end(),
+                                   [&](const auto& pool) { return pool.get() == slot.pool; });
+            slot.state_index = static_cast<size_t>(it - result.pools_.begin());
+        }
+    }
+
+    const std::string text = document.dump();
+    static const std::string open = "\"\\u0001";
+    static const std::string close = "\\u0001\"";
+
+    size_t literal_start = 0;
+    size_t pos = 0;
+    while ((pos = text.find(open, pos)) != std::string::npos) {
+        size_t digits = pos + open.size();
+        size_t end = text.find(close, digits);
+        if (end == std::string::npos) {
+            break;
+        }
+        int index = std::atoi(text.c_str() + digits);
+
+        Piece piece;
+        piece.offset = result.literals_.size();
+        piece.length = pos - literal_start;
+        piece.slot = index;
+        result.literals_.append(text, literal_start, pos - literal_start);
+        result.pieces_.push_back(piece);
+
+        pos = end + close.size();
+        literal_start = pos;
+    }
+
+    Piece tail;
+    tail.offset = result.literals_.size();
+    tail.length = text.size() - literal_start;
+    result.literals_.append(text, literal_start, std::string::npos);
+    result.pieces_.push_back(tail);
+
+    // Литералы плюс наибольшая длина каждого значения
+    result.size_hint_ = result.literals_.size();
+    for (const auto& slot : result.slots_) {
+        result.size_hint_ += slot.maxSize();
+    }
+    return result;
+}
+
+void BodyTemplate::initState(GeneratorState& state, uint64_t thread_index, uint64_t thread_count) const {
+    state.thread_index = thread_index;
+    state.thread_count = std::max<uint64_t>(1, thread_count);
+    state.sequences.assign(sequence_count_, 0);
+    state.pool_rows.assign(pools_.size(), std::numeric_limits<size_t>::max());
+}
+
+void BodyTemplate::render(std::string& out, Xoshiro256& rng, GeneratorState& state) const {
+    out.clear();
+    out.reserve(size_hint_);
+    // Строка таблицы выбирается заново для каждого тела
+    std::fill(state.pool_rows.begin(), state.pool_rows.end(), std::numeric_limits<size_t>::max());
+
+    for (const auto& piece : pieces_) {
+        out.append(literals_, piece.offset, piece.length);
+        if (piece.slot >= 0) {
+            slots_[piece.slot].write(out, rng, state);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/// @file body_template.hpp
+/// @brief Предкомпилированный шаблон тела запроса
+
+#ifndef BODY_TEMPLATE_HPP
+#define BODY_TEMPLATE_HPP
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "fast_random.hpp"
+#include "field_generators.hpp"
+
+/**
+ * @struct FieldConfig
+ * @brief Структура поля тестового запроса
+ */
+struct FieldConfig {
+    std::string value;        //< Фиксированное значение или шаблон
+    bool is_random = false;   //< Флаг случайного значения
+    int min_val = 0;          //< Минимальное значение для случайных чисел
+    int max_val = 9999;       //< Максимальное значение для случайных чисел
+    std::string generator;    //< Генератор значения ("uuid4", "seq:1", ... - см. FieldGenerator); важнее is_random
+};
+
+/// @brief Поля запроса. Имя поля, начинающееся с '/', - JSON Pointer
+/// (например "/user/id" или "/items/0"), из него строятся вложенные объекты и массивы
+using TestDataConfig = std::unordered_map<std::string, FieldConfig>;
+
+/**
+ * @class BodyTemplate
+ * @brief Тело запроса, сериализованное один раз, со слотами под генерируемые поля
+ *
+ * Компилируется при настройке теста: JSON собирается и сериализуется
+ * целиком, а на месте генерируемых полей остаются слоты. На каждый запрос
+ * render только склеивает готовые куски и значения генераторов в
+ * переиспользуемый буфер потока - без построения JSON и без выделений
+ * памяти после прогрева.
+ */
+class BodyTemplate {
+public:
+    /// @brief Компилирует шаблон из конфигурации полей
+    /// @details Бросает std::invalid_argument при ошибке в описании генератора
+    static BodyTemplate compile(const TestDataConfig& config, const DataPools& pools = {});
+
+    /// @brief Компилирует шаблон из JSON-текста
+    /// @details Строковое значение "{{SPEC}}", где SPEC - описание генератора
+    /// (FieldGenerator), становится слотом; "{{random}}" и "{{random:MIN:MAX}}" -
+    /// случайное целое строкой, как раньше. Бросает nlohmann::json::exception
+    /// при ошибке разбора и std::invalid_argument при неизвестном генераторе или
+    /// ошибке в его аргументах
+    static BodyTemplate fromJson(const std::string& json_text, const DataPools& pools = {});
+
+    /// @brief Готовит состояние генераторов для рабочего потока
+    void initState(GeneratorState& state, uint64_t thread_index, uint64_t thread_count) const;
+
+    /// @brief Записывает очередное тело запроса в out (содержимое out заменяется)
+    /// @param state Состояние, подготовленное initState этого шаблона
+    void render(std::string& out, Xoshiro256& rng, GeneratorState& state) const;
+
+    /// @brief Количество генерируемых полей
+    size_t slotCount() const { return slots_.size(); }
+
+private:
+    using Slot = FieldGenerator;
+
+    /// @brief Кусок шаблона: литерал и, возможно, следующий за ним слот
+    struct Piece {
+        size_t offset = 0;          //< Начало литерала в literals_
+        size_t length = 0;          //< Длина литерала
+        int slot = -1;              //< Номер слота после литерала (-1 - нет)
+    };
+
+    /// @brief Разбивает сериализованный JSON с маркерами слотов на куски
+    static BodyTemplate fromMarked(const nlohmann::json& document, std::vector<Slot> slots,
+                                   std::vector<std::shared_ptr<const DataPool>> pools);
+
+    std::string literals_;          //< Все литералы подряд
+    std::vector<Piece> pieces_;     //< Куски в порядке вывода
+    std::vector<Slot> slots_;       //< Генераторы слотов
+    std::vector<std::shared_ptr<const DataPool>> pools_; //< Таблицы слотов pool (по state_index)
+    size_t sequence_count_ = 0;     //< Последовательностей среди слотов
+    size_t size_hint_ = 0;          //< Ожидаемый размер тела
+};
+
+#endif // BODY_TEMPLATE_HPP
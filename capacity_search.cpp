@@ -0,0 +1,156 @@
+/// @file capacity_search.cpp
+/// @brief Реализация поиска предельной интенсивности
+
+#include "capacity_search.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+constexpr double kMinRps = 1.0;     // Ниже ступень в несколько секунд почти пуста
+}
+
+CapacitySearch::CapacitySearch(const CapacitySearchConfig& config) : config_(config) {
+    config_.start_rps = std::max(config_.start_rps, 1.0);
+    config_.growth_factor = std::max(config_.growth_factor, 1.1);
+    config_.step_seconds = std::max(config_.step_seconds, 1);
+    config_.precision = std::max(config_.precision, 0.001);
+    config_.max_steps = std::max(config_.max_steps, 1);
+}
+
+bool CapacitySearch::meetsSlo(const CapacityStep& step) const {
+    if (step.completed <= 0 || step.p99_ms > config_.p99_ms || step.error_rate > config_.max_error_rate) {
+        return false;
+    }
+    // Генератор не успевает за предложенной интенсивностью - ступень не выдержана, даже если
+    // завершённые запросы быстрые. Пуассоновский поток сам даёт разброс порядка sqrt(ожидаемого)
+    const double expected = step.offered_rps * config_.step_seconds;
+    const double shortfall = expected - step.achieved_rps * config_.step_seconds;
+    return shortfall <= std::max((1 - config_.min_achieved_ratio) * expected, 3 * std::sqrt(expected));
+}
+
+CapacitySearchResult CapacitySearch::run(const StepRunner& runner) const {
+    CapacitySearchResult result;
+
+    auto probe = [&](double rps, bool& passed) {
+        CapacityStep step;
+        step.offered_rps = rps;
+        if (!runner(rps, step)) {
+            result.stopped = true;
+            return false;
+        }
+        step.passed = meetsSlo(step);
+        passed = step.passed;
+        result.steps.push_back(step);
+        return true;
+    };
+
+    // Разгон: до первой ступени, нарушившей SLO, или до верхней границы
+    double lo = 0;
+    double hi = 0;
+    double rps = config_.max_rps > 0 ? std::min(config_.start_rps, config_.max_rps) : config_.start_rps;
+    while (static_cast<int>(result.steps.size()) < config_.max_steps) {
+        bool passed = false;
+        if (!probe(rps, passed)) {
+            return result;
+        }
+        if (!passed) {
+            hi = rps;
+            break;
+        }
+        lo = rps;
+        if (config_.max_rps > 0 && rps >= config_.max_rps) {
+            break;
+        }
+        rps *= config_.growth_factor;
+        if (config_.max_rps > 0) {
+            rps = std::min(rps, config_.max_rps);
+        }
+    }
+
+    // Первая же ступень нарушила SLO - спускаемся, пока не найдём успешную
+    if (hi > 0 && lo == 0) {
+        rps = hi / config_.growth_factor;
+        while (rps >= kMinRps && static_cast<int>(result.steps.size()) < config_.max_steps) {
+            bool passed = false;
+            if (!probe(rps, passed)) {
+                return result;
+            }
+            if (passed) {
+                lo = rps;
+                break;
+            }
+            hi = rps;
+            rps /= config_.growth_factor;
+        }
+    }
+
+    // Двоичный поиск внутри [lo, hi]
+    if (hi > 0 && lo > 0) {
+        result.bounded = true;
+        while ((hi - lo) > config_.precision * hi &&
+               static_cast<int>(result.steps.size()) < config_.max_steps) {
+            const double mid = (lo + hi) / 2;
+            bool passed = false;
+            if (!probe(mid, passed)) {
+                break;
+            }
+            (passed ? lo : hi) = mid;
+        }
+    } else if (hi > 0) {
+        result.bounded = true;
+    }
+    result.max_rps = lo;
+    return result;
+}
+
+void CapacitySearch::print(const CapacitySearchResult& result, const CapacitySearchConfig& config) {
+    std::vector<CapacityStep> curve = result.steps;
+    std::sort(curve.begin(), curve.end(),
+              [](const CapacityStep& a, const CapacityStep& b) { return a.offered_rps < b.offered_rps; });
+
+    std::cout << "\n=== Capacity Search ===" << std::endl;
+    std::cout << "SLO: p99 <= " << config.p99_ms << " ms, errors <= " << config.max_error_rate * 100 << "%"
+              << std::endl;
+    char line[128];
+    std::snprintf(line, sizeof(line), "%12s %12s %10s %10s %9s  %s",
+                  "offered rps", "achieved", "p50 ms", "p99 ms", "errors %", "SLO");
+    std::cout << line << std::endl;
+    for (const auto& step : curve) {
+        std::snprintf(line, sizeof(line), "%12.1f %12.1f %10.3f %10.3f %9.3f  %s",
+                      step.offered_rps, step.achieved_rps, step.p50_ms, step.p99_ms,
+                      step.error_rate * 100, step.passed ? "ok" : "FAIL");
+        std::cout << line << std::endl;
+    }
+
+    if (result.max_rps <= 0) {
+        std::cout << "Max sustainable rate: none (no step met the SLO)" << std::endl;
+    } else {
+        std::cout << "Max sustainable rate: " << result.max_rps << " RPS";
+        if (!result.bounded) {
+            std::cout << " (lower bound: no step violated the SLO)";
+        }
+        std::cout << std::endl;
+    }
+    if (result.stopped) {
+        std::cout << "Search stopped before completion" << std::endl;
+    }
+}
+
+bool CapacitySearch::writeCurve(const CapacitySearchResult& result, const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << "step,offered_rps,achieved_rps,p50_ms,p99_ms,error_rate,completed,cancelled,passed\n";
+    for (size_t i = 0; i < result.steps.size(); ++i) {
+        const CapacityStep& step = result.steps[i];
+        out << i << "," << step.offered_rps << "," << step.achieved_rps << "," << step.p50_ms << ","
+            << step.p99_ms << "," << step.error_rate << "," << step.completed << ","
+            << step.cancelled << "," << (step.passed ? 1 : 0) << "\n";
+    }
+    return static_cast<bool>(out);
+}
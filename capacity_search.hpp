@@ -0,0 +1,93 @@
+/// @file capacity_search.hpp
+/// @brief Поиск предельной устойчивой интенсивности по SLO
+
+#ifndef CAPACITY_SEARCH_HPP
+#define CAPACITY_SEARCH_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct CapacitySearchConfig
+ * @brief Параметры поиска и пороги SLO
+ */
+struct CapacitySearchConfig {
+    double start_rps = 100;             //< Интенсивность первой ступени
+    double max_rps = 0;                 //< Верхняя граница поиска (0 - без границы)
+    double growth_factor = 2.0;         //< Множитель интенсивности на разгоне
+    int step_seconds = 5;               //< Длительность ступени
+    int cooldown_ms = 500;              //< Пауза между ступенями (сервер разбирает очередь)
+    double p99_ms = 100;                //< Порог p99 задержки, мс
+    double max_error_rate = 0.01;       //< Порог доли ошибок (0..1)
+    double min_achieved_ratio = 0.95;   //< Ступень не уложилась, если завершено меньше этой доли предложенного
+    double precision = 0.05;            //< Точность: поиск идёт, пока (hi - lo) > precision * hi
+    int max_steps = 20;                 //< Предел числа ступеней
+    std::string curve_path;             //< CSV кривой "интенсивность - задержка" (пусто - не писать)
+};
+
+/**
+ * @struct CapacityStep
+ * @brief Итог одной ступени
+ */
+struct CapacityStep {
+    double offered_rps = 0;             //< Предложенная интенсивность
+    double achieved_rps = 0;            //< Завершено запросов в секунду
+    double p50_ms = 0;
+    double p99_ms = 0;
+    double error_rate = 0;              //< Доля неудачных, прерванных и не прошедших проверки запросов
+    long completed = 0;                 //< Завершено запросов
+    long cancelled = 0;                 //< Прервано по истечении ожидания в конце ступени
+    bool passed = false;                //< Ступень уложилась в SLO
+};
+
+/**
+ * @struct CapacitySearchResult
+ * @brief Итог поиска
+ */
+struct CapacitySearchResult {
+    double max_rps = 0;                 //< Наибольшая интенсивность, уложившаяся в SLO (0 - ни одна)
+    bool bounded = false;               //< Найдена ступень, нарушившая SLO (иначе max_rps - нижняя оценка)
+    bool stopped = false;               //< Поиск прерван
+    bool rejected = false;              //< Поиск не запущен (занят тестом, ошибка в сценариях, запись с темпом)
+    std::vector<CapacityStep> steps;    //< Ступени в порядке прогона
+};
+
+/**
+ * @class CapacitySearch
+ * @brief Разгон и двоичный поиск предельной интенсивности
+ *
+ * Сначала интенсивность умножается на growth_factor, пока ступени
+ * укладываются в SLO. Первая нарушившая ступень даёт верхнюю границу, и
+ * дальше интервал [последняя успешная, первая неуспешная] делится пополам
+ * до заданной точности. Если SLO нарушает уже первая ступень, интенсивность
+ * так же делится на growth_factor вниз (не ниже 1 RPS) до первой успешной.
+ * Ступени выполняет переданная функция, поэтому алгоритм не зависит от
+ * того, как именно генерируется нагрузка.
+ */
+class CapacitySearch {
+public:
+    /// @brief Выполняет ступень с заданной интенсивностью
+    /// @return false, если поиск нужно прервать (итог ступени не учитывается)
+    using StepRunner = std::function<bool(double rps, CapacityStep& step)>;
+
+    explicit CapacitySearch(const CapacitySearchConfig& config);
+
+    /// @brief Проводит поиск
+    CapacitySearchResult run(const StepRunner& runner) const;
+
+    /// @brief Укладывается ли ступень в SLO
+    bool meetsSlo(const CapacityStep& step) const;
+
+    /// @brief Выводит кривую и итог поиска
+    static void print(const CapacitySearchResult& result, const CapacitySearchConfig& config);
+
+    /// @brief Пишет кривую в CSV
+    /// @return false, если файл не открылся
+    static bool writeCurve(const CapacitySearchResult& result, const std::string& path);
+
+private:
+    CapacitySearchConfig config_;
+};
+
+#endif // CAPACITY_SEARCH_HPP
@@ -0,0 +1,128 @@
+/// @file cpu_affinity.cpp
+/// @brief Реализация привязки потоков к ядрам
+
+#include "cpu_affinity.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+
+bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+    std::vector<int> parsed;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        const std::string item = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (item.empty()) {
+            continue;
+        }
+
+        char* rest = nullptr;
+        const long first = std::strtol(item.c_str(), &rest, 10);
+        long last = first;
+        if (*rest == '-') {
+            last = std::strtol(rest + 1, &rest, 10);
+        }
+        if (rest == item.c_str() || *rest != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            parsed.push_back(static_cast<int>(cpu));
+        }
+    }
+    cpus = std::move(parsed);
+    return true;
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    std::vector<int> sorted = cpus;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    std::string out;
+    for (size_t i = 0; i < sorted.size();) {
+        size_t j = i;
+        while (j + 1 < sorted.size() && sorted[j + 1] == sorted[j] + 1) {
+            ++j;
+        }
+        if (!out.empty()) {
+            out += ',';
+        }
+        out += std::to_string(sorted[i]);
+        if (j > i) {
+            out += '-' + std::to_string(sorted[j]);
+        }
+        i = j + 1;
+    }
+    return out;
+}
+
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+bool pinCurrentThread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (CPU_COUNT(&set) == 0) {
+        return false;
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+int cpuNumaNode(int cpu) {
+    // Узел ядра - подкаталог nodeN в его каталоге sysfs
+    const std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        return -1;
+    }
+    int node = -1;
+    while (dirent* entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            name.find_first_not_of("0123456789", 4) == std::string::npos) {
+            node = std::atoi(name.c_str() + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+std::vector<int> AffinityPlan::reporterCpus() const {
+    if (!reporter_cpus.empty() || worker_cpus.empty()) {
+        return reporter_cpus;
+    }
+    std::vector<int> rest;
+    for (int cpu : allowedCpus()) {
+        if (std::find(worker_cpus.begin(), worker_cpus.end(), cpu) == worker_cpus.end()) {
+            rest.push_back(cpu);
+        }
+    }
+    // Рабочие потоки заняли все ядра - фоновые потоки остаются без привязки
+    return rest;
+}
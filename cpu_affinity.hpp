@@ -0,0 +1,50 @@
+/// @file cpu_affinity.hpp
+/// @brief Привязка потоков к ядрам и сведения о NUMA-узлах
+
+#ifndef CPU_AFFINITY_HPP
+#define CPU_AFFINITY_HPP
+
+#include <string>
+#include <vector>
+
+/// @brief Разбирает список ядер вида "0-7,16,18-19"
+/// @return false при ошибке разбора (cpus не меняется)
+bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+
+/// @brief Записывает список ядер в компактном виде ("0-7,16")
+std::string formatCpuList(const std::vector<int>& cpus);
+
+/// @brief Ядра, на которых процессу разрешено выполняться
+std::vector<int> allowedCpus();
+
+/// @brief Привязывает вызывающий поток к набору ядер
+/// @return false, если ни одно ядро не подошло или ядро отказало
+bool pinCurrentThread(const std::vector<int>& cpus);
+
+/// @brief NUMA-узел ядра (-1, если неизвестен)
+int cpuNumaNode(int cpu);
+
+/**
+ * @struct AffinityPlan
+ * @brief Размещение потоков теста по ядрам
+ *
+ * Рабочие потоки (событийные циклы) привязываются по одному к ядрам
+ * worker_cpus по кругу. Потоки отчётов, журнала и трассы привязываются к
+ * reporter_cpus, а если он пуст - ко всем разрешённым ядрам, кроме рабочих.
+ */
+struct AffinityPlan {
+    std::vector<int> worker_cpus;       //< Ядра рабочих потоков (пусто - без привязки)
+    std::vector<int> reporter_cpus;     //< Ядра фоновых потоков (пусто - все, кроме рабочих)
+
+    bool enabled() const { return !worker_cpus.empty() || !reporter_cpus.empty(); }
+
+    /// @brief Ядро рабочего потока с номером index (-1 - без привязки)
+    int workerCpu(size_t index) const {
+        return worker_cpus.empty() ? -1 : worker_cpus[index % worker_cpus.size()];
+    }
+
+    /// @brief Ядра фоновых потоков (пусто - без привязки)
+    std::vector<int> reporterCpus() const;
+};
+
+#endif // CPU_AFFINITY_HPP
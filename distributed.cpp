@@ -0,0 +1,518 @@
+/// @file distributed.cpp
+/// @brief Реализация координатора и агентов распределённого теста
+
+#include "distributed.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "load_tester.hpp"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+/// @brief Подключается к агенту
+/// @return Дескриптор сокета или -1
+static int connectTcp(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+/// @brief Открывает слушающий сокет на адресе IPv4 ("0.0.0.0" - на всех интерфейсах)
+/// @return Дескриптор сокета или -1
+static int listenTcp(const std::string& bind_address, int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 4) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// @brief Отправляет сообщение строкой JSON
+static bool sendMessage(int fd, const json& message) {
+    std::string line = message.dump();
+    line.push_back('\n');
+    size_t sent = 0;
+    while (sent < line.size()) {
+        ssize_t n = send(fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/// @brief Читает следующее сообщение
+/// @param buffer Непрочитанный остаток соединения (сохраняется между вызовами)
+/// @param deadline Крайний срок; пустой - ждать без ограничения
+static bool receiveMessage(int fd, std::string& buffer, json& message, Clock::time_point deadline = {}) {
+    while (true) {
+        size_t newline = buffer.find('\n');
+        if (newline != std::string::npos) {
+            try {
+                message = json::parse(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(newline));
+            } catch (const json::exception&) {
+                return false;
+            }
+            buffer.erase(0, newline + 1);
+            return true;
+        }
+
+        int timeout_ms = -1;
+        if (deadline != Clock::time_point{}) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            if (left <= 0) {
+                return false;
+            }
+            timeout_ms = static_cast<int>(std::min<long long>(left, 1000));
+        }
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready < 0 && errno != EINTR) {
+            return false;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        char chunk[16384];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+static json countersToJson(const CounterTotals& totals) {
+    return {{"requests_started", totals.requests_started},
+            {"requests_sent", totals.requests_sent},
+            {"requests_failed", totals.requests_failed},
+            {"requests_cancelled", totals.requests_cancelled},
+            {"http_errors", totals.http_errors},
+            {"transport_errors", totals.transport_errors},
+            {"success_responses", totals.success_responses},
+            {"error_responses", totals.error_responses},
+            {"connections_opened", totals.connections_opened},
+            {"connections_reused", totals.connections_reused},
+            {"http2_streams", totals.http2_streams}};
+}
+
+static CounterTotals countersFromJson(const json& counters) {
+    CounterTotals totals;
+    totals.requests_started = counters.value("requests_started", 0L);
+    totals.requests_sent = counters.value("requests_sent", 0L);
+    totals.requests_failed = counters.value("requests_failed", 0L);
+    totals.requests_cancelled = counters.value("requests_cancelled", 0L);
+    totals.http_errors = counters.value("http_errors", 0L);
+    totals.transport_errors = counters.value("transport_errors", 0L);
+    totals.success_responses = counters.value("success_responses", 0L);
+    totals.error_responses = counters.value("error_responses", 0L);
+    totals.connections_opened = counters.value("connections_opened", 0L);
+    totals.connections_reused = counters.value("connections_reused", 0L);
+    totals.http2_streams = counters.value("http2_streams", 0L);
+    return totals;
+}
+
+/// @brief Непустые корзины гистограммы с точными суммой и максимумом
+static json histogramToJson(const LatencyHistogram& latency) {
+    json buckets = json::array();
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        if (latency.bucketCount(i) > 0) {
+            buckets.push_back({i, latency.bucketCount(i)});
+        }
+    }
+    return {{"sum", latency.sum()}, {"max", latency.max()}, {"buckets", buckets}};
+}
+
+static void histogramFromJson(const json& histogram, LatencyHistogram& latency) {
+    std::vector<std::pair<size_t, uint64_t>> buckets;
+    for (const auto& bucket : histogram.at("buckets")) {
+        buckets.emplace_back(bucket.at(0).get<size_t>(), bucket.at(1).get<uint64_t>());
+    }
+    latency.addBuckets(buckets, histogram.value("sum", uint64_t{0}), histogram.value("max", uint64_t{0}));
+}
+
+/// @brief План одного агента: доля интенсивности, своё зерно, своя доля записи и последовательностей
+static json agentPlan(const json& plan, size_t index, size_t count, double requests_per_second) {
+    json result = plan;
+    json profile = json::array();
+    if (plan.contains("rate_profile") && !plan["rate_profile"].empty()) {
+        for (auto segment : plan["rate_profile"]) {
+            segment["start_rps"] = segment.value("start_rps", 0.0) / count;
+            segment["end_rps"] = segment.value("end_rps", 0.0) / count;
+            profile.push_back(segment);
+        }
+    } else if (requests_per_second > 0) {
+        // Дробная доля задаётся профилем: RPS в runTest - целое число
+        const double share = requests_per_second / count;
+        profile.push_back({{"duration", 0.0}, {"start_rps", share}, {"end_rps", share}});
+    }
+    result["rate_profile"] = profile;
+
+    if (plan.contains("seed")) {
+        result["seed"] = plan["seed"].get<uint64_t>() + index * 0x9E3779B97F4A7C15ull;
+    }
+    // Последовательности агентов чередуются: seq не повторяется между агентами
+    result["agent"] = {{"part", index}, {"parts", count}};
+    if (plan.contains("replay")) {
+        result["replay"]["part"] = index;
+        result["replay"]["parts"] = count;
+    }
+    return result;
+}
+
+LoadCoordinator::~LoadCoordinator() {
+    reapAgents();
+}
+
+void LoadCoordinator::addAgent(const std::string& host, int port) {
+    Agent agent;
+    agent.host = host;
+    agent.port = port;
+    agents_.push_back(agent);
+}
+
+bool LoadCoordinator::spawnLocalAgents(int count, const std::string& agent_path, int base_port) {
+    std::cout.flush();
+    for (int i = 0; i < count; ++i) {
+        const int port = base_port + static_cast<int>(agents_.size());
+        const std::string port_text = std::to_string(port);
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::cerr << "Failed to start agent: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        if (pid == 0) {
+            // Прогресс агентов перемешался бы с выводом координатора - оставляем только ошибки
+            int null_fd = open("/dev/null", O_WRONLY);
+            if (null_fd >= 0) {
+                dup2(null_fd, STDOUT_FILENO);
+                close(null_fd);
+            }
+            execl(agent_path.c_str(), agent_path.c_str(), "--port", port_text.c_str(),
+                  "--bind", "127.0.0.1", "--once", static_cast<char*>(nullptr));
+            std::cerr << "Failed to exec " << agent_path << ": " << std::strerror(errno) << std::endl;
+            _exit(127);
+        }
+
+        Agent agent;
+        agent.host = "127.0.0.1";
+        agent.port = port;
+        agent.pid = pid;
+        agents_.push_back(agent);
+    }
+    return true;
+}
+
+void LoadCoordinator::reapAgents() {
+    for (auto& agent : agents_) {
+        if (agent.fd >= 0) {
+            close(agent.fd);
+            agent.fd = -1;
+        }
+        if (agent.pid > 0) {
+            // Агент с --once завершается сам после теста; зависшего останавливаем
+            int status = 0;
+            if (waitpid(agent.pid, &status, WNOHANG) == 0) {
+                kill(agent.pid, SIGTERM);
+                waitpid(agent.pid, &status, 0);
+            }
+            agent.pid = -1;
+        }
+    }
+}
+
+bool LoadCoordinator::run(const json& plan, int threads_per_agent, int duration_seconds,
+                          double requests_per_second) {
+    results_.clear();
+    totals_ = CounterTotals();
+    latency_.reset();
+    phases_.reset();
+    elapsed_seconds_ = 0;
+    if (agents_.empty()) {
+        std::cerr << "No agents to run the test" << std::endl;
+        return false;
+    }
+
+    const size_t count = agents_.size();
+    results_.resize(count);
+    bool ok = true;
+
+    // Подключение: локальным агентам нужно время, чтобы занять порт
+    constexpr auto kConnectTimeout = std::chrono::seconds(5);
+    for (size_t i = 0; i < count; ++i) {
+        Agent& agent = agents_[i];
+        results_[i].endpoint = agent.host + ":" + std::to_string(agent.port);
+        const auto deadline = Clock::now() + kConnectTimeout;
+        while (agent.fd < 0 && Clock::now() < deadline) {
+            agent.fd = connectTcp(agent.host, agent.port);
+            if (agent.fd < 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+        if (agent.fd < 0) {
+            results_[i].error = "connection failed";
+            ok = false;
+        }
+    }
+
+    // Подготовка: агент применяет план (открывает запись, компилирует шаблоны) до старта
+    constexpr auto kPrepareTimeout = std::chrono::seconds(30);
+    for (size_t i = 0; ok && i < count; ++i) {
+        Agent& agent = agents_[i];
+        json reply;
+        if (!sendMessage(agent.fd, {{"type", "prepare"},
+                                    {"plan", agentPlan(plan, i, count, requests_per_second)},
+                                    {"threads", threads_per_agent},
+                                    {"duration", duration_seconds}}) ||
+            !receiveMessage(agent.fd, agent.buffer, reply, Clock::now() + kPrepareTimeout)) {
+            results_[i].error = "no reply to prepare";
+            ok = false;
+        } else if (reply.value("type", "") != "ready") {
+            results_[i].error = reply.value("message", std::string("prepare failed"));
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        // Общий момент старта по системным часам с запасом на доставку команды
+        constexpr auto kStartDelay = std::chrono::milliseconds(500);
+        const auto start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            (std::chrono::system_clock::now() + kStartDelay).time_since_epoch()).count();
+        for (size_t i = 0; i < count; ++i) {
+            if (!sendMessage(agents_[i].fd, {{"type", "start"}, {"start_unix_ms", start_ms}})) {
+                results_[i].error = "start failed";
+                ok = false;
+            }
+        }
+        std::cout << "Distributed test started on " << count << " agents" << std::endl;
+
+        // Запас на разгон, досылку запросов в полёте и передачу гистограмм
+        const auto deadline = Clock::now() + kStartDelay + std::chrono::seconds(duration_seconds + 60);
+        for (size_t i = 0; i < count; ++i) {
+            Agent& agent = agents_[i];
+            if (!results_[i].error.empty()) {
+                continue;
+            }
+            json reply;
+            if (!receiveMessage(agent.fd, agent.buffer, reply, deadline)) {
+                results_[i].error = "no result";
+                ok = false;
+                continue;
+            }
+            if (reply.value("type", "") != "result") {
+                results_[i].error = reply.value("message", std::string("test failed"));
+                ok = false;
+                continue;
+            }
+            try {
+                results_[i].totals = countersFromJson(reply.at("counters"));
+                histogramFromJson(reply.at("histogram"), results_[i].latency);
+                // Агенты прежних версий фаз не присылают
+                if (reply.contains("phases")) {
+                    const json& phases = reply.at("phases");
+                    for (size_t p = 0; p < kRequestPhaseCount && p < phases.size(); ++p) {
+                        histogramFromJson(phases.at(p), results_[i].phases.phase[p]);
+                    }
+                }
+                results_[i].elapsed_seconds = reply.value("elapsed", 0.0);
+            } catch (const json::exception& e) {
+                results_[i].error = std::string("bad result: ") + e.what();
+                ok = false;
+            }
+        }
+    }
+
+    for (const auto& result : results_) {
+        if (!result.error.empty()) {
+            continue;
+        }
+        totals_.requests_started += result.totals.requests_started;
+        totals_.requests_sent += result.totals.requests_sent;
+        totals_.requests_failed += result.totals.requests_failed;
+        totals_.requests_cancelled += result.totals.requests_cancelled;
+        totals_.http_errors += result.totals.http_errors;
+        totals_.transport_errors += result.totals.transport_errors;
+        totals_.success_responses += result.totals.success_responses;
+        totals_.error_responses += result.totals.error_responses;
+        totals_.connections_opened += result.totals.connections_opened;
+        totals_.connections_reused += result.totals.connections_reused;
+        totals_.http2_streams += result.totals.http2_streams;
+        latency_.merge(result.latency);
+        phases_.merge(result.phases);
+        elapsed_seconds_ = std::max(elapsed_seconds_, result.elapsed_seconds);
+    }
+
+    reapAgents();
+    return ok;
+}
+
+void LoadCoordinator::printResults() const {
+    std::cout << "\n=== Distributed Load Test Results ===" << std::endl;
+    std::cout << std::left << std::setw(24) << "agent" << std::right
+              << std::setw(12) << "completed" << std::setw(12) << "success"
+              << std::setw(10) << "rps" << std::setw(12) << "p50 ms" << std::setw(12) << "p99 ms" << std::endl;
+    for (const auto& result : results_) {
+        std::cout << std::left << std::setw(24) << result.endpoint << std::right;
+        if (!result.error.empty()) {
+            std::cout << "  error: " << result.error << std::endl;
+            continue;
+        }
+        double rps = result.elapsed_seconds > 0 ? result.totals.completed() / result.elapsed_seconds : 0;
+        std::cout << std::setw(12) << result.totals.completed()
+                  << std::setw(12) << result.totals.success_responses
+                  << std::fixed << std::setprecision(1) << std::setw(10) << rps
+                  << std::setprecision(3) << std::setw(12) << result.latency.percentile(50) / 1e6
+                  << std::setw(12) << result.latency.percentile(99) / 1e6 << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+    std::cout << "\nMerged:" << std::endl;
+    LoadTester::printSummary(totals_, latency_, elapsed_seconds_);
+    LoadTester::printPhaseSummary(phases_);
+}
+
+/// @brief Выполняет команды одного координатора
+static void serveCoordinator(int fd) {
+    std::string buffer;
+    std::unique_ptr<LoadTester> tester;
+    int threads = 1;
+    int duration = 0;
+
+    json message;
+    while (receiveMessage(fd, buffer, message)) {
+        const std::string type = message.value("type", "");
+        if (type == "prepare") {
+            try {
+                tester = std::make_unique<LoadTester>();
+                tester->applyPlan(message.at("plan"));
+                threads = message.value("threads", 1);
+                duration = message.value("duration", 0);
+                sendMessage(fd, {{"type", "ready"}});
+            } catch (const std::exception& e) {
+                tester.reset();
+                sendMessage(fd, {{"type", "error"}, {"message", e.what()}});
+            }
+        } else if (type == "start") {
+            if (!tester) {
+                sendMessage(fd, {{"type", "error"}, {"message", "start before prepare"}});
+                continue;
+            }
+            std::this_thread::sleep_until(std::chrono::system_clock::time_point(
+                std::chrono::milliseconds(message.value("start_unix_ms", int64_t{0}))));
+            tester->runTest(threads, duration, 0);
+
+            LatencyHistogram latency;
+            tester->collectLatency(latency);
+            PhaseHistograms phases;
+            tester->collectPhases(phases);
+            json phases_json = json::array();
+            for (const auto& phase : phases.phase) {
+                phases_json.push_back(histogramToJson(phase));
+            }
+            sendMessage(fd, {{"type", "result"},
+                             {"elapsed", tester->testDuration()},
+                             {"counters", countersToJson(tester->collectCounters())},
+                             {"histogram", histogramToJson(latency)},
+                             {"phases", phases_json}});
+            tester.reset();
+        } else {
+            sendMessage(fd, {{"type", "error"}, {"message", "unknown command " + type}});
+        }
+    }
+    close(fd);
+}
+
+bool LoadAgent::serve(int port, bool once, const std::string& bind_address) {
+    int listen_fd = listenTcp(bind_address, port);
+    if (listen_fd < 0) {
+        std::cerr << "Agent: cannot listen on " << bind_address << ":" << port << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    std::cout << "Agent listening on " << bind_address << ":" << port << std::endl;
+
+    while (true) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        // Координаторы обслуживаются по одному: агент - это один тест за раз
+        serveCoordinator(fd);
+        if (once) {
+            break;
+        }
+    }
+    close(listen_fd);
+    return true;
+}
@@ -0,0 +1,125 @@
+/// @file distributed.hpp
+/// @brief Распределённый тест: координатор и агенты нагрузки по TCP
+
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <nlohmann/json.hpp>
+
+#include "latency_histogram.hpp"
+#include "request_phases.hpp"
+#include "worker_stats.hpp"
+
+/**
+ * @struct AgentResult
+ * @brief Итоги одного агента
+ */
+struct AgentResult {
+    std::string endpoint;           //< "хост:порт" агента
+    CounterTotals totals;           //< Счётчики агента
+    LatencyHistogram latency;       //< Гистограмма задержек агента (все корзины)
+    PhaseHistograms phases;         //< Гистограммы фаз запроса агента
+    double elapsed_seconds = 0;     //< Стенное время теста агента
+    std::string error;              //< Ошибка агента (пусто - успех)
+};
+
+/**
+ * @class LoadCoordinator
+ * @brief Координатор распределённого теста
+ *
+ * Раздаёт агентам JSON-план (LoadTester::exportPlan) с долей
+ * интенсивности, дожидается готовности всех и назначает общий момент
+ * старта по системным часам. Итоги сливаются без потерь: счётчики
+ * складываются, гистограммы - покорзинно, перцентили считаются по
+ * слитой гистограмме, а не усредняются.
+ *
+ * Протокол - строки JSON по TCP:
+ * координатор -> агент {"type":"prepare","plan":{...},"threads":N,"duration":S},
+ * агент -> {"type":"ready"}, координатор -> {"type":"start","start_unix_ms":T},
+ * агент -> {"type":"result","elapsed":...,"counters":{...},"histogram":{...},
+ * "phases":[{...}, ...]}.
+ * На удалённых машинах часы должны быть синхронизированы (NTP).
+ */
+class LoadCoordinator {
+public:
+    LoadCoordinator() = default;
+    ~LoadCoordinator();
+
+    LoadCoordinator(const LoadCoordinator&) = delete;
+    LoadCoordinator& operator=(const LoadCoordinator&) = delete;
+
+    /// @brief Добавляет уже запущенного агента (load_agent --port PORT)
+    void addAgent(const std::string& host, int port);
+
+    /// @brief Запускает локальных агентов дочерними процессами
+    /// @param agent_path Путь к исполняемому файлу load_agent
+    /// @param base_port Порт первого агента, следующие - по порядку
+    /// @return false, если процесс не запустился
+    bool spawnLocalAgents(int count, const std::string& agent_path, int base_port = 17700);
+
+    /// @brief Проводит тест на всех агентах
+    /// @param plan План теста (LoadTester::exportPlan)
+    /// @param threads_per_agent Потоков (событийных циклов) на агента
+    /// @param requests_per_second Общая интенсивность; делится поровну между агентами.
+    /// Профиль интенсивности плана делится так же
+    /// @return false, если хотя бы один агент не выполнил тест
+    bool run(const nlohmann::json& plan, int threads_per_agent, int duration_seconds,
+             double requests_per_second = 0);
+
+    /// @brief Итоги агентов последнего теста
+    const std::vector<AgentResult>& results() const { return results_; }
+
+    /// @brief Слитые счётчики всех агентов
+    const CounterTotals& totals() const { return totals_; }
+
+    /// @brief Слитая гистограмма задержек всех агентов
+    const LatencyHistogram& latency() const { return latency_; }
+
+    /// @brief Слитые гистограммы фаз запроса всех агентов
+    const PhaseHistograms& phases() const { return phases_; }
+
+    /// @brief Длительность теста - максимум стенного времени агентов
+    double elapsedSeconds() const { return elapsed_seconds_; }
+
+    /// @brief Выводит итоги по агентам и слитые итоги
+    void printResults() const;
+
+private:
+    /// @brief Агент теста
+    struct Agent {
+        std::string host;
+        int port = 0;
+        pid_t pid = -1;             //< Процесс локального агента (-1 - внешний)
+        int fd = -1;                //< Соединение с агентом
+        std::string buffer;         //< Непрочитанный остаток входящих данных
+    };
+
+    /// @brief Останавливает локальных агентов
+    void reapAgents();
+
+    std::vector<Agent> agents_;
+    std::vector<AgentResult> results_;
+    CounterTotals totals_;
+    LatencyHistogram latency_;
+    PhaseHistograms phases_;
+    double elapsed_seconds_ = 0;
+};
+
+/**
+ * @class LoadAgent
+ * @brief Агент нагрузки: выполняет тесты по командам координатора
+ */
+class LoadAgent {
+public:
+    /// @brief Принимает координаторов на порту и выполняет их тесты
+    /// @param once Завершиться после первого теста (локальные агенты координатора)
+    /// @param bind_address Адрес IPv4 для приёма; по умолчанию только локальные соединения,
+    /// "0.0.0.0" - все интерфейсы (протокол без аутентификации)
+    /// @return false, если порт не удалось занять
+    bool serve(int port, bool once = false, const std::string& bind_address = "127.0.0.1");
+};
+
+#endif // DISTRIBUTED_HPP
@@ -0,0 +1,246 @@
+/// @file event_log.cpp
+/// @brief Реализация асинхронного журнала событий
+
+#include "event_log.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "cpu_affinity.hpp"
+#include "worker_stats.hpp"
+
+void LogRecord::setDetail(const char* data, size_t size) {
+    detail_size = static_cast<uint16_t>(std::min(size, kDetailSize));
+    std::memcpy(detail, data, detail_size);
+}
+
+bool EventRing::push(const LogRecord& record) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+        bumpCounter(dropped_);
+        return false;
+    }
+    records_[head & (kCapacity - 1)] = record;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool EventRing::pop(LogRecord& record) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    record = records_[tail & (kCapacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+long EventRing::takeDropped() {
+    long total = dropped_.load(std::memory_order_relaxed);
+    long delta = total - dropped_reported_;
+    dropped_reported_ = total;
+    return delta;
+}
+
+EventLog::~EventLog() {
+    stop();
+}
+
+EventRing* EventLog::attach() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.push_back(std::make_unique<EventRing>());
+    return rings_.back().get();
+}
+
+void EventLog::setConsoleSink() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.close();
+    callback_ = nullptr;
+    sink_ = SinkKind::Console;
+}
+
+bool EventLog::setFileSink(const std::string& path) {
+    std::ofstream file(path, std::ios::app);
+    if (!file) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_ = std::move(file);
+    callback_ = nullptr;
+    sink_ = SinkKind::File;
+    return true;
+}
+
+void EventLog::setCallbackSink(LogCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.close();
+    callback_ = std::move(callback);
+    sink_ = callback_ ? SinkKind::Callback : SinkKind::Console;
+}
+
+void EventLog::setRateLimit(int lines_per_second) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rate_limit_ = std::max(0, lines_per_second);
+}
+
+void EventLog::start() {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&EventLog::run, this);
+}
+
+void EventLog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_one();
+    thread_.join();
+    flush();
+}
+
+void EventLog::flush() {
+    drain(true);
+}
+
+void EventLog::run() {
+    if (!affinity_.empty()) {
+        pinCurrentThread(affinity_);
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (running_) {
+        wake_.wait_for(lock, std::chrono::milliseconds(50));
+        lock.unlock();
+        drain(false);
+        lock.lock();
+    }
+}
+
+void EventLog::drain(bool close_window) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    if (window_start_ == std::chrono::steady_clock::time_point{}) {
+        window_start_ = now;
+    }
+
+    LogRecord record;
+    for (auto it = rings_.begin(); it != rings_.end();) {
+        EventRing& ring = **it;
+        // Флаг читается до опустошения: после него владелец уже ничего не добавит
+        bool retired = ring.retired();
+        while (ring.pop(record)) {
+            process(record);
+        }
+        dropped_ += ring.takeDropped();
+        it = retired ? rings_.erase(it) : it + 1;
+    }
+
+    if (close_window || now - window_start_ >= std::chrono::seconds(1)) {
+        closeWindow();
+        window_start_ = now;
+    }
+
+    if (sink_ == SinkKind::Console) {
+        std::fflush(stdout);
+        std::fflush(stderr);
+    } else if (sink_ == SinkKind::File) {
+        file_.flush();
+    }
+}
+
+void EventLog::process(const LogRecord& record) {
+    uint64_t key = static_cast<uint64_t>(record.kind) << 32 | static_cast<uint32_t>(record.code);
+    Repeats& repeats = window_[key];
+    bool is_error = record.kind != LogEventKind::Success;
+
+    if (repeats.seen == 0 && (rate_limit_ == 0 || lines_in_window_ < rate_limit_)) {
+        ++lines_in_window_;
+        emit(record, format(record), is_error);
+    } else {
+        ++repeats.suppressed;
+    }
+    ++repeats.seen;
+    repeats.last = record;
+}
+
+void EventLog::closeWindow() {
+    for (const auto& [key, repeats] : window_) {
+        if (repeats.suppressed == 0) {
+            continue;
+        }
+        std::ostringstream line;
+        line << label(repeats.last) << " ×" << repeats.suppressed;
+        emit(repeats.last, line.str(), repeats.last.kind != LogEventKind::Success);
+    }
+    window_.clear();
+    lines_in_window_ = 0;
+
+    if (dropped_ > 0) {
+        LogRecord record;
+        record.kind = LogEventKind::Exception;
+        emit(record, "Log overflow: " + std::to_string(dropped_) + " events dropped", true);
+        dropped_ = 0;
+    }
+}
+
+void EventLog::emit(const LogRecord& record, const std::string& line, bool is_error) {
+    switch (sink_) {
+    case SinkKind::Console:
+        std::fputs(line.c_str(), is_error ? stderr : stdout);
+        std::fputc('\n', is_error ? stderr : stdout);
+        break;
+    case SinkKind::File:
+        file_ << line << '\n';
+        break;
+    case SinkKind::Callback:
+        callback_(record, line);
+        break;
+    }
+}
+
+std::string EventLog::label(const LogRecord& record) {
+    switch (record.kind) {
+    case LogEventKind::Success:
+        return "SUCCESS";
+    case LogEventKind::CheckFailed:
+        return "Response check mismatch";
+    case LogEventKind::HttpError:
+        return "HTTP " + std::to_string(record.code);
+    case LogEventKind::TransportError:
+        return "CURL Error: " + (record.text ? std::string(record.text) : std::to_string(record.code));
+    case LogEventKind::Exception:
+        return "Exception: " + std::string(record.detail, record.detail_size);
+    }
+    return "";
+}
+
+std::string EventLog::format(const LogRecord& record) {
+    std::ostringstream line;
+    line << "Thread " << record.thread_id << " - ";
+    switch (record.kind) {
+    case LogEventKind::Success:
+        line << "Request " << record.request_id << " SUCCESS - Response time: "
+             << record.latency_us / 1000 << "ms";
+        break;
+    case LogEventKind::CheckFailed:
+        line << "Request " << record.request_id << " FAILED: response check mismatch";
+        break;
+    case LogEventKind::HttpError:
+        line << "HTTP Error: " << record.code << " - Response: "
+             << std::string(record.detail, record.detail_size);
+        break;
+    case LogEventKind::TransportError:
+    case LogEventKind::Exception:
+        line << label(record);
+        break;
+    }
+    return line.str();
+}
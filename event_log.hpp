@@ -0,0 +1,178 @@
+/// @file event_log.hpp
+/// @brief Асинхронный журнал событий рабочих потоков
+
+#ifndef EVENT_LOG_HPP
+#define EVENT_LOG_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @enum LogEventKind
+ * @brief Вид события журнала
+ */
+enum class LogEventKind : uint8_t {
+    Success,            //< Успешный ответ (выборочно)
+    CheckFailed,        //< Ответ не прошёл проверки
+    HttpError,          //< Недопустимый код HTTP
+    TransportError,     //< Ошибка CURL
+    Exception           //< Исключение на пути запроса
+};
+
+/**
+ * @struct LogRecord
+ * @brief Двоичная запись журнала фиксированного размера
+ *
+ * Форматируется в текст только потоком журнала, рабочий поток лишь
+ * копирует запись в своё кольцо.
+ */
+struct LogRecord {
+    static constexpr size_t kDetailSize = 88;   //< Сколько байт текста сохраняется
+
+    uint64_t time_ns = 0;           //< Момент события (steady_clock)
+    LogEventKind kind = LogEventKind::Success;
+    int32_t thread_id = 0;          //< Номер потока
+    int32_t request_id = 0;         //< Номер запроса
+    int32_t code = 0;               //< Код HTTP или CURLcode
+    uint32_t latency_us = 0;        //< Задержка ответа, мкс
+    const char* text = nullptr;     //< Статическая строка (например curl_easy_strerror)
+    uint16_t detail_size = 0;       //< Длина detail
+    char detail[kDetailSize];       //< Начало тела ответа или текста ошибки
+
+    /// @brief Копирует начало строки в detail
+    void setDetail(const char* data, size_t size);
+};
+
+/**
+ * @class EventRing
+ * @brief Кольцо записей одного рабочего потока (один писатель, один читатель)
+ *
+ * Запись не блокируется: при переполнении событие отбрасывается и
+ * учитывается в счётчике отброшенных.
+ */
+class EventRing {
+public:
+    static constexpr size_t kCapacity = 1024;   //< Ёмкость, степень двойки
+
+    /// @brief Добавляет запись (поток-владелец)
+    bool push(const LogRecord& record);
+
+    /// @brief Забирает запись (поток журнала)
+    bool pop(LogRecord& record);
+
+    /// @brief Владелец больше не пишет в кольцо, его можно освободить после опустошения
+    void retire() { retired_.store(true, std::memory_order_release); }
+
+    bool retired() const { return retired_.load(std::memory_order_acquire); }
+
+    /// @brief Забирает число отброшенных записей с прошлого вызова
+    long takeDropped();
+
+private:
+    alignas(64) std::atomic<size_t> head_{0};   //< Позиция записи (пишет владелец)
+    std::atomic<long> dropped_{0};              //< Отброшено при переполнении (пишет владелец)
+    alignas(64) std::atomic<size_t> tail_{0};   //< Позиция чтения (пишет поток журнала)
+    long dropped_reported_ = 0;                 //< Уже учтённые отброшенные записи
+    std::atomic<bool> retired_{false};
+    std::array<LogRecord, kCapacity> records_;
+};
+
+/// @brief Обработчик строк журнала: запись и готовая строка
+using LogCallback = std::function<void(const LogRecord& record, const std::string& line)>;
+
+/**
+ * @class EventLog
+ * @brief Журнал событий с фоновым потоком, ограничением частоты и схлопыванием повторов
+ *
+ * Фоновый поток периодически опустошает кольца потоков. Внутри окна в
+ * одну секунду первое событие каждого вида (вид + код) выводится целиком,
+ * пока не исчерпан лимит строк, а повторы только считаются и в конце
+ * окна выводятся одной строкой вида "HTTP 503 ×48213".
+ */
+class EventLog {
+public:
+    EventLog() = default;
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /// @brief Заводит кольцо для нового рабочего потока
+    EventRing* attach();
+
+    /// @brief Вывод в консоль: успехи в stdout, ошибки в stderr (по умолчанию)
+    void setConsoleSink();
+
+    /// @brief Вывод в файл (дописывает в конец)
+    /// @return false, если файл не открылся (вывод остаётся прежним)
+    bool setFileSink(const std::string& path);
+
+    /// @brief Вывод в обработчик
+    void setCallbackSink(LogCallback callback);
+
+    /// @brief Лимит полных строк в секунду (0 - без ограничения)
+    void setRateLimit(int lines_per_second);
+
+    /// @brief Ядра фонового потока (пусто - без привязки); действует со следующего start
+    void setThreadAffinity(std::vector<int> cpus) { affinity_ = std::move(cpus); }
+
+    /// @brief Запускает фоновый поток
+    void start();
+
+    /// @brief Останавливает фоновый поток, выводит остатки и итоги повторов
+    void stop();
+
+    /// @brief Опустошает кольца в вызывающем потоке и закрывает окно повторов
+    void flush();
+
+private:
+    enum class SinkKind { Console, File, Callback };
+
+    /// @brief Повторы одного вида событий в текущем окне
+    struct Repeats {
+        LogRecord last;             //< Последняя запись
+        long seen = 0;              //< Всего событий в окне
+        long suppressed = 0;        //< Не выведено целиком
+    };
+
+    void drain(bool close_window);
+    void process(const LogRecord& record);
+    void closeWindow();
+    void emit(const LogRecord& record, const std::string& line, bool is_error);
+    void run();
+
+    static std::string format(const LogRecord& record);
+    static std::string label(const LogRecord& record);
+
+    std::mutex mutex_;                          //< Кольца, вывод и окно повторов
+    std::vector<std::unique_ptr<EventRing>> rings_;
+
+    SinkKind sink_ = SinkKind::Console;
+    std::ofstream file_;
+    LogCallback callback_;
+
+    int rate_limit_ = 20;                       //< Полных строк в секунду
+    int lines_in_window_ = 0;
+    std::chrono::steady_clock::time_point window_start_;
+    std::unordered_map<uint64_t, Repeats> window_; //< Ключ: вид << 32 | код
+    long dropped_ = 0;                          //< Отброшено в текущем окне
+
+    std::thread thread_;
+    std::vector<int> affinity_;                 //< Ядра фонового потока
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+};
+
+#endif // EVENT_LOG_HPP
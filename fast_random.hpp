@@ -0,0 +1,86 @@
+/// @file fast_random.hpp
+/// @brief Быстрый генератор псевдослучайных чисел для рабочих потоков
+
+#ifndef FAST_RANDOM_HPP
+#define FAST_RANDOM_HPP
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * @class Xoshiro256
+ * @brief Генератор xoshiro256** (Blackman, Vigna)
+ *
+ * 32 байта состояния, несколько тактов на число. Не потокобезопасен:
+ * каждый рабочий поток держит свой экземпляр. Удовлетворяет требованиям
+ * UniformRandomBitGenerator, поэтому подходит для распределений std.
+ */
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed = 0x9E3779B97F4A7C15ull) {
+        reseed(seed);
+    }
+
+    /// @brief Переинициализирует состояние через splitmix64
+    void reseed(uint64_t seed) {
+        for (auto& word : s_) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    /// @brief Равномерное целое в [min_val, max_val] (метод Лемира, без деления в общем случае)
+    int64_t uniformInt(int64_t min_val, int64_t max_val) {
+        if (max_val <= min_val) {
+            return min_val;
+        }
+        uint64_t range = static_cast<uint64_t>(max_val - min_val) + 1;
+        if (range == 0) {
+            return static_cast<int64_t>((*this)());
+        }
+        unsigned __int128 m = static_cast<unsigned __int128>((*this)()) * range;
+        uint64_t low = static_cast<uint64_t>(m);
+        if (low < range) {
+            uint64_t threshold = (0 - range) % range;
+            while (low < threshold) {
+                m = static_cast<unsigned __int128>((*this)()) * range;
+                low = static_cast<uint64_t>(m);
+            }
+        }
+        return min_val + static_cast<int64_t>(m >> 64);
+    }
+
+    /// @brief Равномерное вещественное в [0, 1)
+    double uniformDouble() {
+        return ((*this)() >> 11) * 0x1.0p-53;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t s_[4];     //< Состояние генератора
+};
+
+#endif // FAST_RANDOM_HPP
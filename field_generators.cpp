@@ -0,0 +1,575 @@
+/// @file field_generators.cpp
+/// @brief Реализация генераторов значений полей
+
+#include "field_generators.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+constexpr size_t kNoRow = std::numeric_limits<size_t>::max();
+
+/// @brief Алфавит случайных строк: 64 символа, не требующих экранирования в JSON
+constexpr char kStringAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+/// @brief log1p(x) / x с устойчивостью около нуля
+double helper1(double x) {
+    return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+/// @brief expm1(x) / x с устойчивостью около нуля
+double helper2(double x) {
+    return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+}
+
+/// @brief Разбивает описание генератора по ':'
+std::vector<std::string> splitSpec(const std::string& spec) {
+    std::vector<std::string> parts;
+    size_t pos = 0;
+    while (true) {
+        size_t end = spec.find(':', pos);
+        parts.push_back(spec.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        pos = end + 1;
+    }
+}
+
+int64_t parseInt(const std::string& spec, const std::string& text) {
+    int64_t value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || end != text.data() + text.size()) {
+        throw std::invalid_argument("invalid number '" + text + "' in generator '" + spec + "'");
+    }
+    return value;
+}
+
+double parseDouble(const std::string& spec, const std::string& text) {
+    char* end = nullptr;
+    const double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !std::isfinite(value)) {
+        throw std::invalid_argument("invalid number '" + text + "' in generator '" + spec + "'");
+    }
+    return value;
+}
+
+/// @brief Проверяет число аргументов генератора
+void expectArgs(const std::string& spec, const std::vector<std::string>& parts, size_t min_args, size_t max_args) {
+    const size_t args = parts.size() - 1;
+    if (args < min_args || args > max_args) {
+        throw std::invalid_argument("wrong number of arguments in generator '" + spec + "'");
+    }
+}
+
+/// @brief Дописывает целое в десятичной записи
+void appendInt(std::string& out, int64_t value) {
+    char digits[24];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    (void)ec;
+    out.append(digits, end);
+}
+
+/// @brief Дописывает count десятичных цифр value с ведущими нулями
+void appendPadded(std::string& out, int64_t value, int count) {
+    char digits[8];
+    for (int i = count - 1; i >= 0; --i) {
+        digits[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    out.append(digits, static_cast<size_t>(count));
+}
+
+/// @brief Дописывает UUID из 16 байт в каноническом виде 8-4-4-4-12
+void appendUuid(std::string& out, uint64_t high, uint64_t low) {
+    char text[36];
+    size_t pos = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            text[pos++] = '-';
+        }
+        const uint64_t word = i < 8 ? high : low;
+        const unsigned byte = static_cast<unsigned>(word >> (56 - 8 * (i % 8))) & 0xFF;
+        text[pos++] = kHexDigits[byte >> 4];
+        text[pos++] = kHexDigits[byte & 0xF];
+    }
+    out.append(text, sizeof(text));
+}
+
+/// @brief Дописывает момент в виде 2024-05-01T12:34:56.789Z
+void appendIso(std::string& out, int64_t unix_ms) {
+    int64_t days = unix_ms / 86400000;
+    int64_t ms_of_day = unix_ms % 86400000;
+    if (ms_of_day < 0) {
+        ms_of_day += 86400000;
+        --days;
+    }
+    // Дата из числа дней (алгоритм civil_from_days, Howard Hinnant)
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int64_t doe = days - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    const int64_t day = doy - (153 * mp + 2) / 5 + 1;
+    const int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+    appendPadded(out, year, 4);
+    out.push_back('-');
+    appendPadded(out, month, 2);
+    out.push_back('-');
+    appendPadded(out, day, 2);
+    out.push_back('T');
+    appendPadded(out, ms_of_day / 3600000, 2);
+    out.push_back(':');
+    appendPadded(out, ms_of_day / 60000 % 60, 2);
+    out.push_back(':');
+    appendPadded(out, ms_of_day / 1000 % 60, 2);
+    out.push_back('.');
+    appendPadded(out, ms_of_day % 1000, 3);
+    out.push_back('Z');
+}
+
+/// @brief Время Unix в микросекундах
+int64_t unixMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/// @brief Дописывает ячейку CSV, экранированную для JSON-строки
+void appendEscaped(std::string& out, const std::string& cell) {
+    for (unsigned char c : cell) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                out += "\\u00";
+                out.push_back(kHexDigits[c >> 4]);
+                out.push_back(kHexDigits[c & 0xF]);
+            } else {
+                out.push_back(static_cast<char>(c));
+            }
+        }
+    }
+}
+
+/// @brief Строка - число по грамматике JSON
+bool isJsonNumber(std::string_view text) {
+    size_t pos = 0;
+    auto digits = [&]() {
+        const size_t from = pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            ++pos;
+        }
+        return pos - from;
+    };
+    if (pos < text.size() && text[pos] == '-') {
+        ++pos;
+    }
+    const size_t int_start = pos;
+    const size_t int_digits = digits();
+    if (int_digits == 0 || (int_digits > 1 && text[int_start] == '0')) {
+        return false;
+    }
+    if (pos < text.size() && text[pos] == '.') {
+        ++pos;
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+        ++pos;
+        if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+            ++pos;
+        }
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    return pos == text.size();
+}
+} // namespace
+
+void ZipfSampler::build(int64_t n, double exponent) {
+    n_ = std::max<int64_t>(1, n);
+    exponent_ = std::max(0.0, exponent);
+    h_integral_x1_ = hIntegral(1.5) - 1.0;
+    h_integral_n_ = hIntegral(static_cast<double>(n_) + 0.5);
+    s_ = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+}
+
+double ZipfSampler::h(double x) const {
+    return std::exp(-exponent_ * std::log(x));
+}
+
+double ZipfSampler::hIntegral(double x) const {
+    const double log_x = std::log(x);
+    return helper2((1.0 - exponent_) * log_x) * log_x;
+}
+
+double ZipfSampler::hIntegralInverse(double x) const {
+    double t = x * (1.0 - exponent_);
+    if (t < -1.0) {
+        t = -1.0;
+    }
+    return std::exp(helper1(t) * x);
+}
+
+int64_t ZipfSampler::sample(Xoshiro256& rng) const {
+    while (true) {
+        const double u = h_integral_n_ + rng.uniformDouble() * (h_integral_x1_ - h_integral_n_);
+        const double x = hIntegralInverse(u);
+        int64_t k = static_cast<int64_t>(x + 0.5);
+        if (k < 1) {
+            k = 1;
+        } else if (k > n_) {
+            k = n_;
+        }
+        const double kd = static_cast<double>(k);
+        if (kd - x <= s_ || u >= hIntegral(kd + 0.5) - h(kd)) {
+            return k;
+        }
+    }
+}
+
+std::shared_ptr<const DataPool> DataPool::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("cannot open data pool " + path);
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    const std::string text = content.str();
+
+    auto pool = std::make_shared<DataPool>();
+    pool->path_ = path;
+
+    // Разбор CSV: ячейки строки собираются в row, затем переносятся в буфер
+    std::vector<std::string> row;
+    std::string cell;
+    bool header = true;
+    auto finishRow = [&]() {
+        if (row.size() == 1 && row[0].empty()) {
+            row.clear();
+            return;     // Пустая строка
+        }
+        if (header) {
+            pool->names_ = row;
+            pool->max_sizes_.assign(row.size(), 0);
+            pool->offsets_.push_back(0);
+            header = false;
+        } else {
+            const size_t columns = pool->names_.size();
+            for (size_t c = 0; c < columns; ++c) {
+                const size_t before = pool->arena_.size();
+                if (c < row.size()) {
+                    appendEscaped(pool->arena_, row[c]);
+                }
+                pool->max_sizes_[c] = std::max(pool->max_sizes_[c], pool->arena_.size() - before);
+                pool->offsets_.push_back(pool->arena_.size());
+            }
+            ++pool->rows_;
+        }
+        row.clear();
+    };
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        cell.clear();
+        if (text[pos] == '"') {
+            ++pos;
+            while (pos < text.size()) {
+                if (text[pos] == '"') {
+                    if (pos + 1 < text.size() && text[pos + 1] == '"') {
+                        cell.push_back('"');
+                        pos += 2;
+                        continue;
+                    }
+                    ++pos;
+                    break;
+                }
+                cell.push_back(text[pos++]);
+            }
+        }
+        while (pos < text.size() && text[pos] != ',' && text[pos] != '\n' && text[pos] != '\r') {
+            cell.push_back(text[pos++]);
+        }
+        row.push_back(cell);
+
+        if (pos >= text.size()) {
+            break;
+        }
+        if (text[pos] == ',') {
+            ++pos;
+            if (pos == text.size()) {
+                row.emplace_back();
+            }
+            continue;
+        }
+        if (text[pos] == '\r' && pos + 1 < text.size() && text[pos + 1] == '\n') {
+            ++pos;
+        }
+        ++pos;
+        finishRow();
+    }
+    if (!row.empty()) {
+        finishRow();
+    }
+
+    if (pool->names_.empty() || pool->rows_ == 0) {
+        throw std::runtime_error("data pool " + path + " has no data rows");
+    }
+    pool->arena_.shrink_to_fit();
+    pool->offsets_.shrink_to_fit();
+    return pool;
+}
+
+int DataPool::column(const std::string& name) const {
+    auto it = std::find(names_.begin(), names_.end(), name);
+    if (it != names_.end()) {
+        return static_cast<int>(it - names_.begin());
+    }
+    if (!name.empty() && name.find_first_not_of("0123456789") == std::string::npos) {
+        const unsigned long index = std::strtoul(name.c_str(), nullptr, 10);
+        if (index < names_.size()) {
+            return static_cast<int>(index);
+        }
+    }
+    return -1;
+}
+
+bool DataPool::isNumeric(size_t column) const {
+    for (size_t row = 0; row < rows_; ++row) {
+        if (!isJsonNumber(cell(row, column))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FieldGenerator FieldGenerator::uniform(int64_t min_val, int64_t max_val, bool quoted) {
+    FieldGenerator generator;
+    generator.kind = GeneratorKind::Uniform;
+    generator.min_val = min_val;
+    generator.max_val = max_val;
+    generator.quoted = quoted;
+    return generator;
+}
+
+bool FieldGenerator::parse(const std::string& spec, const DataPools& pools, FieldGenerator& out,
+                           std::shared_ptr<const DataPool>& pool_ref) {
+    const std::vector<std::string> parts = splitSpec(spec);
+    const std::string& kind = parts[0];
+    FieldGenerator generator;
+    generator.quoted = false;
+
+    if (kind == "random" || kind == "int") {
+        expectArgs(spec, parts, 0, 2);
+        if (parts.size() == 2) {
+            throw std::invalid_argument("generator '" + spec + "' needs both MIN and MAX");
+        }
+        generator = uniform(parts.size() > 1 ? parseInt(spec, parts[1]) : 0,
+                            parts.size() > 2 ? parseInt(spec, parts[2]) : 9999, kind == "random");
+    } else if (kind == "seq") {
+        expectArgs(spec, parts, 0, 2);
+        generator.kind = GeneratorKind::Sequence;
+        generator.start = parts.size() > 1 ? parseInt(spec, parts[1]) : 1;
+        generator.step = parts.size() > 2 ? parseInt(spec, parts[2]) : 1;
+    } else if (kind == "uuid4" || kind == "uuid7") {
+        expectArgs(spec, parts, 0, 0);
+        generator.kind = kind == "uuid4" ? GeneratorKind::Uuid4 : GeneratorKind::Uuid7;
+        generator.quoted = true;
+    } else if (kind == "timestamp") {
+        expectArgs(spec, parts, 0, 1);
+        generator.kind = GeneratorKind::Timestamp;
+        const std::string unit = parts.size() > 1 ? parts[1] : "ms";
+        if (unit == "s") {
+            generator.unit = TimestampUnit::Seconds;
+        } else if (unit == "ms") {
+            generator.unit = TimestampUnit::Millis;
+        } else if (unit == "us") {
+            generator.unit = TimestampUnit::Micros;
+        } else if (unit == "iso") {
+            generator.unit = TimestampUnit::Iso;
+            generator.quoted = true;
+        } else {
+            throw std::invalid_argument("unknown timestamp unit in generator '" + spec + "'");
+        }
+    } else if (kind == "string") {
+        expectArgs(spec, parts, 1, 2);
+        generator.kind = GeneratorKind::String;
+        generator.quoted = true;
+        generator.min_val = parseInt(spec, parts[1]);
+        generator.max_val = parts.size() > 2 ? parseInt(spec, parts[2]) : generator.min_val;
+        if (generator.min_val < 0 || generator.max_val < generator.min_val || generator.max_val > (1 << 20)) {
+            throw std::invalid_argument("invalid length in generator '" + spec + "'");
+        }
+    } else if (kind == "zipf") {
+        expectArgs(spec, parts, 1, 2);
+        generator.kind = GeneratorKind::Zipf;
+        const int64_t n = parseInt(spec, parts[1]);
+        const double exponent = parts.size() > 2 ? parseDouble(spec, parts[2]) : 1.0;
+        if (n < 1 || exponent < 0) {
+            throw std::invalid_argument("zipf needs N >= 1 and S >= 0 in generator '" + spec + "'");
+        }
+        generator.zipf.build(n, exponent);
+    } else if (kind == "gauss") {
+        if (parts.size() != 3 && parts.size() != 5) {
+            throw std::invalid_argument("wrong number of arguments in generator '" + spec + "'");
+        }
+        generator.kind = GeneratorKind::Gaussian;
+        generator.mean = parseDouble(spec, parts[1]);
+        generator.stddev = parseDouble(spec, parts[2]);
+        if (parts.size() == 5) {
+            generator.clamp = true;
+            generator.min_val = parseInt(spec, parts[3]);
+            generator.max_val = parseInt(spec, parts[4]);
+        }
+        if (generator.stddev < 0 || (generator.clamp && generator.max_val < generator.min_val)) {
+            throw std::invalid_argument("invalid range in generator '" + spec + "'");
+        }
+    } else if (kind == "pool") {
+        expectArgs(spec, parts, 1, 3);
+        auto it = pools.find(parts[1]);
+        if (it == pools.end()) {
+            throw std::invalid_argument("unknown data pool '" + parts[1] + "' in generator '" + spec + "'");
+        }
+        generator.kind = GeneratorKind::Pool;
+        generator.pool = it->second.get();
+        const int column = generator.pool->column(parts.size() > 2 ? parts[2] : "0");
+        if (column < 0) {
+            throw std::invalid_argument("unknown column in generator '" + spec + "'");
+        }
+        generator.column = static_cast<size_t>(column);
+        generator.quoted = true;
+        if (parts.size() > 3) {
+            if (parts[3] != "number") {
+                throw std::invalid_argument("unknown option '" + parts[3] + "' in generator '" + spec + "'");
+            }
+            if (!generator.pool->isNumeric(generator.column)) {
+                throw std::invalid_argument("column is not numeric in generator '" + spec + "'");
+            }
+            generator.quoted = false;
+        }
+        pool_ref = it->second;
+    } else {
+        return false;
+    }
+
+    out = std::move(generator);
+    return true;
+}
+
+size_t FieldGenerator::maxSize() const {
+    const size_t quotes = quoted ? 2 : 0;
+    switch (kind) {
+    case GeneratorKind::Uuid4:
+    case GeneratorKind::Uuid7:
+        return 36 + quotes;
+    case GeneratorKind::Timestamp:
+        return (unit == TimestampUnit::Iso ? 24 : 20) + quotes;
+    case GeneratorKind::String:
+        return static_cast<size_t>(max_val) + quotes;
+    case GeneratorKind::Pool:
+        return pool->maxCellSize(column) + quotes;
+    default:
+        return 20 + quotes;
+    }
+}
+
+void FieldGenerator::write(std::string& out, Xoshiro256& rng, GeneratorState& state) const {
+    if (quoted) {
+        out.push_back('"');
+    }
+
+    switch (kind) {
+    case GeneratorKind::Uniform:
+        appendInt(out, rng.uniformInt(min_val, max_val));
+        break;
+    case GeneratorKind::Sequence: {
+        // Потоки идут вперемешку: i-е значение потока t - (i * потоков + t)-е значение последовательности
+        const uint64_t n = state.sequences[state_index]++;
+        appendInt(out, start + static_cast<int64_t>(n * state.thread_count + state.thread_index) * step);
+        break;
+    }
+    case GeneratorKind::Uuid4: {
+        const uint64_t high = (rng() & ~0xF000ull) | 0x4000ull;
+        const uint64_t low = (rng() & ~(3ull << 62)) | (2ull << 62);
+        appendUuid(out, high, low);
+        break;
+    }
+    case GeneratorKind::Uuid7: {
+        const uint64_t unix_ms = static_cast<uint64_t>(unixMicros() / 1000);
+        const uint64_t high = (unix_ms << 16) | 0x7000ull | (rng() & 0xFFFull);
+        const uint64_t low = (rng() & ~(3ull << 62)) | (2ull << 62);
+        appendUuid(out, high, low);
+        break;
+    }
+    case GeneratorKind::Timestamp: {
+        const int64_t us = unixMicros();
+        switch (unit) {
+        case TimestampUnit::Seconds: appendInt(out, us / 1000000); break;
+        case TimestampUnit::Millis: appendInt(out, us / 1000); break;
+        case TimestampUnit::Micros: appendInt(out, us); break;
+        case TimestampUnit::Iso: appendIso(out, us / 1000); break;
+        }
+        break;
+    }
+    case GeneratorKind::String: {
+        const size_t length = static_cast<size_t>(rng.uniformInt(min_val, max_val));
+        const size_t from = out.size();
+        out.resize(from + length);
+        char* text = &out[from];
+        // Одно 64-битное число даёт 10 символов по 6 бит
+        for (size_t i = 0; i < length;) {
+            uint64_t bits = rng();
+            for (int j = 0; j < 10 && i < length; ++j, ++i) {
+                text[i] = kStringAlphabet[bits & 63];
+                bits >>= 6;
+            }
+        }
+        break;
+    }
+    case GeneratorKind::Zipf:
+        appendInt(out, zipf.sample(rng));
+        break;
+    case GeneratorKind::Gaussian: {
+        // Бокс - Мюллер; 1 - u не обращается в ноль под логарифмом
+        const double u1 = 1.0 - rng.uniformDouble();
+        const double u2 = rng.uniformDouble();
+        const double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+        int64_t value = std::llround(mean + stddev * z);
+        if (clamp) {
+            value = std::min(std::max(value, min_val), max_val);
+        }
+        appendInt(out, value);
+        break;
+    }
+    case GeneratorKind::Pool: {
+        size_t& row = state.pool_rows[state_index];
+        if (row == kNoRow) {
+            row = static_cast<size_t>(rng.uniformInt(0, static_cast<int64_t>(pool->rows()) - 1));
+        }
+        const std::string_view value = pool->cell(row, column);
+        out.append(value.data(), value.size());
+        break;
+    }
+    }
+
+    if (quoted) {
+        out.push_back('"');
+    }
+}
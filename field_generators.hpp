@@ -0,0 +1,179 @@
+/// @file field_generators.hpp
+/// @brief Генераторы значений полей тела запроса
+
+#ifndef FIELD_GENERATORS_HPP
+#define FIELD_GENERATORS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "fast_random.hpp"
+
+/**
+ * @class ZipfSampler
+ * @brief Распределение Ципфа на 1..N: значение k выпадает с весом 1/k^s
+ *
+ * Метод rejection-inversion (Hörmann, Derflinger): без таблиц, O(1) памяти
+ * при любом N, в среднем чуть больше одного равномерного числа на значение.
+ */
+class ZipfSampler {
+public:
+    /// @brief Настраивает распределение
+    /// @param n Число значений (не меньше 1)
+    /// @param exponent Показатель s (не меньше 0; 0 - равномерное)
+    void build(int64_t n, double exponent);
+
+    /// @brief Очередное значение в [1, N]; 1 - самое частое
+    int64_t sample(Xoshiro256& rng) const;
+
+private:
+    double h(double x) const;
+    double hIntegral(double x) const;
+    double hIntegralInverse(double x) const;
+
+    int64_t n_ = 1;
+    double exponent_ = 1.0;
+    double h_integral_x1_ = 0.0;    //< H(1.5) - 1
+    double h_integral_n_ = 0.0;     //< H(N + 0.5)
+    double s_ = 0.0;                //< Порог быстрого принятия
+};
+
+/**
+ * @class DataPool
+ * @brief Таблица из CSV-файла, загруженная в один непрерывный буфер
+ *
+ * Первая строка файла - имена столбцов. Ячейки хранятся подряд уже
+ * экранированными для JSON-строки, поэтому при отправке копируются как есть.
+ */
+class DataPool {
+public:
+    /// @brief Загружает CSV-файл (RFC 4180: запятые, кавычки, "" внутри кавычек)
+    /// @details Бросает std::runtime_error, если файл не читается или в нём нет строк данных
+    static std::shared_ptr<const DataPool> load(const std::string& path);
+
+    /// @brief Путь к исходному файлу
+    const std::string& path() const { return path_; }
+
+    size_t rows() const { return rows_; }
+    size_t columns() const { return names_.size(); }
+
+    /// @brief Номер столбца по имени или по номеру в виде числа (-1 - нет такого)
+    int column(const std::string& name) const;
+
+    /// @brief Ячейка, экранированная для JSON-строки (без кавычек)
+    std::string_view cell(size_t row, size_t column) const {
+        const size_t index = row * names_.size() + column;
+        return std::string_view(arena_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+    }
+
+    /// @brief Длина самой длинной ячейки столбца
+    size_t maxCellSize(size_t column) const { return max_sizes_[column]; }
+
+    /// @brief Все ячейки столбца - JSON-числа
+    bool isNumeric(size_t column) const;
+
+private:
+    std::string path_;
+    std::vector<std::string> names_;    //< Имена столбцов
+    std::string arena_;                 //< Ячейки подряд, по строкам
+    std::vector<size_t> offsets_;       //< Начала ячеек в arena_ (плюс конец последней)
+    std::vector<size_t> max_sizes_;     //< Самая длинная ячейка каждого столбца
+    size_t rows_ = 0;
+};
+
+/// @brief Именованные таблицы данных для шаблонов ("{{pool:NAME:COLUMN}}")
+using DataPools = std::unordered_map<std::string, std::shared_ptr<const DataPool>>;
+
+/**
+ * @struct GeneratorState
+ * @brief Изменяемое состояние генераторов одного шаблона в одном рабочем потоке
+ *
+ * Заводится до теста (BodyTemplate::initState), поэтому на каждом запросе
+ * не выделяет память.
+ */
+struct GeneratorState {
+    uint64_t thread_index = 0;          //< Номер рабочего потока
+    uint64_t thread_count = 1;          //< Всего рабочих потоков
+    std::vector<uint64_t> sequences;    //< Выдано значений каждой последовательностью
+    std::vector<size_t> pool_rows;      //< Строка таблицы в текущем теле (SIZE_MAX - ещё не выбрана)
+};
+
+/// @brief Вид генератора значения поля
+enum class GeneratorKind : uint8_t {
+    Uniform,        //< Равномерное целое в [min, max]
+    Sequence,       //< Возрастающая последовательность, уникальная между потоками
+    Uuid4,          //< Случайный UUID версии 4
+    Uuid7,          //< UUID версии 7 (время в мс + случайные биты)
+    Timestamp,      //< Текущее время
+    String,         //< Случайная строка [A-Za-z0-9_-]
+    Zipf,           //< Целое 1..N по закону Ципфа
+    Gaussian,       //< Целое из нормального распределения
+    Pool            //< Ячейка случайной строки таблицы данных
+};
+
+/// @brief Представление времени генератора Timestamp
+enum class TimestampUnit : uint8_t {
+    Seconds,        //< Секунды Unix (число)
+    Millis,         //< Миллисекунды Unix (число)
+    Micros,         //< Микросекунды Unix (число)
+    Iso             //< Строка ISO 8601 в UTC с миллисекундами
+};
+
+/**
+ * @struct FieldGenerator
+ * @brief Разобранный генератор значения поля
+ *
+ * Описание - строка вида "KIND[:ARG...]":
+ *   random[:MIN:MAX]         - равномерное целое, строкой (как раньше)
+ *   int[:MIN:MAX]            - равномерное целое, числом
+ *   seq[:START[:STEP]]       - START, START+STEP, ... без повторов между потоками
+ *   uuid4, uuid7             - UUID строкой
+ *   timestamp[:s|ms|us|iso]  - текущее время (по умолчанию ms)
+ *   string:LEN[:MAX]         - случайная строка длины LEN (или LEN..MAX)
+ *   zipf:N[:S]               - целое 1..N по закону Ципфа (S по умолчанию 1)
+ *   gauss:MEAN:STDDEV[:MIN:MAX] - округлённое нормальное, с ограничением
+ *   pool:NAME[:COLUMN[:number]] - ячейка таблицы; поля одного тела берут одну строку
+ *
+ * Всё случайное берётся из генератора потока, поэтому при заданном зерне
+ * тела повторяются. Исключение - время в timestamp и uuid7.
+ */
+struct FieldGenerator {
+    GeneratorKind kind = GeneratorKind::Uniform;
+    bool quoted = true;                 //< Выводить как JSON-строку
+    int64_t min_val = 0;                //< Uniform, String (длина), Gaussian (ограничение)
+    int64_t max_val = 9999;
+    int64_t start = 1;                  //< Sequence
+    int64_t step = 1;
+    double mean = 0.0;                  //< Gaussian
+    double stddev = 1.0;
+    bool clamp = false;                 //< Gaussian ограничен [min_val, max_val]
+    TimestampUnit unit = TimestampUnit::Millis;
+    ZipfSampler zipf;
+    const DataPool* pool = nullptr;     //< Pool: таблица (владеет шаблон)
+    size_t column = 0;                  //< Pool: столбец
+    size_t state_index = 0;             //< Номер последовательности или таблицы в GeneratorState
+
+    /// @brief Равномерное целое в [min_val, max_val]
+    static FieldGenerator uniform(int64_t min_val, int64_t max_val, bool quoted);
+
+    /// @brief Разбирает описание генератора
+    /// @param pools Таблицы для pool
+    /// @param[out] pool_ref Таблица, которую генератор использует (для продления жизни)
+    /// @return false, если вид генератора неизвестен;
+    /// std::invalid_argument при ошибке в аргументах или неизвестной таблице
+    static bool parse(const std::string& spec, const DataPools& pools, FieldGenerator& out,
+                      std::shared_ptr<const DataPool>& pool_ref);
+
+    /// @brief Наибольшая длина значения, включая кавычки
+    size_t maxSize() const;
+
+    /// @brief Дописывает значение в конец out
+    void write(std::string& out, Xoshiro256& rng, GeneratorState& state) const;
+};
+
+#endif // FIELD_GENERATORS_HPP
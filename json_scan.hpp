@@ -0,0 +1,228 @@
+/// @file json_scan.hpp
+/// @brief Потоковый разбор JSON по буферу без выделения памяти
+
+#ifndef JSON_SCAN_HPP
+#define JSON_SCAN_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/**
+ * @struct JsonCursor
+ * @brief Курсор по JSON-тексту
+ *
+ * Разбирает токены прямо в исходном буфере: строки и числа возвращаются
+ * как указатель и длина внутри буфера, пропуск поддерева только
+ * проверяет синтаксис. Глубина вложенности ограничена, чтобы
+ * враждебный ввод не переполнил стек.
+ */
+struct JsonCursor {
+    static constexpr int kMaxDepth = 256;   //< Максимальная вложенность
+
+    const char* p;          //< Текущая позиция
+    const char* end;        //< Конец буфера
+
+    JsonCursor(const char* data, size_t size) : p(data), end(data + size) {}
+
+    bool atEnd() const { return p >= end; }
+
+    char peek() const { return p < end ? *p : '\0'; }
+
+    void skipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+            ++p;
+        }
+    }
+
+    /// @brief Ожидает символ c после пробелов и пропускает его
+    bool consume(char c) {
+        skipWhitespace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    /// @brief Читает строку; p указывает на открывающую кавычку
+    /// @param[out] data Начало содержимого (без кавычек, escape-последовательности не раскрыты)
+    /// @param[out] size Длина содержимого
+    /// @param[out] escaped Есть ли escape-последовательности
+    bool readString(const char*& data, size_t& size, bool& escaped) {
+        if (p >= end || *p != '"') {
+            return false;
+        }
+        ++p;
+        data = p;
+        escaped = false;
+        while (p < end) {
+            char c = *p;
+            if (c == '"') {
+                size = static_cast<size_t>(p - data);
+                ++p;
+                return true;
+            }
+            if (c == '\\') {
+                escaped = true;
+                if (++p >= end) {
+                    return false;
+                }
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            ++p;
+        }
+        return false;
+    }
+
+    /// @brief Читает число, true, false или null как токен
+    bool readScalar(const char*& data, size_t& size) {
+        data = p;
+        if (p < end && (*p == 't' || *p == 'f' || *p == 'n')) {
+            const char* literal = *p == 't' ? "true" : (*p == 'f' ? "false" : "null");
+            size_t len = std::strlen(literal);
+            if (static_cast<size_t>(end - p) < len || std::memcmp(p, literal, len) != 0) {
+                return false;
+            }
+            p += len;
+            size = len;
+            return true;
+        }
+
+        if (p < end && *p == '-') {
+            ++p;
+        }
+        const char* digits = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+        if (p == digits) {
+            return false;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            const char* frac = p;
+            while (p < end && *p >= '0' && *p <= '9') {
+                ++p;
+            }
+            if (p == frac) {
+                return false;
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if (p < end && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            const char* exp = p;
+            while (p < end && *p >= '0' && *p <= '9') {
+                ++p;
+            }
+            if (p == exp) {
+                return false;
+            }
+        }
+        size = static_cast<size_t>(p - data);
+        return true;
+    }
+
+    /// @brief Пропускает значение целиком, проверяя синтаксис
+    bool skipValue(int depth = 0) {
+        skipWhitespace();
+        if (p >= end || depth > kMaxDepth) {
+            return false;
+        }
+
+        const char* data;
+        size_t size;
+        bool escaped;
+        switch (*p) {
+        case '"':
+            return readString(data, size, escaped);
+        case '{':
+            ++p;
+            if (consume('}')) {
+                return true;
+            }
+            do {
+                skipWhitespace();
+                if (!readString(data, size, escaped) || !consume(':') || !skipValue(depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        case '[':
+            ++p;
+            if (consume(']')) {
+                return true;
+            }
+            do {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+        default:
+            return readScalar(data, size);
+        }
+    }
+};
+
+/// @brief Раскрывает escape-последовательности строки JSON в out
+/// @return false при некорректной последовательности
+inline bool unescapeJsonString(const char* data, size_t size, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (++i >= size) {
+            return false;
+        }
+        switch (data[i]) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+            if (i + 4 >= size) {
+                return false;
+            }
+            unsigned code = 0;
+            for (int k = 1; k <= 4; ++k) {
+                char h = data[i + k];
+                code <<= 4;
+                if (h >= '0' && h <= '9') code |= static_cast<unsigned>(h - '0');
+                else if (h >= 'a' && h <= 'f') code |= static_cast<unsigned>(h - 'a' + 10);
+                else if (h >= 'A' && h <= 'F') code |= static_cast<unsigned>(h - 'A' + 10);
+                else return false;
+            }
+            i += 4;
+            // Суррогатные пары не склеиваем: для сравнения с ожидаемыми значениями достаточно BMP
+            if (code < 0x80) {
+                out.push_back(static_cast<char>(code));
+            } else if (code < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else {
+                out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // JSON_SCAN_HPP
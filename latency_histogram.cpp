@@ -0,0 +1,153 @@
+/// @file latency_histogram.cpp
+/// @brief Реализация гистограмм задержек
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() : counts_(kBucketCount, 0) {
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value_ns) {
+    if (value_ns < kSubBuckets) {
+        return static_cast<size_t>(value_ns);
+    }
+    int msb = 63 - __builtin_clzll(value_ns);
+    if (msb >= kMaxValueBits) {
+        return kBucketCount - 1;
+    }
+    // Старшие kSubBucketBits + 1 бит значения: [kSubBuckets, 2 * kSubBuckets)
+    int shift = msb - kSubBucketBits;
+    uint64_t top = value_ns >> shift;
+    return static_cast<size_t>(shift + 1) * kSubBuckets + static_cast<size_t>(top - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::bucketLower(size_t index) {
+    if (index < 2 * kSubBuckets) {
+        return index;
+    }
+    size_t magnitude = index / kSubBuckets;
+    uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub) << (magnitude - 1);
+}
+
+uint64_t LatencyHistogram::bucketUpper(size_t index) {
+    if (index < 2 * kSubBuckets) {
+        return index + 1;
+    }
+    size_t magnitude = index / kSubBuckets;
+    return bucketLower(index) + (1ull << (magnitude - 1));
+}
+
+void LatencyHistogram::record(uint64_t value_ns, uint64_t count) {
+    counts_[bucketIndex(value_ns)] += count;
+    total_count_ += count;
+    sum_ += value_ns * count;
+    max_ = std::max(max_, value_ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    total_count_ += other.total_count_;
+    sum_ += other.sum_;
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::addBuckets(const std::vector<std::pair<size_t, uint64_t>>& buckets,
+                                  uint64_t sum, uint64_t max) {
+    for (const auto& bucket : buckets) {
+        if (bucket.first < kBucketCount) {
+            counts_[bucket.first] += bucket.second;
+            total_count_ += bucket.second;
+        }
+    }
+    sum_ += sum;
+    max_ = std::max(max_, max);
+}
+
+void LatencyHistogram::subtract(const LatencyHistogram& earlier) {
+    size_t highest = 0;
+    total_count_ = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts_[i] -= std::min(counts_[i], earlier.counts_[i]);
+        total_count_ += counts_[i];
+        if (counts_[i] > 0) {
+            highest = i;
+        }
+    }
+    sum_ -= std::min(sum_, earlier.sum_);
+    // Точный максимум интервала неизвестен - берём границу старшей корзины
+    if (total_count_ == 0) {
+        max_ = 0;
+    } else if (max_ >= bucketUpper(highest)) {
+        max_ = bucketUpper(highest) - 1;
+    }
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_count_ = 0;
+    sum_ = 0;
+    max_ = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    if (total_count_ == 0) {
+        return 0;
+    }
+    if (percent >= 100.0) {
+        return max_;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percent / 100.0 * total_count_));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            // Наибольшее значение, неотличимое от попавших в корзину
+            return std::min(bucketUpper(i) - 1, max_);
+        }
+    }
+    return max_;
+}
+
+double LatencyHistogram::mean() const {
+    return total_count_ > 0 ? static_cast<double>(sum_) / total_count_ : 0.0;
+}
+
+void LatencyHistogram::exportCsv(std::ostream& out) const {
+    out << "lower_ns,upper_ns,count\n";
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        if (counts_[i] > 0) {
+            out << bucketLower(i) << ',' << bucketUpper(i) << ',' << counts_[i] << '\n';
+        }
+    }
+}
+
+HistogramRecorder::HistogramRecorder() :
+    counts_(new std::atomic<uint64_t>[LatencyHistogram::kBucketCount]) {
+    reset();
+}
+
+void HistogramRecorder::snapshotInto(LatencyHistogram& out) const {
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        uint64_t c = counts_[i].load(std::memory_order_relaxed);
+        out.counts_[i] += c;
+        out.total_count_ += c;
+    }
+    out.sum_ += sum_.load(std::memory_order_relaxed);
+    out.max_ = std::max(out.max_, max_.load(std::memory_order_relaxed));
+}
+
+void HistogramRecorder::reset() {
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
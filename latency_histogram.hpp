@@ -0,0 +1,124 @@
+/// @file latency_histogram.hpp
+/// @brief Логарифмические гистограммы задержек в стиле HdrHistogram
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/**
+ * @class LatencyHistogram
+ * @brief Гистограмма задержек в наносекундах с логарифмическими корзинами
+ *
+ * Каждая степень двойки делится на 128 линейных подкорзин, поэтому
+ * относительная погрешность значения не превышает 1%. Значения до 128 нс
+ * хранятся точно, максимум - около 73 минут, большие значения
+ * попадают в последнюю корзину. Не потокобезопасна: используется для
+ * слияния и анализа, запись из рабочих потоков идёт через HistogramRecorder.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 7;                        //< Бит на подкорзины
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBucketBits; //< Подкорзин на степень двойки
+    static constexpr int kMaxValueBits = 42;                        //< Значения меньше 2^42 нс
+    static constexpr size_t kBucketCount =
+        static_cast<size_t>(kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram();
+
+    /// @brief Индекс корзины для значения
+    static size_t bucketIndex(uint64_t value_ns);
+
+    /// @brief Нижняя граница корзины (включительно)
+    static uint64_t bucketLower(size_t index);
+
+    /// @brief Верхняя граница корзины (не включительно)
+    static uint64_t bucketUpper(size_t index);
+
+    /// @brief Добавляет одно значение
+    void record(uint64_t value_ns, uint64_t count = 1);
+
+    /// @brief Добавляет содержимое другой гистограммы
+    void merge(const LatencyHistogram& other);
+
+    /// @brief Добавляет выгруженные корзины другой гистограммы без потери точности
+    /// @param buckets Пары (индекс корзины, счётчик)
+    /// @param sum Точная сумма значений исходной гистограммы
+    /// @param max Точный максимум исходной гистограммы
+    void addBuckets(const std::vector<std::pair<size_t, uint64_t>>& buckets, uint64_t sum, uint64_t max);
+
+    /// @brief Вычитает более раннее состояние той же гистограммы (для интервалов)
+    void subtract(const LatencyHistogram& earlier);
+
+    /// @brief Обнуляет гистограмму
+    void reset();
+
+    /// @brief Значение заданного перцентиля (0..100), нс
+    uint64_t percentile(double percent) const;
+
+    uint64_t count() const { return total_count_; }
+    uint64_t max() const { return max_; }
+    uint64_t sum() const { return sum_; }
+    double mean() const;
+
+    /// @brief Счётчик корзины
+    uint64_t bucketCount(size_t index) const { return counts_[index]; }
+
+    /// @brief Выгружает непустые корзины в CSV: lower_ns,upper_ns,count
+    void exportCsv(std::ostream& out) const;
+
+private:
+    friend class HistogramRecorder;
+
+    std::vector<uint64_t> counts_;  //< Счётчики корзин
+    uint64_t total_count_ = 0;      //< Общее число значений
+    uint64_t sum_ = 0;              //< Сумма значений, нс
+    uint64_t max_ = 0;              //< Точный максимум, нс
+};
+
+/**
+ * @class HistogramRecorder
+ * @brief Гистограмма одного рабочего потока
+ *
+ * Пишет только поток-владелец: запись - это relaxed load + store в
+ * собственные счётчики, без RMW-операций и без разделяемых между
+ * потоками атомиков, т.е. wait-free. Поток отчётов в любой момент
+ * может снять копию через snapshotInto; копия согласована по отдельным
+ * счётчикам, чего достаточно для отчётов за интервал.
+ */
+class HistogramRecorder {
+public:
+    HistogramRecorder();
+
+    HistogramRecorder(const HistogramRecorder&) = delete;
+    HistogramRecorder& operator=(const HistogramRecorder&) = delete;
+
+    /// @brief Записывает значение (только поток-владелец)
+    void record(uint64_t value_ns) {
+        auto& bucket = counts_[LatencyHistogram::bucketIndex(value_ns)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) + value_ns, std::memory_order_relaxed);
+        if (value_ns > max_.load(std::memory_order_relaxed)) {
+            max_.store(value_ns, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Добавляет текущее состояние в гистограмму out
+    void snapshotInto(LatencyHistogram& out) const;
+
+    /// @brief Обнуляет счётчики (только когда поток-владелец не пишет)
+    void reset();
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;   //< Счётчики корзин
+    std::atomic<uint64_t> sum_{0};                      //< Сумма значений, нс
+    std::atomic<uint64_t> max_{0};                      //< Максимум, нс
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
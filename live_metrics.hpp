@@ -0,0 +1,106 @@
+/// @file live_metrics.hpp
+/// @brief Снимок метрик идущего теста и его публикация без блокировок
+
+#ifndef LIVE_METRICS_HPP
+#define LIVE_METRICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "request_phases.hpp"
+
+/**
+ * @struct MetricsSnapshot
+ * @brief Метрики теста на момент публикации
+ *
+ * Интервальные значения считаются по последней секунде,
+ * накопительные - с начала теста. Задержки в миллисекундах.
+ */
+struct MetricsSnapshot {
+    int64_t running = 0;                //< 1, пока тест идёт
+    double elapsed_seconds = 0;         //< Время с начала теста
+
+    int64_t requests_started = 0;       //< Отправлено запросов
+    int64_t requests_sent = 0;          //< Ответов с допустимым кодом HTTP
+    int64_t requests_failed = 0;        //< Неудачных запросов (всего)
+    int64_t success_responses = 0;      //< Ответов, прошедших проверки
+    int64_t error_responses = 0;        //< Ответов, не прошедших проверки
+    int64_t http_errors = 0;            //< Ответов с недопустимым кодом HTTP
+    int64_t transport_errors = 0;       //< Ошибок CURL (соединение, таймаут)
+    int64_t in_flight = 0;              //< Запросов в полёте
+
+    double interval_rps = 0;            //< Завершённых запросов в секунду за последнюю секунду
+    double cumulative_rps = 0;          //< Завершённых запросов в секунду с начала теста
+
+    double interval_p50_ms = 0;         //< Медиана задержки за последнюю секунду
+    double interval_p99_ms = 0;         //< p99 задержки за последнюю секунду
+    double mean_ms = 0;                 //< Средняя задержка с начала теста
+    double p50_ms = 0;
+    double p90_ms = 0;
+    double p99_ms = 0;
+    double p999_ms = 0;
+    double max_ms = 0;
+
+    double phase_p50_ms[kRequestPhaseCount] = {};  //< Медиана каждой фазы запроса за последнюю секунду
+    double phase_p99_ms[kRequestPhaseCount] = {};  //< p99 каждой фазы за последнюю секунду
+};
+
+/**
+ * @class SnapshotBuffer
+ * @brief Последний опубликованный снимок (seqlock)
+ *
+ * Писатель один - поток метрик. Читатели копируют снимок и повторяют
+ * чтение, если попали на публикацию; ни писатель, ни читатели не
+ * блокируются и не касаются данных рабочих потоков.
+ */
+class SnapshotBuffer {
+public:
+    static_assert(std::is_trivially_copyable<MetricsSnapshot>::value, "snapshot must be trivially copyable");
+    static_assert(sizeof(MetricsSnapshot) % sizeof(uint64_t) == 0, "snapshot must consist of 8-byte words");
+
+    /// @brief Публикует снимок (только поток метрик)
+    void publish(const MetricsSnapshot& snapshot) {
+        uint64_t words[kWords];
+        std::memcpy(words, &snapshot, sizeof(words));
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    /// @brief Читает последний снимок (из любого потока)
+    MetricsSnapshot read() const {
+        uint64_t words[kWords];
+        while (true) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        MetricsSnapshot snapshot;
+        std::memcpy(&snapshot, words, sizeof(words));
+        return snapshot;
+    }
+
+private:
+    static constexpr size_t kWords = sizeof(MetricsSnapshot) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence_{0};         //< Нечётное - идёт публикация
+    std::atomic<uint64_t> words_[kWords] = {};
+};
+
+#endif // LIVE_METRICS_HPP
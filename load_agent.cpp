@@ -0,0 +1,30 @@
+/// @file load_agent.cpp
+/// @brief Агент распределённого нагрузочного теста
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "distributed.hpp"
+
+int main(int argc, char** argv) {
+    int port = 17700;
+    bool once = false;
+    std::string bind_address = "127.0.0.1";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--bind") == 0 && i + 1 < argc) {
+            bind_address = argv[++i];
+        } else if (std::strcmp(argv[i], "--once") == 0) {
+            once = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--port PORT] [--bind ADDRESS] [--once]" << std::endl;
+            return 2;
+        }
+    }
+
+    LoadAgent agent;
+    return agent.serve(port, once, bind_address) ? 0 : 1;
+}
@@ -9,32 +9,46 @@
 #include <atomic>
 #include <chrono>
 #include <random>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <deque>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 
+#include "json_scan.hpp"
+
 using json = nlohmann::json;
 
+constexpr long kRequestTimeoutMs = 30000;   // Таймаут запроса, если тест не заканчивается раньше
+
+/// @brief Форматирует наносекунды как миллисекунды с точностью до микросекунды
+static std::string formatMs(uint64_t ns) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << ns / 1e6 << " ms";
+    return out.str();
+}
+
 LoadTester::LoadTester() : 
-    requests_sent(0), 
-    requests_failed(0), 
-    success_responses(0), 
-    error_responses(0), 
-    total_response_time(0),
     target_url(),
+    body_template(BodyTemplate::compile({})),
     response_checks() {
 }
 
 LoadTester::LoadTester(const std::string& url) : 
-    requests_sent(0), 
-    requests_failed(0), 
-    success_responses(0), 
-    error_responses(0), 
-    total_response_time(0),
     target_url(url),
-    gen(rd()),
+    body_template(BodyTemplate::compile({})),
     response_checks() {
 }
 
+LoadTester::~LoadTester() {
+    stopTest();
+}
+
 size_t LoadTester::writeCallback(void* contents, size_t size, size_t nmemb, std::string* response) {
     size_t total_size = size * nmemb;
     response->append((char*)contents, total_size);
@@ -43,244 +57,1917 @@ size_t LoadTester::writeCallback(void* contents, size_t size, size_t nmemb, std:
 
 void LoadTester::setTestDataConfig(const TestDataConfig& config) {
     data_config = config;
+    body_template_source.clear();
+    body_template = BodyTemplate::compile(data_config, data_pools);
 }
 
 void LoadTester::setField(const std::string& field_name, const std::string& value, bool is_random) {
-    data_config[field_name] = {value, is_random};
+    FieldConfig field;
+    field.value = value;
+    field.is_random = is_random;
+    data_config[field_name] = field;
+    body_template_source.clear();
+    body_template = BodyTemplate::compile(data_config, data_pools);
 }
 
-std::string LoadTester::generateFieldValue(const FieldConfig& config) {
-    if (config.is_random) {
-        std::uniform_int_distribution<> dis(config.min_val, config.max_val);
-        return std::to_string(dis(gen));
-    }
-    return config.value;
+void LoadTester::setBodyTemplate(const std::string& json_template) {
+    body_template = BodyTemplate::fromJson(json_template, data_pools);
+    body_template_source = json_template;
+    data_config.clear();
 }
 
-json LoadTester::generateTestData() {
-    json result;
-    
-    for (const auto& [field_name, config] : data_config) {
-        result[field_name] = generateFieldValue(config);
-    }
-    
-    return result;
+void LoadTester::addDataPool(const std::string& name, const std::string& csv_path) {
+    data_pools[name] = DataPool::load(csv_path);
 }
 
 void LoadTester::addResponseCheck(const std::string& field_path, const std::string& expected_value, bool check_exists) {
     response_checks.push_back({field_path, expected_value, check_exists});
+    response_matcher.setBodyChecks(response_checks);
 }
 
 void LoadTester::setResponseChecks(const std::vector<ResponseCheckConfig>& checks) {
     response_checks = checks;
+    response_matcher.setBodyChecks(response_checks);
 }
 
 void LoadTester::clearResponseChecks() {
-    if (!response_checks.empty()) {
-        response_checks.clear();
-    }
+    response_checks.clear();
+    response_matcher.setBodyChecks(response_checks);
+    response_matcher.clearAcceptedStatuses();
+    response_matcher.clearHeaderChecks();
+    response_matcher.setBodySizeLimits(0, 0);
 }
 
-bool LoadTester::checkResponseSuccess(const std::string& response_json) {
-    if (response_checks.empty()) {
-        // Без проверок считаем любой валидный JSON успешным
-        try {
-            json response_data = json::parse(response_json);
-            return true;
-        } catch (const std::exception& e) {
-            std::cerr << "Error parsing response: " << e.what() << std::endl;
+void LoadTester::addStatusCheck(long status) {
+    response_matcher.addAcceptedStatus(status);
+}
+
+void LoadTester::addHeaderCheck(const std::string& name, const std::string& expected_value) {
+    response_matcher.addHeaderCheck({name, expected_value});
+}
+
+void LoadTester::setBodySizeLimits(size_t min_bytes, size_t max_bytes) {
+    response_matcher.setBodySizeLimits(min_bytes, max_bytes);
+}
+
+bool LoadTester::checkResponseSuccess(const RequestSlot& slot) const {
+    const ResponseMatcher& matcher = scenarios[slot.scenario]->matcher;
+    if (!matcher.bodySizeAccepted(slot.response.size())) {
+        return false;
+    }
+
+    for (const auto& check : matcher.headerChecks()) {
+        struct curl_header* header = nullptr;
+        if (curl_easy_header(slot.curl, check.name.c_str(), 0, CURLH_HEADER, -1, &header) != CURLHE_OK) {
             return false;
         }
-    }
-    
-    try {
-        json response_data = json::parse(response_json);
-        
-        for (const auto& check : response_checks) {
-            // Простой парсинг пути (можно улучшить для вложенных полей)
-            if (!response_data.contains(check.field_path)) {
-                if (check.check_exists) {
-                    return false; // Поле должно существовать, но его нет
-                }
-                continue;
-            }
-            
-            // Если указано ожидаемое значение - проверяем его
-            if (!check.expected_value.empty()) {
-                std::string actual_value = response_data[check.field_path].dump();
-                if (actual_value != check.expected_value) {
-                    return false; // Значение не совпадает
-                }
-            }
+        if (!check.expected_value.empty() && check.expected_value != header->value) {
+            return false;
         }
-        
-        return true; // Все проверки пройдены
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error parsing response: " << e.what() << std::endl;
-        return false;
     }
+
+    return matcher.matchBody(slot.response.data(), slot.response.size());
 }
 
 void LoadTester::setTargetUrl(const std::string& url) {
     target_url = url;
 }
 
-bool LoadTester::sendRequest(int thread_id, int request_id) {
-    CURL* curl = curl_easy_init();
-    std::string response_string;
-    bool request_success = false;
-    
+RequestSlot::RequestSlot() : curl(curl_easy_init()) {
+}
+
+RequestSlot::~RequestSlot() {
     if (curl) {
-        auto start_time = std::chrono::steady_clock::now();
-        
-        try {
-            json request_data = generateTestData();
-            std::string post_data = request_data.dump();
-            
-            struct curl_slist* headers = nullptr;
-            headers = curl_slist_append(headers, "Content-Type: application/json");
-            headers = curl_slist_append(headers, "Accept: application/json");
-            
-            curl_easy_setopt(curl, CURLOPT_URL, target_url.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data.c_str());
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_string);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-            
-            CURLcode res = curl_easy_perform(curl);
-            auto end_time = std::chrono::steady_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-            total_response_time += duration.count();
-            
-            if (res == CURLE_OK) {
-                long response_code;
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-                
-                if (response_code == 200) {
-                    requests_sent++;
-                    request_success = true;
-                    
-                    if (checkResponseSuccess(response_string)) {
-                        success_responses++;
-                        if (request_id % 100 == 0) {
-                            std::cout << " -> Thread " << thread_id << " - Request " << request_id 
-                                      << " SUCCESS - Response time: " << duration.count() << "ms" << std::endl;
-                        }
-                    } else {
-                        error_responses++;
-                        std::cerr << "Thread " << thread_id << " - Request " << request_id 
-                                  << " FAILED: success field is false" << std::endl;
-                    }
-                } else {
-                    requests_failed++;
-                    std::cerr << "Thread " << thread_id << " - HTTP Error: " << response_code 
-                              << " - Response: " << response_string << std::endl;
-                }
-            } else {
-                requests_failed++;
-                std::cerr << "Thread " << thread_id << " - CURL Error: " << curl_easy_strerror(res) << std::endl;
+        curl_easy_cleanup(curl);
+    }
+}
+
+WorkerContext::WorkerContext(int id, int num_slots) : thread_id(id) {
+    for (int i = 0; i < num_slots; ++i) {
+        slots.push_back(std::make_unique<RequestSlot>());
+    }
+}
+
+WorkerContext::~WorkerContext() {
+    // Слоты должны быть отцеплены от мульти-хэндла до его уничтожения
+    if (multi) {
+        for (auto& slot : slots) {
+            if (slot->curl) {
+                curl_multi_remove_handle(multi, slot->curl);
             }
-            
-            curl_slist_free_all(headers);
-            
-        } catch (const std::exception& e) {
-            requests_failed++;
-            std::cerr << "Thread " << thread_id << " - Exception: " << e.what() << std::endl;
         }
-        
-        curl_easy_cleanup(curl);
+    }
+    slots.clear();
+    if (multi) {
+        curl_multi_cleanup(multi);
+    }
+    if (log) {
+        log->retire();
+    }
+}
+
+Scenario::~Scenario() {
+    if (headers) {
+        curl_slist_free_all(headers);
+    }
+}
+
+/// @brief Статистика сценария слота в контексте потока (nullptr, если не ведётся)
+static ScenarioStats* scenarioStats(WorkerContext& ctx, const RequestSlot& slot) {
+    if (slot.scenario < 0 || static_cast<size_t>(slot.scenario) >= ctx.scenario_stats.size()) {
+        return nullptr;
+    }
+    return ctx.scenario_stats[slot.scenario].get();
+}
+
+/// @brief Увеличивает счётчик потока и, если она ведётся, статистики сценария
+static void bumpRequestCounter(WorkerContext& ctx, ScenarioStats* stats,
+                               std::atomic<long> WorkerCounters::* counter, long delta = 1) {
+    bumpCounter(ctx.counters.*counter, delta);
+    if (stats) {
+        bumpCounter(stats->counters.*counter, delta);
+    }
+}
+
+bool LoadTester::setLogFile(const std::string& path) {
+    if (path.empty()) {
+        event_log.setConsoleSink();
+        return true;
+    }
+    return event_log.setFileSink(path);
+}
+
+void LoadTester::setLogCallback(LogCallback callback) {
+    event_log.setCallbackSink(std::move(callback));
+}
+
+void LoadTester::setLogRateLimit(int lines_per_second) {
+    event_log.setRateLimit(lines_per_second);
+}
+
+void LoadTester::setCpuAffinity(const std::vector<int>& worker_cpus, const std::vector<int>& reporter_cpus) {
+    affinity.worker_cpus = worker_cpus;
+    affinity.reporter_cpus = reporter_cpus;
+}
+
+void LoadTester::setWarmup(int seconds) {
+    warmup_seconds = std::max(0, seconds);
+}
+
+void LoadTester::setDrainTimeout(double seconds) {
+    drain_seconds = std::max(0.0, seconds);
+}
+
+void LoadTester::setKeepAlive(bool enabled) {
+    keep_alive = enabled;
+}
+
+void LoadTester::setSeed(uint64_t value) {
+    seed = value;
+    has_seed = true;
+}
+
+bool LoadTester::setEngineMode(EngineMode mode, int in_flight) {
+    // Рабочие потоки идущего теста читают модель и окно без синхронизации
+    if (test_active) {
+        return false;
+    }
+    engine_mode = mode;
+    max_in_flight = in_flight > 0 ? in_flight : 1;
+    return true;
+}
+
+void LoadTester::setProtocol(HttpProtocol value, int connections, int streams) {
+    protocol = value;
+    max_host_connections = std::max(0, connections);
+    max_streams = streams > 0 ? streams : 1;
+}
+
+void LoadTester::setRateProfile(const RateProfile& profile, ArrivalProcess process) {
+    rate_profile = profile;
+    arrival_process = process;
+}
+
+void LoadTester::setArrivalProcess(ArrivalProcess process) {
+    arrival_process = process;
+}
+
+void LoadTester::addRateSegment(const RateSegment& segment) {
+    rate_profile.addSegment(segment);
+}
+
+void LoadTester::clearRateProfile() {
+    rate_profile = RateProfile();
+}
+
+/// @brief Есть ли в списке заголовок с таким именем (без учёта регистра)
+static bool hasHeader(const std::vector<std::string>& headers, const std::string& name) {
+    for (const auto& header : headers) {
+        if (header.size() > name.size() && header[name.size()] == ':' &&
+            std::equal(name.begin(), name.end(), header.begin(),
+                       [](char a, char b) { return std::tolower(a) == std::tolower(b); })) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int LoadTester::addScenario(const ScenarioConfig& scenario) {
+    if (!std::isfinite(scenario.weight) || scenario.weight < 0) {
+        throw std::invalid_argument("scenario weight must be a non-negative number");
+    }
+    if (!scenario.body_template.empty()) {
+        // Шаблон проверяется сразу, чтобы ошибка не всплыла только при запуске теста
+        BodyTemplate::fromJson(scenario.body_template, data_pools);
+    }
+    scenario_configs.push_back(scenario);
+    return static_cast<int>(scenario_configs.size()) - 1;
+}
+
+ScenarioConfig& LoadTester::scenarioConfig(int index) {
+    return scenario_configs.at(index);
+}
+
+void LoadTester::clearScenarios() {
+    scenario_configs.clear();
+}
+
+void LoadTester::setReplayFile(const std::string& path, double speed, bool pacing, bool loop) {
+    auto source = std::make_unique<ReplaySource>();
+    source->open(path);
+    if (pacing && !source->hasTimestamps()) {
+        throw std::runtime_error("replay file " + path + " has no request timestamps for pacing");
+    }
+    source->setLooping(loop);
+    source->setPartition(replay_part, replay_parts);
+    replay = std::move(source);
+    replay_speed = speed > 0 ? speed : 1.0;
+    replay_pacing = pacing;
+}
+
+void LoadTester::clearReplay() {
+    replay.reset();
+}
+
+json LoadTester::exportPlan() const {
+    json plan;
+    plan["target_url"] = target_url;
+    if (!data_pools.empty()) {
+        json pools = json::object();
+        for (const auto& [name, pool] : data_pools) {
+            pools[name] = pool->path();
+        }
+        plan["data_pools"] = pools;
+    }
+    if (!body_template_source.empty()) {
+        plan["body_template"] = body_template_source;
     } else {
-        requests_failed++;
-        std::cerr << "Failed to initialize CURL" << std::endl;
+        json fields = json::object();
+        for (const auto& [name, field] : data_config) {
+            fields[name] = {{"value", field.value}, {"random", field.is_random},
+                            {"min", field.min_val}, {"max", field.max_val}};
+            if (!field.generator.empty()) {
+                fields[name]["generator"] = field.generator;
+            }
+        }
+        plan["fields"] = fields;
     }
-    
-    return request_success;
+
+    json checks = json::array();
+    for (const auto& check : response_checks) {
+        checks.push_back({{"path", check.field_path}, {"expected", check.expected_value},
+                          {"exists", check.check_exists}});
+    }
+    plan["checks"] = checks;
+    plan["statuses"] = response_matcher.acceptedStatuses();
+    json header_checks = json::array();
+    for (const auto& check : response_matcher.headerChecks()) {
+        header_checks.push_back({{"name", check.name}, {"value", check.expected_value}});
+    }
+    plan["header_checks"] = header_checks;
+    plan["body_size"] = {{"min", response_matcher.minBodySize()}, {"max", response_matcher.maxBodySize()}};
+
+    json scenarios_json = json::array();
+    for (const auto& config : scenario_configs) {
+        json scenario_checks = json::array();
+        for (const auto& check : config.checks) {
+            scenario_checks.push_back({{"path", check.field_path}, {"expected", check.expected_value},
+                                       {"exists", check.check_exists}});
+        }
+        scenarios_json.push_back({{"name", config.name}, {"url", config.url}, {"method", config.method},
+                                  {"headers", config.headers}, {"body_template", config.body_template},
+                                  {"checks", scenario_checks}, {"statuses", config.accepted_statuses},
+                                  {"weight", config.weight}});
+    }
+    plan["scenarios"] = scenarios_json;
+
+    plan["keep_alive"] = keep_alive;
+    plan["warmup"] = warmup_seconds;
+    plan["drain"] = drain_seconds;
+    plan["engine"] = engine_mode == EngineMode::Multi ? "multi" : "blocking";
+    plan["in_flight"] = max_in_flight;
+    plan["protocol"] = {{"version", protocol == HttpProtocol::Http1 ? "http1.1"
+                                    : protocol == HttpProtocol::Http2 ? "http2" : "h2c"},
+                        {"max_connections", max_host_connections}, {"max_streams", max_streams}};
+    if (affinity.enabled()) {
+        plan["affinity"] = {{"workers", formatCpuList(affinity.worker_cpus)},
+                            {"reporter", formatCpuList(affinity.reporter_cpus)}};
+    }
+    plan["arrival"] = arrival_process == ArrivalProcess::Poisson ? "poisson" : "uniform";
+    json profile = json::array();
+    for (const auto& segment : rate_profile.segments()) {
+        profile.push_back({{"duration", segment.duration_seconds}, {"start_rps", segment.start_rps},
+                           {"end_rps", segment.end_rps}});
+    }
+    plan["rate_profile"] = profile;
+    if (has_seed) {
+        plan["seed"] = seed;
+    }
+    if (agent_parts > 1) {
+        plan["agent"] = {{"part", agent_part}, {"parts", agent_parts}};
+    }
+    if (replay) {
+        plan["replay"] = {{"path", replay->path()}, {"speed", replay_speed}, {"pacing", replay_pacing},
+                          {"loop", replay->looping()}, {"part", replay_part}, {"parts", replay_parts}};
+    }
+    return plan;
 }
 
-void LoadTester::printTestHeader(int num_threads, int duration_seconds, int requests_per_second) const {
-    std::cout << "=== C++ Load Tester ===" << std::endl;
-    std::cout << "Target: " << target_url << std::endl;
-    std::cout << "Threads: " << num_threads << std::endl;
-    std::cout << "Duration: " << duration_seconds << " seconds" << std::endl;
-    std::cout << "Target RPS: " << (requests_per_second > 0 ? std::to_string(requests_per_second) : "MAX") << std::endl;
-    std::cout << "========================\n" << std::endl;
+/// @brief Проверки полей из массива плана
+static std::vector<ResponseCheckConfig> checksFromPlan(const json& checks) {
+    std::vector<ResponseCheckConfig> result;
+    for (const auto& check : checks) {
+        result.push_back({check.at("path").get<std::string>(), check.value("expected", std::string()),
+                          check.value("exists", true)});
+    }
+    return result;
 }
 
-void LoadTester::runTest(int num_threads, int duration_seconds, int requests_per_second) {
-    // Выводим шапку с настройками теста
-    printTestHeader(num_threads, duration_seconds, requests_per_second);
+void LoadTester::applyPlan(const json& plan) {
+    if (plan.contains("target_url")) {
+        setTargetUrl(plan["target_url"].get<std::string>());
+    }
+    // Таблицы загружаются раньше шаблонов, которые на них ссылаются
+    if (plan.contains("data_pools")) {
+        for (const auto& [name, path] : plan["data_pools"].items()) {
+            addDataPool(name, path.get<std::string>());
+        }
+    }
+    if (plan.contains("body_template")) {
+        setBodyTemplate(plan["body_template"].get<std::string>());
+    } else if (plan.contains("fields")) {
+        TestDataConfig config;
+        for (const auto& [name, field] : plan["fields"].items()) {
+            FieldConfig& target = config[name];
+            target.value = field.value("value", std::string());
+            target.is_random = field.value("random", false);
+            target.min_val = field.value("min", 0);
+            target.max_val = field.value("max", 9999);
+            target.generator = field.value("generator", std::string());
+        }
+        setTestDataConfig(config);
+    }
 
-    std::vector<std::thread> threads;
-    auto start_time = std::chrono::steady_clock::now();
-    std::atomic<int> global_request_id{0};
-    
-    std::cout << "Starting load test with " << num_threads << " threads for " 
-              << duration_seconds << " seconds" << std::endl;
-    
-    for (int i = 0; i < num_threads; ++i) {
-        threads.emplace_back([this, i, start_time, duration_seconds, requests_per_second, &global_request_id, num_threads]() {
-            while (std::chrono::steady_clock::now() - start_time < 
-                  std::chrono::seconds(duration_seconds)) {
-                
-                int request_id = global_request_id++;
-                this->sendRequest(i, request_id);
-                
-                if (requests_per_second > 0 && num_threads > 0) {
-                    int rps_per_thread = requests_per_second / num_threads;
-                    if (rps_per_thread > 0) {
-                        int delay_ms = 1000 / rps_per_thread;
-                        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
-                    }
-                }
+    if (plan.contains("checks")) {
+        setResponseChecks(checksFromPlan(plan["checks"]));
+    }
+    if (plan.contains("statuses")) {
+        response_matcher.clearAcceptedStatuses();
+        for (long status : plan["statuses"].get<std::vector<long>>()) {
+            addStatusCheck(status);
+        }
+    }
+    if (plan.contains("header_checks")) {
+        response_matcher.clearHeaderChecks();
+        for (const auto& check : plan["header_checks"]) {
+            addHeaderCheck(check.at("name").get<std::string>(), check.value("value", std::string()));
+        }
+    }
+    if (plan.contains("body_size")) {
+        setBodySizeLimits(plan["body_size"].value("min", size_t{0}), plan["body_size"].value("max", size_t{0}));
+    }
+
+    if (plan.contains("scenarios")) {
+        clearScenarios();
+        for (const auto& item : plan["scenarios"]) {
+            ScenarioConfig config;
+            config.name = item.value("name", std::string());
+            config.url = item.value("url", std::string());
+            config.method = item.value("method", std::string("POST"));
+            config.headers = item.value("headers", std::vector<std::string>());
+            config.body_template = item.value("body_template", std::string());
+            if (item.contains("checks")) {
+                config.checks = checksFromPlan(item["checks"]);
             }
-        });
+            config.accepted_statuses = item.value("statuses", std::vector<long>());
+            config.weight = item.value("weight", 1.0);
+            addScenario(config);
+        }
     }
-    
-    auto progress_thread = std::thread([this, start_time, duration_seconds]() {
-        while (std::chrono::steady_clock::now() - start_time < 
-              std::chrono::seconds(duration_seconds)) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                std::chrono::steady_clock::now() - start_time);
-            int progress = (elapsed.count() * 100) / duration_seconds;
-            
-            std::cout << "\rProgress: " << progress << "% | "
-                      << "Requests: " << requests_sent << " | "
-                      << "Success: " << success_responses << " | "
-                      << "Errors: " << error_responses;
-            std::cout.flush();
-            
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    if (plan.contains("keep_alive")) {
+        setKeepAlive(plan["keep_alive"].get<bool>());
+    }
+    if (plan.contains("warmup")) {
+        setWarmup(plan["warmup"].get<int>());
+    }
+    if (plan.contains("drain")) {
+        setDrainTimeout(plan["drain"].get<double>());
+    }
+    if (plan.contains("engine")) {
+        if (!setEngineMode(plan["engine"].get<std::string>() == "multi" ? EngineMode::Multi : EngineMode::Blocking,
+                           plan.value("in_flight", max_in_flight))) {
+            throw std::runtime_error("cannot change the engine while a test is running");
         }
-    });
-    
-    for (auto& thread : threads) {
-        thread.join();
     }
-    
-    progress_thread.join();
-    
-    printResults();
+    if (plan.contains("protocol")) {
+        const json& item = plan["protocol"];
+        const std::string version = item.value("version", std::string("http1.1"));
+        HttpProtocol value = HttpProtocol::Http1;
+        if (version == "http2") {
+            value = HttpProtocol::Http2;
+        } else if (version == "h2c") {
+            value = HttpProtocol::Http2PriorKnowledge;
+        } else if (version != "http1.1") {
+            throw std::invalid_argument("Unknown protocol: " + version);
+        }
+        setProtocol(value, item.value("max_connections", 0), item.value("max_streams", 100));
+    }
+    if (plan.contains("affinity")) {
+        const json& item = plan["affinity"];
+        std::vector<int> worker_cpus;
+        std::vector<int> reporter_cpus;
+        if (!parseCpuList(item.value("workers", std::string()), worker_cpus) ||
+            !parseCpuList(item.value("reporter", std::string()), reporter_cpus)) {
+            throw std::invalid_argument("Invalid CPU list in affinity");
+        }
+        setCpuAffinity(worker_cpus, reporter_cpus);
+    }
+    if (plan.contains("arrival")) {
+        setArrivalProcess(plan["arrival"].get<std::string>() == "poisson"
+                          ? ArrivalProcess::Poisson : ArrivalProcess::Uniform);
+    }
+    if (plan.contains("rate_profile")) {
+        clearRateProfile();
+        for (const auto& item : plan["rate_profile"]) {
+            addRateSegment({item.at("duration").get<double>(), item.at("start_rps").get<double>(),
+                            item.at("end_rps").get<double>()});
+        }
+    }
+    if (plan.contains("seed")) {
+        setSeed(plan["seed"].get<uint64_t>());
+    }
+    if (plan.contains("agent")) {
+        agent_parts = std::max<size_t>(1, plan["agent"].value("parts", size_t{1}));
+        agent_part = std::min(plan["agent"].value("part", size_t{0}), agent_parts - 1);
+    }
+    if (plan.contains("replay")) {
+        const json& item = plan["replay"];
+        replay_part = item.value("part", size_t{0});
+        replay_parts = item.value("parts", size_t{1});
+        setReplayFile(item.at("path").get<std::string>(), item.value("speed", 1.0),
+                      item.value("pacing", true), item.value("loop", false));
+    }
 }
 
-void LoadTester::printResults() {
-    std::cout << "\n\n=== Load Test Results ===" << std::endl;
-    std::cout << "Total requests sent: " << requests_sent << std::endl;
-    std::cout << "Successful responses: " << success_responses << std::endl;
-    std::cout << "Error responses: " << error_responses << std::endl;
-    std::cout << "Failed requests: " << requests_failed << std::endl;
-    
-    if (requests_sent > 0) {
-        double success_rate = (success_responses * 100.0) / requests_sent;
-        double error_rate = (error_responses * 100.0) / requests_sent;
-        double avg_response_time = static_cast<double>(total_response_time) / requests_sent;
-        double rps = requests_sent / (static_cast<double>(total_response_time) / 1000.0);
-        
-        std::cout << "Success rate: " << success_rate << "%" << std::endl;
-        std::cout << "Error rate: " << error_rate << "%" << std::endl;
-        std::cout << "Average response time: " << avg_response_time << " ms" << std::endl;
-        std::cout << "Requests per second: " << rps << std::endl;
+void LoadTester::buildScenarios() {
+    scenarios.clear();
+
+    if (scenario_configs.empty() || replay) {
+        // Смесь из одного запроса: target_url, тело из конфигурации полей, общие проверки.
+        // При воспроизведении URL, метод и тело подменяются записью
+        auto scenario = std::make_unique<Scenario>();
+        scenario->name = replay ? "replay" : "default";
+        scenario->url = target_url;
+        scenario->method = "POST";
+        scenario->headers = curl_slist_append(nullptr, "Content-Type: application/json");
+        scenario->headers = curl_slist_append(scenario->headers, "Accept: application/json");
+        scenario->body = body_template;
+        scenario->matcher = response_matcher;
+        scenarios.push_back(std::move(scenario));
+    }
+
+    for (const auto& config : scenario_configs) {
+        if (replay) {
+            break;
+        }
+        auto scenario = std::make_unique<Scenario>();
+        scenario->name = config.name.empty() ? config.method + " " + config.url : config.name;
+        scenario->url = config.url.empty() ? target_url : config.url;
+        scenario->method = config.method;
+        std::transform(scenario->method.begin(), scenario->method.end(), scenario->method.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        scenario->sends_body = scenario->method != "GET" && scenario->method != "HEAD";
+        scenario->weight = config.weight;
+
+        if (scenario->sends_body && !hasHeader(config.headers, "content-type")) {
+            scenario->headers = curl_slist_append(scenario->headers, "Content-Type: application/json");
+        }
+        if (!hasHeader(config.headers, "accept")) {
+            scenario->headers = curl_slist_append(scenario->headers, "Accept: application/json");
+        }
+        for (const auto& header : config.headers) {
+            scenario->headers = curl_slist_append(scenario->headers, header.c_str());
+        }
+
+        if (!config.body_template.empty()) {
+            scenario->body = BodyTemplate::fromJson(config.body_template, data_pools);
+        }
+        scenario->matcher.setBodyChecks(config.checks);
+        for (long status : config.accepted_statuses) {
+            scenario->matcher.addAcceptedStatus(status);
+        }
+        scenarios.push_back(std::move(scenario));
+    }
+
+    std::vector<double> weights;
+    for (const auto& scenario : scenarios) {
+        weights.push_back(scenario->weight);
+    }
+    scenario_sampler.build(weights);
+}
+
+void LoadTester::applyScenario(RequestSlot& slot, const Scenario& scenario) {
+    CURL* curl = slot.curl;
+    curl_easy_setopt(curl, CURLOPT_URL, scenario.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, scenario.headers);
+    applyMethod(curl, scenario.method);
+}
+
+void LoadTester::applyMethod(CURL* curl, const std::string& method) {
+    curl_easy_setopt(curl, CURLOPT_NOBODY, method == "HEAD" ? 1L : 0L);
+
+    if (method == "GET" || method == "HEAD") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, nullptr);
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+        return;
+    }
+
+    // Тело передаётся через POSTFIELDS, другие методы - поверх POST
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method == "POST" ? nullptr : method.c_str());
+}
+
+/// @brief Читает отметки времени CURL завершённого запроса и переводит их в фазы
+/// @details Фазы установки соединения берутся, только если запрос открыл соединение:
+/// у переиспользованного соединения отметки DNS/TCP/TLS нулевые
+static void readPhaseTimes(CURL* curl, bool new_connection, PhaseTimes& times) {
+    curl_off_t namelookup = 0, connect = 0, appconnect = 0, pretransfer = 0, starttransfer = 0, total = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &namelookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appconnect);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &starttransfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+
+    if (new_connection) {
+        times.set(RequestPhase::Dns, 0, namelookup);
+        times.set(RequestPhase::Connect, namelookup, connect);
+        if (appconnect > 0) {
+            times.set(RequestPhase::Tls, connect, appconnect);
+        }
+    }
+    times.set(RequestPhase::Ttfb, pretransfer, starttransfer);
+    times.set(RequestPhase::Transfer, starttransfer, total);
+}
+
+/// @brief Передаёт итог запроса в кольцо трассы потока
+static void traceRequest(WorkerContext& ctx, const RequestSlot& slot, TraceOutcome outcome,
+                         std::chrono::steady_clock::time_point end_time, long status, int error,
+                         bool new_connection) {
+    auto ns = [](std::chrono::steady_clock::time_point time) {
+        return static_cast<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    };
+    curl_off_t received = 0;
+    curl_off_t sent = 0;
+    curl_easy_getinfo(slot.curl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+    curl_easy_getinfo(slot.curl, CURLINFO_SIZE_UPLOAD_T, &sent);
+
+    TraceRecord record;
+    record.scheduled_ns = ns(slot.intended_time);
+    record.start_ns = ns(slot.start_time);
+    record.end_ns = ns(end_time);
+    record.bytes_received = static_cast<uint32_t>(std::min<curl_off_t>(received, UINT32_MAX));
+    record.bytes_sent = static_cast<uint32_t>(std::min<curl_off_t>(sent, UINT32_MAX));
+    record.status = static_cast<int32_t>(status);
+    record.error = error;
+    record.thread_id = static_cast<uint16_t>(ctx.thread_id);
+    record.scenario = static_cast<uint16_t>(std::max(slot.scenario, 0));
+    record.outcome = outcome;
+    record.flags = new_connection ? kTraceNewConnection : 0;
+    ctx.trace->push(record);
+}
+
+/// @brief Callback прогресса CURL: прерывает блокирующий запрос по остановке теста
+/// @details curl_easy_perform не возвращает управление до конца запроса, и
+/// флаг остановки виден только отсюда. CURL вызывает его не реже раза в секунду
+static int stopProgressCallback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    return static_cast<const std::atomic<bool>*>(clientp)->load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+void LoadTester::prepareWorker(WorkerContext& ctx) const {
+    // Последовательности потоков чередуются так же, как номера запросов; в распределённом
+    // тесте потоки агента занимают свою долю общего чередования
+    const uint64_t threads = static_cast<uint64_t>(ctx.request_id_step);
+    const uint64_t thread_index = agent_part * threads + static_cast<uint64_t>(ctx.thread_id % ctx.request_id_step);
+    ctx.generators.resize(scenarios.size());
+    for (size_t s = 0; s < scenarios.size(); ++s) {
+        scenarios[s]->body.initState(ctx.generators[s], thread_index, agent_parts * threads);
+    }
+
+    for (auto& slot : ctx.slots) {
+        CURL* curl = slot->curl;
+        if (!curl) {
+            continue;
+        }
+
+        // URL, метод и заголовки зависят от сценария и ставятся в beginRequest
+        slot->scenario = -1;
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &slot->response);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, slot.get());
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 600L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, stopProgressCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &stop_requested);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+
+        if (keep_alive) {
+            curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 0L);
+            curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 0L);
+        } else {
+            // Сценарий "новое соединение на каждый запрос"
+            curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
+            curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+        }
+
+        switch (protocol) {
+        case HttpProtocol::Http1:
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_1_1));
+            curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 0L);
+            break;
+        case HttpProtocol::Http2:
+        case HttpProtocol::Http2PriorKnowledge:
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(
+                protocol == HttpProtocol::Http2 ? CURL_HTTP_VERSION_2_0 : CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE));
+            // Ждать потока в уже открытом соединении, а не открывать новое
+            curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+            break;
+        }
+    }
+}
+
+void LoadTester::beginRequest(WorkerContext& ctx, RequestSlot& slot, int request_id,
+                              std::chrono::steady_clock::time_point intended_time,
+                              const ReplayRecord* record) {
+    const size_t index = scenario_sampler.sample(ctx.rng);
+    const Scenario& scenario = *scenarios[index];
+    // Хэндл перенастраивается только при смене сценария: CURLOPT_URL копирует строку
+    if (slot.scenario != static_cast<int>(index)) {
+        applyScenario(slot, scenario);
+        slot.scenario = static_cast<int>(index);
+    }
+
+    bumpRequestCounter(ctx, scenarioStats(ctx, slot), &WorkerCounters::requests_started);
+    slot.request_id = request_id;
+    slot.response.clear();
+
+    if (record) {
+        // URL и метод копируются в слот: CURL нужны строки с завершающим нулём
+        if (record->url_size > 0) {
+            if (record->url_escaped) {
+                unescapeJsonString(record->url, record->url_size, slot.url);
+            } else {
+                slot.url.assign(record->url, record->url_size);
+            }
+        } else {
+            slot.url = scenario.url;
+        }
+        if (record->method_size > 0) {
+            slot.method.assign(record->method, record->method_size);
+        } else {
+            slot.method = record->body ? "POST" : "GET";
+        }
+        curl_easy_setopt(slot.curl, CURLOPT_URL, slot.url.c_str());
+        applyMethod(slot.curl, slot.method);
+
+        // Тело без escape-последовательностей уходит прямо из отображения файла
+        const char* body = record->body ? record->body : "";
+        size_t body_size = record->body_size;
+        if (record->body_escaped) {
+            unescapeJsonString(record->body, record->body_size, slot.post_data);
+            body = slot.post_data.data();
+            body_size = slot.post_data.size();
+        }
+        curl_easy_setopt(slot.curl, CURLOPT_POSTFIELDS, body);
+        curl_easy_setopt(slot.curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(body_size));
+    } else if (scenario.sends_body) {
+        scenario.body.render(slot.post_data, ctx.rng, ctx.generators[index]);
+        curl_easy_setopt(slot.curl, CURLOPT_POSTFIELDS, slot.post_data.c_str());
+        curl_easy_setopt(slot.curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(slot.post_data.size()));
+    }
+
+    slot.start_time = std::chrono::steady_clock::now();
+    // Запрос не переживает жёсткую остановку теста: таймаут урезается до неё
+    long timeout_ms = kRequestTimeoutMs;
+    slot.timeout_capped = false;
+    if (hard_stop != std::chrono::steady_clock::time_point{}) {
+        const long left = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            hard_stop - slot.start_time).count());
+        if (left < timeout_ms) {
+            timeout_ms = std::max(1L, left);
+            slot.timeout_capped = true;
+        }
+    }
+    curl_easy_setopt(slot.curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+    // Без планировщика задержка считается от фактической отправки
+    slot.intended_time = intended_time == std::chrono::steady_clock::time_point{}
+        ? slot.start_time : intended_time;
+}
+
+bool LoadTester::finishRequest(WorkerContext& ctx, RequestSlot& slot, int res) {
+    const int request_id = slot.request_id;
+    bool request_success = false;
+
+    // Прерванный остановкой запрос - не ошибка сервера: в задержки и ошибки не идёт
+    if (res == CURLE_ABORTED_BY_CALLBACK || (res == CURLE_OPERATION_TIMEDOUT && slot.timeout_capped)) {
+        bumpRequestCounter(ctx, scenarioStats(ctx, slot), &WorkerCounters::requests_cancelled);
+        if (ctx.trace) {
+            traceRequest(ctx, slot, TraceOutcome::Cancelled, std::chrono::steady_clock::now(), 0, res, false);
+        }
+        return false;
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    // Задержка от запланированного момента учитывает ожидание в очереди генератора
+    auto latency = end_time - slot.intended_time;
+    auto latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    ctx.latency.record(static_cast<uint64_t>(latency_ns));
+    ScenarioStats* stats = scenarioStats(ctx, slot);
+    if (stats) {
+        stats->latency.record(static_cast<uint64_t>(latency_ns));
+    }
+
+    // Запись журнала заполняется здесь, а в текст её превращает поток журнала
+    LogRecord record;
+    record.time_ns = static_cast<uint64_t>(end_time.time_since_epoch().count());
+    record.thread_id = ctx.thread_id;
+    record.request_id = request_id;
+    record.latency_us = static_cast<uint32_t>(latency_ns / 1000);
+    
+    long num_connects = 0;
+    curl_easy_getinfo(slot.curl, CURLINFO_NUM_CONNECTS, &num_connects);
+    bumpCounter(ctx.counters.connections_opened, num_connects);
+    
+    TraceOutcome outcome = TraceOutcome::TransportError;
+    long response_code = 0;
+    if (res == CURLE_OK) {
+        if (num_connects == 0) {
+            bumpCounter(ctx.counters.connections_reused);
+        }
+        PhaseTimes phase_times;
+        readPhaseTimes(slot.curl, num_connects > 0, phase_times);
+        ctx.phases.record(phase_times);
+        long http_version = 0;
+        curl_easy_getinfo(slot.curl, CURLINFO_HTTP_VERSION, &http_version);
+        if (http_version == CURL_HTTP_VERSION_2_0) {
+            bumpCounter(ctx.counters.http2_streams);
+        }
+        
+        curl_easy_getinfo(slot.curl, CURLINFO_RESPONSE_CODE, &response_code);
+        
+        if (scenarios[slot.scenario]->matcher.statusAccepted(response_code)) {
+            bumpRequestCounter(ctx, stats, &WorkerCounters::requests_sent);
+            request_success = true;
+            
+            if (checkResponseSuccess(slot)) {
+                outcome = TraceOutcome::Success;
+                bumpRequestCounter(ctx, stats, &WorkerCounters::success_responses);
+                if (request_id % 100 == 0) {
+                    record.kind = LogEventKind::Success;
+                    ctx.logEvent(record);
+                }
+            } else {
+                outcome = TraceOutcome::CheckFailed;
+                bumpRequestCounter(ctx, stats, &WorkerCounters::error_responses);
+                record.kind = LogEventKind::CheckFailed;
+                ctx.logEvent(record);
+            }
+        } else {
+            outcome = TraceOutcome::HttpError;
+            bumpRequestCounter(ctx, stats, &WorkerCounters::requests_failed);
+            bumpRequestCounter(ctx, stats, &WorkerCounters::http_errors);
+            record.kind = LogEventKind::HttpError;
+            record.code = static_cast<int32_t>(response_code);
+            record.setDetail(slot.response.data(), slot.response.size());
+            ctx.logEvent(record);
+        }
+    } else {
+        bumpRequestCounter(ctx, stats, &WorkerCounters::requests_failed);
+        bumpRequestCounter(ctx, stats, &WorkerCounters::transport_errors);
+        record.kind = LogEventKind::TransportError;
+        record.code = res;
+        record.text = curl_easy_strerror(static_cast<CURLcode>(res));
+        ctx.logEvent(record);
+    }
+
+    if (ctx.trace) {
+        traceRequest(ctx, slot, outcome, end_time, response_code, res, num_connects > 0);
+    }
+    return request_success;
+}
+
+bool LoadTester::sendRequest(int thread_id, int request_id) {
+    bool result;
+    {
+        // Запрос держит сценарии до конца: тест, начатый в другом потоке, соберёт их заново
+        // только после него
+        std::lock_guard<std::mutex> lock(scenarios_mutex);
+        WorkerContext ctx(thread_id);
+        ctx.rng.reseed(std::random_device{}());
+        ctx.log = event_log.attach();
+        // Во время теста сценарии уже собраны и используются рабочими потоками
+        if (!test_active) {
+            try {
+                buildScenarios();
+            } catch (const std::exception& e) {
+                std::cerr << "Invalid scenarios: " << e.what() << std::endl;
+                return false;
+            }
+        }
+        prepareWorker(ctx);
+        result = sendRequest(ctx, request_id);
+
+        // Одиночные запросы редки - сливаем их счётчики в общий шард атомарно
+        CounterTotals totals;
+        totals.add(ctx.counters);
+        standalone_counters.accumulate(totals);
+    }
+    // Вне runTest фоновый поток журнала не запущен - выводим событие сразу
+    event_log.flush();
+    return result;
+}
+
+/// @brief Передаёт исключение на пути запроса в журнал
+static void logException(WorkerContext& ctx, int request_id, const std::exception& e) {
+    LogRecord record;
+    record.time_ns = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    record.kind = LogEventKind::Exception;
+    record.thread_id = ctx.thread_id;
+    record.request_id = request_id;
+    record.setDetail(e.what(), std::strlen(e.what()));
+    ctx.logEvent(record);
+}
+
+bool LoadTester::sendRequest(WorkerContext& ctx, int request_id,
+                             std::chrono::steady_clock::time_point intended_time,
+                             const ReplayRecord* record) {
+    RequestSlot* slot = ctx.slots.empty() ? nullptr : ctx.slots.front().get();
+    
+    if (slot && slot->curl) {
+        try {
+            beginRequest(ctx, *slot, request_id, intended_time, record);
+            CURLcode res = curl_easy_perform(slot->curl);
+            return finishRequest(ctx, *slot, res);
+        } catch (const std::exception& e) {
+            bumpRequestCounter(ctx, scenarioStats(ctx, *slot), &WorkerCounters::requests_failed);
+            logException(ctx, request_id, e);
+        }
+    } else {
+        bumpCounter(ctx.counters.requests_started);
+        bumpCounter(ctx.counters.requests_failed);
+        std::cerr << "Failed to initialize CURL" << std::endl;
+    }
+    
+    return false;
+}
+
+bool LoadTester::nextArrival(WorkerContext& ctx, ArrivalScheduler* scheduler,
+                             std::chrono::steady_clock::time_point start_time,
+                             ReplayRecord& record, std::chrono::steady_clock::time_point& intended) {
+    intended = {};
+    if (replay) {
+        if (!replay->next(record)) {
+            return false;
+        }
+        if (replay_pacing) {
+            intended = start_time + std::chrono::nanoseconds(
+                static_cast<int64_t>(record.offset_ns / replay_speed));
+            return true;
+        }
+    }
+    return !scheduler || scheduler->next(ctx.rng, intended);
+}
+
+/// @brief Ждёт запланированного момента, но просыпается по запросу остановки
+/// @details В записи бывают паузы в минуты - остановка не должна их дожидаться
+static bool waitUntilOrStop(std::chrono::steady_clock::time_point deadline, const std::atomic<bool>& stop) {
+    constexpr auto kStopCheck = std::chrono::milliseconds(100);
+    while (deadline - std::chrono::steady_clock::now() > kStopCheck) {
+        if (stop.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        std::this_thread::sleep_for(kStopCheck);
+    }
+    ArrivalScheduler::waitUntil(deadline);
+    return !stop.load(std::memory_order_relaxed);
+}
+
+void LoadTester::runEventLoop(WorkerContext& ctx, std::chrono::steady_clock::time_point start_time,
+                              int duration_seconds, ArrivalScheduler* scheduler) {
+    using Clock = std::chrono::steady_clock;
+
+    // Мульти-хэндл переживает ступени поиска: в нём живёт пул соединений
+    if (!ctx.multi) {
+        ctx.multi = curl_multi_init();
+    }
+    if (!ctx.multi) {
+        std::cerr << "Thread " << ctx.thread_id << " - Failed to initialize CURL multi" << std::endl;
+        return;
+    }
+    curl_multi_setopt(ctx.multi, CURLMOPT_MAXCONNECTS, static_cast<long>(ctx.slots.size()));
+    curl_multi_setopt(ctx.multi, CURLMOPT_PIPELINING,
+                      protocol == HttpProtocol::Http1 ? CURLPIPE_NOTHING : CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(ctx.multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(max_host_connections));
+    curl_multi_setopt(ctx.multi, CURLMOPT_MAX_CONCURRENT_STREAMS, static_cast<long>(max_streams));
+
+    std::vector<RequestSlot*> idle;
+    for (auto& slot : ctx.slots) {
+        if (slot->curl) {
+            idle.push_back(slot.get());
+        }
+    }
+    const size_t total_slots = idle.size();
+
+    const auto deadline = start_time + std::chrono::seconds(duration_seconds);
+    Clock::time_point pending{};    // Следующий запланированный момент, уже взятый у планировщика
+    ReplayRecord pending_record;    // Записанный запрос для этого момента (воспроизведение)
+    bool has_pending = false;
+    bool exhausted = false;         // Планировщик больше не выдаст моментов до конца теста
+
+    while (true) {
+        auto now = Clock::now();
+        const bool stopping = stop_requested.load(std::memory_order_relaxed);
+        const bool active = now < deadline && !exhausted && !stopping;
+
+        // Пополняем окно запросов в полёте
+        while (active && !idle.empty()) {
+            if (!has_pending) {
+                if (!nextArrival(ctx, scheduler, start_time, pending_record, pending) ||
+                    (pending != Clock::time_point{} && pending >= deadline)) {
+                    exhausted = true;
+                    break;
+                }
+                has_pending = true;
+            }
+            // Пустой момент (закрытый цикл) всегда в прошлом
+            if (pending > now) {
+                break;
+            }
+            has_pending = false;
+
+            RequestSlot* slot = idle.back();
+            idle.pop_back();
+            try {
+                beginRequest(ctx, *slot, ctx.takeRequestId(), pending, replay ? &pending_record : nullptr);
+            } catch (const std::exception& e) {
+                bumpRequestCounter(ctx, scenarioStats(ctx, *slot), &WorkerCounters::requests_failed);
+                logException(ctx, slot->request_id, e);
+                idle.push_back(slot);
+                break;
+            }
+            curl_multi_add_handle(ctx.multi, slot->curl);
+            slot->active = true;
+        }
+
+        int running = 0;
+        curl_multi_perform(ctx.multi, &running);
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(ctx.multi, &queued)) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+            RequestSlot* slot = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &slot);
+            CURLcode res = msg->data.result;
+            curl_multi_remove_handle(ctx.multi, msg->easy_handle);
+            slot->active = false;
+            finishRequest(ctx, *slot, res);
+            idle.push_back(slot);
+        }
+
+        // Остановка или конец времени на завершение: запросы в полёте снимаются сразу
+        if (idle.size() != total_slots && (stopping || Clock::now() >= hard_stop)) {
+            for (auto& slot : ctx.slots) {
+                if (slot->active) {
+                    curl_multi_remove_handle(ctx.multi, slot->curl);
+                    slot->active = false;
+                    bumpRequestCounter(ctx, scenarioStats(ctx, *slot), &WorkerCounters::requests_cancelled);
+                    if (ctx.trace) {
+                        traceRequest(ctx, *slot, TraceOutcome::Cancelled, Clock::now(), 0, 0, false);
+                    }
+                    idle.push_back(slot.get());
+                }
+            }
+        }
+
+        if ((exhausted || stopping || Clock::now() >= deadline) && idle.size() == total_slots) {
+            break;
+        }
+
+        // Ждём сетевых событий, но не дольше следующего запланированного момента.
+        // Меньше миллисекунды curl_multi_poll не умеет - дожидаемся опросом
+        int timeout_ms = 100;
+        if (!has_pending && !idle.empty() && !exhausted && !stopping && Clock::now() < deadline) {
+            // Освободившийся слот ждёт нового момента прибытия - не спим
+            timeout_ms = 0;
+        } else if (has_pending && !idle.empty()) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                pending - Clock::now()).count();
+            timeout_ms = static_cast<int>(std::max<long long>(0, std::min<long long>(wait, timeout_ms)));
+        }
+        curl_multi_poll(ctx.multi, nullptr, 0, timeout_ms, nullptr);
+    }
+}
+
+void LoadTester::printTestHeader(int num_threads, int duration_seconds, int requests_per_second) const {
+    std::cout << "=== C++ Load Tester ===" << std::endl;
+    if (scenario_configs.empty()) {
+        std::cout << "Target: " << target_url << std::endl;
+    } else {
+        double total_weight = 0;
+        for (const auto& scenario : scenarios) {
+            total_weight += scenario->weight;
+        }
+        std::cout << "Scenarios:" << std::endl;
+        for (const auto& scenario : scenarios) {
+            std::cout << "  " << scenario->name << ": " << scenario->method << " " << scenario->url
+                      << " (" << std::setprecision(3) << scenario->weight * 100 / total_weight << "%)" << std::endl;
+        }
+        std::cout << std::setprecision(6);
+    }
+    if (replay) {
+        std::cout << "Replay: " << replay->path() << " (" << replay->size() << " requests";
+        if (replay->hasTimestamps()) {
+            std::cout << ", " << replay->spanSeconds() << " s recorded";
+        }
+        std::cout << ")" << std::endl;
+        std::cout << "Replay pacing: ";
+        if (replay_pacing) {
+            std::cout << "recorded timestamps x" << replay_speed;
+        } else {
+            std::cout << "test rate";
+        }
+        std::cout << (replay->looping() ? ", looping" : "") << std::endl;
+    }
+    std::cout << "Threads: " << num_threads << std::endl;
+    if (duration_seconds > 0) {
+        std::cout << "Duration: " << duration_seconds << " seconds";
+        if (warmup_seconds > 0) {
+            std::cout << " after " << warmup_seconds << " s warm-up";
+        }
+        std::cout << ", drain up to " << drain_seconds << " s" << std::endl;
+    } else {
+        std::cout << "Drain: up to " << drain_seconds << " s per step" << std::endl;
+    }
+    if (duration_seconds <= 0 || (replay && replay_pacing)) {
+        // Темп задаёт поиск предела или запись, RPS и профиль не используются
+    } else if (!rate_profile.empty()) {
+        std::cout << "Rate profile:";
+        for (const auto& segment : rate_profile.segments()) {
+            std::cout << " [" << segment.start_rps << "->" << segment.end_rps
+                      << " RPS, " << segment.duration_seconds << "s]";
+        }
+        std::cout << std::endl;
+    } else {
+        std::cout << "Target RPS: " << (requests_per_second > 0 ? std::to_string(requests_per_second) : "MAX") << std::endl;
+    }
+    std::cout << "Arrival: " << (arrival_process == ArrivalProcess::Poisson ? "poisson" : "uniform") << std::endl;
+    std::cout << "Connections: " << (keep_alive ? "keep-alive" : "new per request");
+    if (max_host_connections > 0) {
+        std::cout << ", up to " << max_host_connections
+                  << (engine_mode == EngineMode::Multi ? " per loop" : "");
+    }
+    std::cout << std::endl;
+    if (protocol == HttpProtocol::Http1) {
+        std::cout << "Protocol: HTTP/1.1" << std::endl;
+    } else {
+        std::cout << "Protocol: HTTP/2" << (protocol == HttpProtocol::Http2PriorKnowledge ? " (prior knowledge)" : "");
+        if (engine_mode == EngineMode::Multi) {
+            std::cout << ", up to " << max_streams << " streams per connection";
+        } else {
+            std::cout << ", one stream per connection (blocking engine)";
+        }
+        std::cout << std::endl;
+    }
+    if (engine_mode == EngineMode::Multi) {
+        std::cout << "Engine: curl_multi, " << max_in_flight << " in flight per loop" << std::endl;
+    } else {
+        std::cout << "Engine: blocking threads" << std::endl;
+    }
+    if (affinity.enabled()) {
+        std::cout << "CPU affinity: workers "
+                  << (affinity.worker_cpus.empty() ? "unpinned" : formatCpuList(affinity.worker_cpus));
+        const std::vector<int> reporter = affinity.reporterCpus();
+        std::cout << ", reporting " << (reporter.empty() ? "unpinned" : formatCpuList(reporter)) << std::endl;
+    }
+    std::cout << "========================\n" << std::endl;
+}
+
+bool LoadTester::runTest(int num_threads, int duration_seconds, int requests_per_second) {
+    // Два теста на одних контекстах потоков и гистограммах мешали бы друг другу
+    if (test_active.exchange(true)) {
+        std::cerr << "Cannot start a test: another test is running" << std::endl;
+        return false;
+    }
+    const bool started = executeTest(num_threads, duration_seconds, requests_per_second);
+    stop_requested = false;
+    test_active = false;
+    return started;
+}
+
+bool LoadTester::runTest(int num_threads, int duration_seconds, int requests_per_second,
+                         EngineMode mode, int in_flight) {
+    if (test_active.exchange(true)) {
+        std::cerr << "Cannot start a test: another test is running" << std::endl;
+        return false;
+    }
+    // Модель меняется только под захваченным test_active и возвращается до его снятия
+    const EngineMode saved_mode = engine_mode;
+    const int saved_in_flight = max_in_flight;
+    engine_mode = mode;
+    if (in_flight > 0) {
+        max_in_flight = in_flight;
+    }
+    const bool started = executeTest(num_threads, duration_seconds, requests_per_second);
+    engine_mode = saved_mode;
+    max_in_flight = saved_in_flight;
+    stop_requested = false;
+    test_active = false;
+    return started;
+}
+
+bool LoadTester::executeTest(int num_threads, int duration_seconds, int requests_per_second) {
+    if (engine_mode == EngineMode::Multi && num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(scenarios_mutex);
+        buildScenarios();
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid scenarios: " << e.what() << std::endl;
+        return false;
+    }
+
+    // Выводим шапку с настройками теста
+    printTestHeader(num_threads, duration_seconds, requests_per_second);
+    createWorkers(num_threads);
+    standalone_counters.reset();
+    if (replay) {
+        replay->rewind();
+    }
+
+    // Открытая модель: запросы уходят по общей шкале времени независимо
+    // от скорости ответов. Без RPS и профиля - закрытый цикл на максимальной скорости
+    std::unique_ptr<ArrivalScheduler> scheduler;
+    if (!rate_profile.empty()) {
+        scheduler = std::make_unique<ArrivalScheduler>(rate_profile, arrival_process);
+    } else if (requests_per_second > 0) {
+        scheduler = std::make_unique<ArrivalScheduler>(
+            RateProfile::constant(requests_per_second), arrival_process);
+    }
+
+    event_log.setThreadAffinity(affinity.reporterCpus());
+    event_log.start();
+
+    // Разогрев: начало теста на тех же контекстах (соединения, TLS, кэш DNS),
+    // затем статистика обнуляется, а планировщик и запись начинаются заново
+    if (warmup_seconds > 0) {
+        std::cout << "Warming up for " << warmup_seconds << " seconds" << std::endl;
+        runWorkers(warmup_seconds, scheduler.get(), false);
+        const long excluded = collectCounters().requests_started;
+        resetWorkerStats();
+        if (replay) {
+            replay->rewind();
+        }
+        std::cout << "Warm-up done: " << excluded << " requests excluded from results" << std::endl;
+    }
+
+    if (!time_series_path.empty() && !time_series.open(time_series_path)) {
+        std::cerr << "Failed to open time series file " << time_series_path << std::endl;
+    }
+
+    // Трасса пишется только в измеряемой части: кольца выдаются потокам после разогрева
+    if (!trace_path.empty()) {
+        if (trace_writer.open(trace_path)) {
+            for (auto& worker : workers) {
+                worker->trace = trace_writer.attach(workers.size());
+            }
+            trace_writer.setThreadAffinity(affinity.reporterCpus());
+            trace_writer.start(std::chrono::steady_clock::now());
+        } else {
+            std::cerr << "Failed to open request trace " << trace_path << std::endl;
+        }
+    }
+
+    std::cout << "Starting load test with " << num_threads << " threads for "
+              << duration_seconds << " seconds" << std::endl;
+    test_elapsed_seconds = runWorkers(duration_seconds, scheduler.get(), true);
+
+    event_log.stop();
+    if (time_series.isOpen()) {
+        time_series.close();
+        std::cout << "\nTime series written to " << time_series_path << std::endl;
+    }
+    if (trace_writer.isOpen()) {
+        for (auto& worker : workers) {
+            worker->trace = nullptr;
+        }
+        trace_writer.stop();
+        std::cout << "\nRequest trace: " << trace_writer.written() << " records written to " << trace_path;
+        if (trace_writer.dropped() > 0) {
+            std::cout << " (" << trace_writer.dropped() << " dropped: writer fell behind)";
+        }
+        std::cout << std::endl;
+    }
+    
+    printResults();
+    return true;
+}
+
+CapacitySearchResult LoadTester::findMaxThroughput(int num_threads, const CapacitySearchConfig& config) {
+    CapacitySearchResult result;
+    if (replay && replay_pacing) {
+        std::cerr << "Capacity search sets its own rate: disable replay pacing first" << std::endl;
+        result.rejected = true;
+        return result;
+    }
+    if (test_active.exchange(true)) {
+        std::cerr << "Cannot start a test: another test is running" << std::endl;
+        result.rejected = true;
+        return result;
+    }
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(scenarios_mutex);
+        buildScenarios();
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid scenarios: " << e.what() << std::endl;
+        test_active = false;
+        result.rejected = true;
+        return result;
+    }
+
+    // Длительность и темп задают ступени - они выводятся строкой поиска
+    printTestHeader(num_threads, 0, 0);
+    std::cout << "Capacity search: " << config.step_seconds << " s steps from " << config.start_rps
+              << " RPS, SLO p99 <= " << config.p99_ms << " ms, errors <= "
+              << config.max_error_rate * 100 << "%" << std::endl;
+    createWorkers(num_threads);
+    standalone_counters.reset();
+    if (replay) {
+        replay->rewind();
+    }
+    event_log.setThreadAffinity(affinity.reporterCpus());
+    event_log.start();
+
+    CapacitySearch search(config);
+    double total_elapsed = 0;
+    result = search.run([&](double rps, CapacityStep& step) {
+        if (stop_requested.load()) {
+            return false;
+        }
+        // Ступень считается по разнице накопленных счётчиков и гистограмм
+        const CounterTotals before = collectCounters();
+        LatencyHistogram before_latency;
+        collectLatency(before_latency);
+
+        ArrivalScheduler scheduler(RateProfile::constant(rps), arrival_process);
+        const double elapsed = runWorkers(config.step_seconds, &scheduler, false);
+        total_elapsed += elapsed;
+        if (stop_requested.load()) {
+            return false;
+        }
+
+        const CounterTotals after = collectCounters();
+        LatencyHistogram latency;
+        collectLatency(latency);
+        latency.subtract(before_latency);
+
+        step.completed = after.completed() - before.completed();
+        // Прерванные при завершении ступени - самые медленные запросы; в гистограмму они не
+        // попадают, поэтому учитываются как ошибки
+        step.cancelled = after.requests_cancelled - before.requests_cancelled;
+        const long failed = (after.requests_failed - before.requests_failed) +
+                            (after.error_responses - before.error_responses) + step.cancelled;
+        const long attempted = step.completed + step.cancelled;
+        // Последний запланированный момент может прийтись раньше конца ступени
+        step.achieved_rps = step.completed / std::max(elapsed, static_cast<double>(config.step_seconds));
+        step.error_rate = attempted > 0 ? static_cast<double>(failed) / attempted : 0;
+        step.p50_ms = latency.percentile(50) / 1e6;
+        step.p99_ms = latency.percentile(99) / 1e6;
+        std::cout << "Step " << std::fixed << std::setprecision(1) << rps << " RPS: achieved "
+                  << step.achieved_rps << ", p99 " << std::setprecision(3) << step.p99_ms << " ms, errors "
+                  << step.error_rate * 100 << "% - " << (search.meetsSlo(step) ? "ok" : "SLO violated")
+                  << std::defaultfloat << std::setprecision(6) << std::endl;
+
+        // Пауза, чтобы очередь перегруженной ступени не досталась следующей
+        if (config.cooldown_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldown_ms));
+        }
+        return true;
+    });
+    test_elapsed_seconds = total_elapsed;
+    event_log.stop();
+
+    CapacitySearch::print(result, config);
+    if (!config.curve_path.empty()) {
+        if (CapacitySearch::writeCurve(result, config.curve_path)) {
+            std::cout << "Capacity curve written to " << config.curve_path << std::endl;
+        } else {
+            std::cerr << "Failed to write capacity curve " << config.curve_path << std::endl;
+        }
+    }
+
+    stop_requested = false;
+    test_active = false;
+    return result;
+}
+
+void LoadTester::createWorkers(int num_threads) {
+    // Контексты создаются до запуска потоков: curl_easy_init выполняет
+    // глобальную инициализацию CURL, которая не потокобезопасна
+    workers.clear();
+    const uint64_t base_seed = has_seed ? seed : (static_cast<uint64_t>(std::random_device{}()) << 32 | std::random_device{}());
+    for (int i = 0; i < num_threads; ++i) {
+        auto create = [&]() {
+            int num_slots = engine_mode == EngineMode::Multi ? max_in_flight : 1;
+            auto ctx = std::make_unique<WorkerContext>(i, num_slots);
+            ctx->rng.reseed(base_seed + static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull);
+            ctx->next_request_id = i;
+            ctx->request_id_step = num_threads;
+            ctx->log = event_log.attach();
+            if (scenarios.size() > 1) {
+                for (size_t s = 0; s < scenarios.size(); ++s) {
+                    ctx->scenario_stats.push_back(std::make_unique<ScenarioStats>());
+                }
+            }
+            prepareWorker(*ctx);
+            workers.push_back(std::move(ctx));
+        };
+
+        const int cpu = affinity.workerCpu(static_cast<size_t>(i));
+        if (cpu < 0) {
+            create();
+            continue;
+        }
+        // Страницы достаются NUMA-узлу того ядра, которое первым их коснулось:
+        // контекст создаётся потоком на ядре будущего рабочего. Потоки идут по одному,
+        // поэтому инициализация CURL по-прежнему не выполняется параллельно
+        bool pinned = false;
+        std::thread([&]() {
+            pinned = pinCurrentThread({cpu});
+            create();
+        }).join();
+        if (pinned) {
+            workers.back()->cpu = cpu;
+        } else {
+            std::cerr << "Cannot pin worker " << i << " to CPU " << cpu << ", running unpinned" << std::endl;
+        }
+    }
+}
+
+void LoadTester::resetWorkerStats() {
+    standalone_counters.reset();
+    for (auto& worker : workers) {
+        worker->counters.reset();
+        worker->latency.reset();
+        worker->phases.reset();
+        for (auto& stats : worker->scenario_stats) {
+            stats->counters.reset();
+            stats->latency.reset();
+        }
+    }
+}
+
+double LoadTester::runWorkers(int duration_seconds, ArrivalScheduler* scheduler, bool with_metrics) {
+    std::vector<std::thread> threads;
+    auto start_time = std::chrono::steady_clock::now();
+    const auto deadline = start_time + std::chrono::seconds(duration_seconds);
+    hard_stop = deadline + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(drain_seconds));
+    if (scheduler) {
+        scheduler->start(start_time);
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        threads.emplace_back([this, i, start_time, deadline, duration_seconds, scheduler]() {
+            WorkerContext& ctx = *workers[i];
+            if (ctx.cpu >= 0) {
+                pinCurrentThread({ctx.cpu});
+            }
+
+            if (engine_mode == EngineMode::Multi) {
+                this->runEventLoop(ctx, start_time, duration_seconds, scheduler);
+                return;
+            }
+
+            // Без RPS, профиля и темпа записи момент пустой - закрытый цикл
+            ReplayRecord record;
+            std::chrono::steady_clock::time_point intended;
+            while (!stop_requested.load(std::memory_order_relaxed) &&
+                   std::chrono::steady_clock::now() < deadline &&
+                   this->nextArrival(ctx, scheduler, start_time, record, intended)) {
+                if (intended != std::chrono::steady_clock::time_point{}) {
+                    if (intended >= deadline || !waitUntilOrStop(intended, stop_requested)) {
+                        break;
+                    }
+                }
+                this->sendRequest(ctx, ctx.takeRequestId(), intended, replay ? &record : nullptr);
+            }
+        });
+    }
+
+    std::atomic<bool> workers_done{false};
+    std::thread metrics_thread;
+    if (with_metrics) {
+        metrics_thread = std::thread([this, start_time, duration_seconds, &workers_done]() {
+            const std::vector<int> reporter = affinity.reporterCpus();
+            if (!reporter.empty()) {
+                pinCurrentThread(reporter);
+            }
+            runMetrics(start_time, duration_seconds, workers_done);
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    hard_stop = {};
+    workers_done = true;
+    if (metrics_thread.joinable()) {
+        metrics_thread.join();
+    }
+    return elapsed;
+}
+
+void LoadTester::writeTimeSeriesRow(std::chrono::steady_clock::time_point from,
+                                    const CounterTotals& from_totals, const LatencyHistogram& from_latency,
+                                    std::chrono::steady_clock::time_point to,
+                                    const CounterTotals& to_totals, const LatencyHistogram& to_latency,
+                                    std::chrono::steady_clock::time_point start_time) {
+    LatencyHistogram interval = to_latency;
+    interval.subtract(from_latency);
+
+    TimeSeriesRow row;
+    // Стенные часы нужны только для сверки с событиями на стороне сервера
+    row.unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    row.elapsed_seconds = std::chrono::duration<double>(to - start_time).count();
+    row.interval_seconds = std::chrono::duration<double>(to - from).count();
+    row.attempted = to_totals.requests_started - from_totals.requests_started;
+    row.completed = to_totals.completed() - from_totals.completed();
+    row.succeeded = to_totals.success_responses - from_totals.success_responses;
+    row.check_failed = to_totals.error_responses - from_totals.error_responses;
+    row.http_errors = to_totals.http_errors - from_totals.http_errors;
+    row.transport_errors = to_totals.transport_errors - from_totals.transport_errors;
+    row.in_flight = to_totals.inFlight();
+    row.p50_ns = interval.percentile(50);
+    row.p90_ns = interval.percentile(90);
+    row.p99_ns = interval.percentile(99);
+    row.max_ns = interval.max();
+    time_series.write(row);
+}
+
+void LoadTester::runMetrics(std::chrono::steady_clock::time_point start_time, int duration_seconds,
+                            const std::atomic<bool>& workers_done) {
+    using Clock = std::chrono::steady_clock;
+    constexpr auto kTick = std::chrono::milliseconds(100);
+    constexpr auto kWindow = std::chrono::seconds(1);
+
+    /// Накопительное состояние на момент такта
+    struct Sample {
+        Clock::time_point time;
+        CounterTotals totals;
+        LatencyHistogram latency;
+        PhaseHistograms phases;
+    };
+    std::deque<Sample> history;
+    Sample series_mark;             // Конец последней записанной строки временного ряда
+    series_mark.time = start_time;
+
+    auto next_progress = start_time;
+    auto next_callback = start_time + snapshot_interval;
+
+    while (true) {
+        const bool finished = workers_done.load();
+        const auto now = Clock::now();
+
+        Sample sample;
+        sample.time = now;
+        collectLatency(sample.latency);
+        collectPhases(sample.phases);
+        sample.totals = collectCounters();
+        const CounterTotals totals = sample.totals;
+
+        // Интервальные значения - по самому старому такту в пределах последней секунды
+        history.push_back(std::move(sample));
+        while (history.size() > 1 && history[1].time <= now - kWindow) {
+            history.pop_front();
+        }
+        const Sample& current = history.back();
+        const Sample& oldest = history.front();
+        LatencyHistogram interval = current.latency;
+        interval.subtract(oldest.latency);
+        double window_seconds = std::chrono::duration<double>(now - oldest.time).count();
+        double elapsed = std::chrono::duration<double>(now - start_time).count();
+
+        MetricsSnapshot snapshot;
+        snapshot.running = finished ? 0 : 1;
+        snapshot.elapsed_seconds = elapsed;
+        snapshot.requests_started = totals.requests_started;
+        snapshot.requests_sent = totals.requests_sent;
+        snapshot.requests_failed = totals.requests_failed;
+        snapshot.success_responses = totals.success_responses;
+        snapshot.error_responses = totals.error_responses;
+        snapshot.http_errors = totals.http_errors;
+        snapshot.transport_errors = totals.transport_errors;
+        snapshot.in_flight = totals.inFlight();
+        snapshot.interval_rps = window_seconds > 0
+            ? (current.totals.completed() - oldest.totals.completed()) / window_seconds : 0;
+        snapshot.cumulative_rps = elapsed > 0 ? totals.completed() / elapsed : 0;
+        snapshot.interval_p50_ms = interval.percentile(50) / 1e6;
+        snapshot.interval_p99_ms = interval.percentile(99) / 1e6;
+        snapshot.mean_ms = current.latency.mean() / 1e6;
+        snapshot.p50_ms = current.latency.percentile(50) / 1e6;
+        snapshot.p90_ms = current.latency.percentile(90) / 1e6;
+        snapshot.p99_ms = current.latency.percentile(99) / 1e6;
+        snapshot.p999_ms = current.latency.percentile(99.9) / 1e6;
+        snapshot.max_ms = current.latency.max() / 1e6;
+        PhaseHistograms interval_phases = current.phases;
+        interval_phases.subtract(oldest.phases);
+        for (size_t i = 0; i < kRequestPhaseCount; ++i) {
+            snapshot.phase_p50_ms[i] = interval_phases.phase[i].percentile(50) / 1e6;
+            snapshot.phase_p99_ms[i] = interval_phases.phase[i].percentile(99) / 1e6;
+        }
+        snapshot_buffer.publish(snapshot);
+
+        if (time_series.isOpen() && (now - series_mark.time >= std::chrono::seconds(1) ||
+                                     (finished && now > series_mark.time))) {
+            writeTimeSeriesRow(series_mark.time, series_mark.totals, series_mark.latency,
+                               current.time, current.totals, current.latency, start_time);
+            series_mark = current;
+        }
+
+        if (snapshot_callback && (finished || now >= next_callback)) {
+            snapshot_callback(snapshot);
+            next_callback += snapshot_interval;
+        }
+
+        if (finished) {
+            break;
+        }
+
+        if (now >= next_progress) {
+            int progress = duration_seconds > 0
+                ? static_cast<int>(std::min(100.0, elapsed * 100 / duration_seconds)) : 100;
+            std::cout << "\rProgress: " << progress << "% | "
+                      << "Requests: " << totals.requests_sent << " | "
+                      << "Success: " << totals.success_responses << " | "
+                      << "Errors: " << totals.error_responses << " | "
+                      << "p50: " << formatMs(interval.percentile(50)) << " | "
+                      << "p99: " << formatMs(interval.percentile(99)) << "   ";
+            std::cout.flush();
+            next_progress += std::chrono::seconds(1);
+        }
+
+        std::this_thread::sleep_until(now + kTick);
+    }
+}
+
+bool LoadTester::startTest(int num_threads, int duration_seconds, int requests_per_second) {
+    if (test_active.exchange(true)) {
+        return false;
+    }
+    if (runner.joinable()) {
+        runner.join();
+    }
+    stop_requested = false;
+    runner = std::thread([this, num_threads, duration_seconds, requests_per_second]() {
+        executeTest(num_threads, duration_seconds, requests_per_second);
+        stop_requested = false;
+        test_active = false;
+    });
+    return true;
+}
+
+void LoadTester::requestStop() {
+    if (test_active) {
+        stop_requested = true;
+    }
+}
+
+void LoadTester::stopTest() {
+    if (test_active) {
+        stop_requested = true;
+    }
+    if (runner.joinable()) {
+        runner.join();
+    }
+}
+
+bool LoadTester::isRunning() const {
+    return test_active;
+}
+
+MetricsSnapshot LoadTester::snapshot() const {
+    return snapshot_buffer.read();
+}
+
+void LoadTester::setSnapshotCallback(SnapshotCallback callback, int interval_ms) {
+    snapshot_callback = std::move(callback);
+    snapshot_interval = std::chrono::milliseconds(std::max(100, interval_ms));
+}
+
+void LoadTester::setHistogramExportPath(const std::string& path) {
+    histogram_export_path = path;
+}
+
+void LoadTester::setTimeSeriesPath(const std::string& path) {
+    time_series_path = path;
+}
+
+void LoadTester::setTracePath(const std::string& path) {
+    trace_path = path;
+}
+
+void LoadTester::collectScenario(size_t index, CounterTotals& totals, LatencyHistogram& latency) const {
+    for (const auto& worker : workers) {
+        if (index < worker->scenario_stats.size()) {
+            totals.add(worker->scenario_stats[index]->counters);
+            worker->scenario_stats[index]->latency.snapshotInto(latency);
+        }
+    }
+}
+
+void LoadTester::collectPhases(PhaseHistograms& out) const {
+    for (const auto& worker : workers) {
+        worker->phases.snapshotInto(out);
+    }
+}
+
+void LoadTester::collectLatency(LatencyHistogram& out) const {
+    for (const auto& worker : workers) {
+        worker->latency.snapshotInto(out);
+    }
+}
+
+CounterTotals LoadTester::collectCounters() const {
+    CounterTotals totals;
+    totals.add(standalone_counters);
+    for (const auto& worker : workers) {
+        totals.add(worker->counters);
+    }
+    return totals;
+}
+
+void LoadTester::printSummary(const CounterTotals& totals, const LatencyHistogram& latency,
+                              double elapsed_seconds) {
+    const long completed = totals.completed();
+
+    std::cout << "Requests attempted: " << totals.requests_started << std::endl;
+    std::cout << "Requests completed: " << completed << std::endl;
+    std::cout << "Successful responses: " << totals.success_responses << std::endl;
+    std::cout << "Error responses: " << totals.error_responses << std::endl;
+    std::cout << "HTTP errors: " << totals.http_errors << std::endl;
+    std::cout << "Transport errors: " << totals.transport_errors << std::endl;
+    std::cout << "Failed requests: " << totals.requests_failed << std::endl;
+    
+    if (completed > 0) {
+        double success_rate = (totals.success_responses * 100.0) / completed;
+        double error_rate = ((completed - totals.success_responses) * 100.0) / completed;
+        std::cout << "Success rate: " << success_rate << "%" << std::endl;
+        std::cout << "Error rate: " << error_rate << "%" << std::endl;
+    }
+
+    // Пропускная способность - по стенному времени теста, а не по сумме задержек потоков
+    if (elapsed_seconds > 0) {
+        std::cout << "Test duration: " << elapsed_seconds << " s" << std::endl;
+        std::cout << "Requests per second: " << completed / elapsed_seconds << std::endl;
+        std::cout << "Successful responses per second: "
+                  << totals.success_responses / elapsed_seconds << std::endl;
+    }
+
+    if (latency.count() > 0) {
+        std::cout << "Latency (from intended send time):" << std::endl;
+        std::cout << "  mean:  " << formatMs(static_cast<uint64_t>(latency.mean())) << std::endl;
+        std::cout << "  p50:   " << formatMs(latency.percentile(50)) << std::endl;
+        std::cout << "  p90:   " << formatMs(latency.percentile(90)) << std::endl;
+        std::cout << "  p99:   " << formatMs(latency.percentile(99)) << std::endl;
+        std::cout << "  p99.9: " << formatMs(latency.percentile(99.9)) << std::endl;
+        std::cout << "  max:   " << formatMs(latency.max()) << std::endl;
+    }
+
+    if (totals.requests_cancelled > 0) {
+        std::cout << "Cancelled at stop (not counted): " << totals.requests_cancelled << std::endl;
+    }
+    std::cout << "Connections opened: " << totals.connections_opened << std::endl;
+    std::cout << "Connections reused: " << totals.connections_reused << std::endl;
+    if (totals.http2_streams > 0) {
+        std::cout << "HTTP/2 streams: " << totals.http2_streams << std::endl;
+        if (totals.connections_opened > 0) {
+            std::cout << "Streams per connection: "
+                      << static_cast<double>(totals.http2_streams) / totals.connections_opened << std::endl;
+        }
+    }
+}
+
+void LoadTester::printPhaseSummary(const PhaseHistograms& phases) {
+    if (phases.phase[static_cast<size_t>(RequestPhase::Ttfb)].count() == 0) {
+        return;
+    }
+    // Фазы соединения считаются только по запросам, открывшим соединение, поэтому число строк разное
+    std::cout << "Latency by phase (CURL timings, ms):" << std::endl;
+    std::cout << std::left << std::setw(12) << "  phase" << std::right << std::setw(10) << "count"
+              << std::setw(12) << "mean" << std::setw(12) << "p50" << std::setw(12) << "p99"
+              << std::setw(12) << "max" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < kRequestPhaseCount; ++i) {
+        const LatencyHistogram& phase = phases.phase[i];
+        if (phase.count() == 0) {
+            continue;
+        }
+        std::cout << "  " << std::left << std::setw(10) << requestPhaseName(i) << std::right
+                  << std::setw(10) << phase.count() << std::setw(12) << phase.mean() / 1e6
+                  << std::setw(12) << phase.percentile(50) / 1e6 << std::setw(12) << phase.percentile(99) / 1e6
+                  << std::setw(12) << phase.max() / 1e6 << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+/// @brief Перцентили гистограммы в миллисекундах
+static json latencyJson(const LatencyHistogram& latency) {
+    return {{"count", latency.count()}, {"mean", latency.mean() / 1e6},
+            {"p50", latency.percentile(50) / 1e6}, {"p90", latency.percentile(90) / 1e6},
+            {"p99", latency.percentile(99) / 1e6}, {"p99_9", latency.percentile(99.9) / 1e6},
+            {"max", latency.max() / 1e6}};
+}
+
+json LoadTester::summaryJson(const CounterTotals& totals, const LatencyHistogram& latency,
+                             const PhaseHistograms& phases, double elapsed_seconds) {
+    const long completed = totals.completed();
+    json summary;
+    summary["duration_s"] = elapsed_seconds;
+    summary["requests"] = {{"attempted", totals.requests_started}, {"completed", completed},
+                           {"success", totals.success_responses}, {"failed", totals.requests_failed},
+                           {"cancelled", totals.requests_cancelled}};
+    summary["errors"] = {{"checks", totals.error_responses}, {"http", totals.http_errors},
+                         {"transport", totals.transport_errors}};
+    summary["error_rate"] = completed > 0
+        ? static_cast<double>(completed - totals.success_responses) / completed : 0.0;
+    summary["throughput"] = {{"rps", elapsed_seconds > 0 ? completed / elapsed_seconds : 0.0},
+                             {"success_rps", elapsed_seconds > 0 ? totals.success_responses / elapsed_seconds : 0.0}};
+    summary["latency_ms"] = latencyJson(latency);
+
+    json phases_json = json::object();
+    for (size_t i = 0; i < kRequestPhaseCount; ++i) {
+        if (phases.phase[i].count() > 0) {
+            phases_json[requestPhaseName(i)] = latencyJson(phases.phase[i]);
+        }
+    }
+    summary["phases_ms"] = phases_json;
+    summary["connections"] = {{"opened", totals.connections_opened}, {"reused", totals.connections_reused},
+                              {"http2_streams", totals.http2_streams}};
+    return summary;
+}
+
+json LoadTester::resultsJson() const {
+    LatencyHistogram latency;
+    collectLatency(latency);
+    PhaseHistograms phases;
+    collectPhases(phases);
+    json results = summaryJson(collectCounters(), latency, phases, test_elapsed_seconds);
+
+    if (!workers.empty() && workers.front()->scenario_stats.size() > 1) {
+        json scenarios_json = json::array();
+        for (size_t i = 0; i < scenarios.size(); ++i) {
+            CounterTotals scenario_totals;
+            LatencyHistogram scenario_latency;
+            collectScenario(i, scenario_totals, scenario_latency);
+            json scenario = summaryJson(scenario_totals, scenario_latency, PhaseHistograms(), test_elapsed_seconds);
+            scenario.erase("phases_ms");
+            scenario.erase("connections");
+            scenario["name"] = scenarios[i]->name;
+            scenarios_json.push_back(scenario);
+        }
+        results["scenarios"] = scenarios_json;
+    }
+    return results;
+}
+
+void LoadTester::printWorkerSummary() const {
+    // Перекос между потоками виден только по отдельным потокам: общий RPS его скрывает
+    std::cout << "\nPer worker:" << std::endl;
+    std::cout << std::right << std::setw(8) << "thread" << std::setw(6) << "cpu" << std::setw(6) << "node"
+              << std::setw(12) << "completed" << std::setw(12) << "rps" << std::setw(12) << "p99 ms" << std::endl;
+    double min_rps = 0;
+    double max_rps = 0;
+    double total_rps = 0;
+    for (const auto& worker : workers) {
+        CounterTotals totals;
+        totals.add(worker->counters);
+        LatencyHistogram latency;
+        worker->latency.snapshotInto(latency);
+        const double rps = test_elapsed_seconds > 0 ? totals.completed() / test_elapsed_seconds : 0;
+        min_rps = worker == workers.front() ? rps : std::min(min_rps, rps);
+        max_rps = std::max(max_rps, rps);
+        total_rps += rps;
+
+        std::cout << std::setw(8) << worker->thread_id;
+        if (worker->cpu >= 0) {
+            std::cout << std::setw(6) << worker->cpu << std::setw(6) << cpuNumaNode(worker->cpu);
+        } else {
+            std::cout << std::setw(6) << "-" << std::setw(6) << "-";
+        }
+        std::cout << std::setw(12) << totals.completed() << std::fixed << std::setprecision(1)
+                  << std::setw(12) << rps << std::setprecision(3) << std::setw(12) << latency.percentile(99) / 1e6
+                  << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+    const double mean_rps = total_rps / static_cast<double>(workers.size());
+    if (mean_rps > 0) {
+        std::cout << "Worker imbalance: slowest " << std::fixed << std::setprecision(1)
+                  << (mean_rps - min_rps) * 100 / mean_rps << "% below mean, fastest "
+                  << (max_rps - mean_rps) * 100 / mean_rps << "% above" << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+}
+
+void LoadTester::printResults() {
+    CounterTotals totals = collectCounters();
+    LatencyHistogram latency;
+    collectLatency(latency);
+
+    std::cout << "\n\n=== Load Test Results ===" << std::endl;
+    printSummary(totals, latency, test_elapsed_seconds);
+    PhaseHistograms phases;
+    collectPhases(phases);
+    printPhaseSummary(phases);
+
+    if (!histogram_export_path.empty()) {
+        std::ofstream out(histogram_export_path);
+        if (out) {
+            latency.exportCsv(out);
+            std::cout << "Latency histogram exported to " << histogram_export_path << std::endl;
+        } else {
+            std::cerr << "Failed to export latency histogram to " << histogram_export_path << std::endl;
+        }
+    }
+
+    if (workers.size() > 1) {
+        printWorkerSummary();
+    }
+
+    if (replay && replay->malformed() > 0) {
+        std::cout << "Replay records skipped (malformed): " << replay->malformed() << std::endl;
+    }
+
+    if (!workers.empty() && workers.front()->scenario_stats.size() > 1) {
+        std::cout << "\nPer scenario:" << std::endl;
+        std::cout << std::left << std::setw(24) << "scenario" << std::right
+                  << std::setw(10) << "completed" << std::setw(10) << "success"
+                  << std::setw(10) << "checks" << std::setw(10) << "http"
+                  << std::setw(10) << "transport" << std::setw(10) << "rps"
+                  << std::setw(12) << "p50 ms" << std::setw(12) << "p99 ms" << std::endl;
+        for (size_t i = 0; i < scenarios.size(); ++i) {
+            CounterTotals scenario_totals;
+            LatencyHistogram scenario_latency;
+            collectScenario(i, scenario_totals, scenario_latency);
+            double rps = test_elapsed_seconds > 0 ? scenario_totals.completed() / test_elapsed_seconds : 0;
+            std::cout << std::left << std::setw(24) << scenarios[i]->name.substr(0, 23) << std::right
+                      << std::setw(10) << scenario_totals.completed()
+                      << std::setw(10) << scenario_totals.success_responses
+                      << std::setw(10) << scenario_totals.error_responses
+                      << std::setw(10) << scenario_totals.http_errors
+                      << std::setw(10) << scenario_totals.transport_errors
+                      << std::fixed << std::setprecision(1) << std::setw(10) << rps
+                      << std::setprecision(3) << std::setw(12) << scenario_latency.percentile(50) / 1e6
+                      << std::setw(12) << scenario_latency.percentile(99) / 1e6 << std::endl;
+            std::cout.unsetf(std::ios::fixed);
+            std::cout << std::setprecision(6);
+        }
     }
 }
\ No newline at end of file
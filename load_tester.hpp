@@ -8,33 +8,155 @@
 #include <atomic>
 #include <nlohmann/json.hpp>
 #include <unordered_map>
-#include <random>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "arrival_scheduler.hpp"
+#include "body_template.hpp"
+#include "cpu_affinity.hpp"
+#include "capacity_search.hpp"
+#include "event_log.hpp"
+#include "fast_random.hpp"
+#include "latency_histogram.hpp"
+#include "live_metrics.hpp"
+#include "replay_source.hpp"
+#include "request_phases.hpp"
+#include "request_trace.hpp"
+#include "time_series.hpp"
+#include "response_matcher.hpp"
+#include "scenario.hpp"
+#include "worker_stats.hpp"
 
 // Предварительное объявление для CURL
 typedef void CURL;
+typedef void CURLM;
+struct curl_slist;
 
 /**
- * @struct FieldConfig
- * @brief Структура поля тестового запроса
+ * @enum EngineMode
+ * @brief Модель отправки запросов
  */
-struct FieldConfig {
-    std::string value;        //< Фиксированное значение или шаблон
-    bool is_random = false;   //< Флаг случайного значения
-    int min_val = 0;          //< Минимальное значение для случайных чисел
-    int max_val = 9999;       //< Максимальное значение для случайных чисел
+enum class EngineMode {
+    Blocking,   //< Поток на единицу параллелизма, блокирующий curl_easy_perform
+    Multi       //< Событийные циклы на curl_multi, много запросов в полёте на поток
 };
 
 /**
- * @struct ResponseCheckConfig
- * @brief Структура поля ответа на входной запрос
+ * @enum HttpProtocol
+ * @brief Версия HTTP запросов
+ *
+ * Конвейер HTTP/1.1 (pipelining) не поддерживается: libcurl убрал его в 7.62.
+ * Несколько запросов на одном соединении дают потоки HTTP/2.
  */
-struct ResponseCheckConfig {
-    std::string field_path;         //< Путь к полю (например: "success", "data.status")
-    std::string expected_value;     //< Ожидаемое значение
-    bool check_exists = true;       //< Проверять существование поля
+enum class HttpProtocol {
+    Http1,              //< HTTP/1.1, запрос занимает соединение целиком
+    Http2,              //< HTTP/2 через ALPN (https) или Upgrade (http), иначе HTTP/1.1
+    Http2PriorKnowledge //< HTTP/2 без согласования (h2c), сервер обязан его понимать
 };
 
-using TestDataConfig = std::unordered_map<std::string, FieldConfig>;
+/**
+ * @struct RequestSlot
+ * @brief Один переиспользуемый запрос "в полёте"
+ *
+ * Хранит easy-хэндл CURL и буферы запроса/ответа. В блокирующем режиме
+ * у потока один слот, в режиме curl_multi - max_in_flight слотов.
+ */
+struct RequestSlot {
+    CURL* curl = nullptr;               //< Переиспользуемый easy-хэндл
+    std::string post_data;              //< Буфер тела запроса
+    std::string response;               //< Буфер тела ответа
+    std::string url;                    //< URL и метод записанного запроса (воспроизведение)
+    std::string method;
+    std::chrono::steady_clock::time_point start_time;    //< Фактический момент отправки
+    std::chrono::steady_clock::time_point intended_time; //< Запланированный момент отправки
+    int request_id = 0;                 //< Номер запроса
+    bool active = false;                //< Запрос в полёте (в мульти-хэндле)
+    bool timeout_capped = false;        //< Таймаут запроса урезан до жёсткой остановки теста
+    int scenario = -1;                  //< Сценарий, под который настроен хэндл
+
+    RequestSlot();
+    ~RequestSlot();
+
+    RequestSlot(const RequestSlot&) = delete;
+    RequestSlot& operator=(const RequestSlot&) = delete;
+};
+
+/**
+ * @struct WorkerContext
+ * @brief Состояние рабочего потока, переиспользуемое между запросами
+ *
+ * Каждый поток runTest владеет своим контекстом: слоты с easy-хэндлами CURL
+ * (вместе с ними - кэш DNS и пул соединений) и, в режиме curl_multi,
+ * мульти-хэндл. Там же живут
+ * собственный генератор случайных чисел, шард счётчиков и гистограмма:
+ * на пути запроса поток не пишет ни в одну разделяемую кэш-линию.
+ */
+struct WorkerContext {
+    WorkerCounters counters;            //< Шард счётчиков (выровнен по кэш-линии)
+
+    int thread_id = 0;                  //< Номер потока-владельца
+    int cpu = -1;                       //< Ядро потока (-1 - без привязки)
+    CURLM* multi = nullptr;             //< Мульти-хэндл событийного цикла
+    std::vector<std::unique_ptr<RequestSlot>> slots; //< Слоты запросов
+    Xoshiro256 rng;                     //< Генератор потока (данные и интервалы прибытия)
+    HistogramRecorder latency;          //< Гистограмма задержек потока
+    PhaseRecorder phases;               //< Гистограммы фаз запроса (тайминги CURL)
+    EventRing* log = nullptr;           //< Кольцо журнала потока
+    TraceRing* trace = nullptr;         //< Кольцо трассы запросов (nullptr - трасса выключена)
+    std::vector<std::unique_ptr<ScenarioStats>> scenario_stats; //< Статистика по сценариям (если их несколько)
+    std::vector<GeneratorState> generators; //< Состояние генераторов полей по сценариям
+
+    int next_request_id = 0;            //< Следующий номер запроса потока
+    int request_id_step = 1;            //< Шаг номеров: номера потоков не пересекаются
+
+    WorkerContext(int id, int num_slots = 1);
+    ~WorkerContext();
+
+    /// @brief Передаёт событие в журнал без блокировки
+    void logEvent(const LogRecord& record) {
+        if (log) {
+            log->push(record);
+        }
+    }
+
+    /// @brief Выдаёт очередной номер запроса без обращения к общему счётчику
+    int takeRequestId() {
+        int id = next_request_id;
+        next_request_id += request_id_step;
+        return id;
+    }
+
+    WorkerContext(const WorkerContext&) = delete;
+    WorkerContext& operator=(const WorkerContext&) = delete;
+};
+
+/**
+ * @struct Scenario
+ * @brief Сценарий, подготовленный к тесту
+ *
+ * Заголовки, шаблон тела и проверки собираются один раз перед тестом
+ * и только читаются рабочими потоками.
+ */
+struct Scenario {
+    std::string name;                   //< Имя в отчёте
+    std::string url;                    //< Целевой URL
+    std::string method;                 //< Метод HTTP
+    bool sends_body = true;             //< Метод с телом (не GET/HEAD)
+    curl_slist* headers = nullptr;      //< Заголовки запроса
+    BodyTemplate body;                  //< Шаблон тела
+    ResponseMatcher matcher;            //< Проверки ответа
+    double weight = 1.0;                //< Доля в смеси
+
+    Scenario() = default;
+    ~Scenario();
+
+    Scenario(const Scenario&) = delete;
+    Scenario& operator=(const Scenario&) = delete;
+};
 
 /**
  * @class LoadTester
@@ -42,12 +164,18 @@ using TestDataConfig = std::unordered_map<std::string, FieldConfig>;
  */
 class LoadTester {
 public:
+    /// @brief Обработчик снимков метрик
+    using SnapshotCallback = std::function<void(const MetricsSnapshot& snapshot)>;
+
     /// @brief Конструктор по умолчанию
     LoadTester();
 
     /// @brief Конструктор принимающий target_url
     LoadTester(const std::string& url);
 
+    /// @brief Останавливает фоновый тест, если он идёт
+    ~LoadTester();
+
     /// @brief Устанавливает целевой URL для тестирования
     void setTargetUrl(const std::string& url);
 
@@ -57,6 +185,17 @@ public:
     /// @brief Устанавливает конкретное поле
     void setField(const std::string& field_name, const std::string& value, bool is_random = false);
 
+    /// @brief Задаёт тело запроса JSON-шаблоном (вложенные объекты и массивы)
+    /// @details Значения "{{random}}" / "{{random:MIN:MAX}}" заменяются случайными числами,
+    /// остальные "{{SPEC}}" - значениями генераторов (см. FieldGenerator).
+    /// Заменяет конфигурацию полей. Бросает исключение при некорректном JSON или генераторе
+    void setBodyTemplate(const std::string& json_template);
+
+    /// @brief Загружает таблицу данных из CSV для генераторов "{{pool:NAME:COLUMN}}"
+    /// @details Таблица должна быть загружена до шаблона, который на неё ссылается.
+    /// Бросает std::runtime_error, если файл не читается
+    void addDataPool(const std::string& name, const std::string& csv_path);
+
     /// @brief Добавляет проверку ответа от сервера
     void addResponseCheck(const std::string& field_path, const std::string& expected_value = "", bool check_exists = true);
 
@@ -66,44 +205,347 @@ public:
     /// @brief Очищает все проверки ответа от сервера
     void clearResponseChecks();
 
+    /// @brief Добавляет допустимый код HTTP ответа (без вызовов допустим только 200)
+    void addStatusCheck(long status);
+
+    /// @brief Добавляет проверку заголовка ответа (пустое значение - только наличие)
+    void addHeaderCheck(const std::string& name, const std::string& expected_value = "");
+
+    /// @brief Ограничивает размер тела ответа в байтах (max_bytes = 0 - без верхней границы)
+    void setBodySizeLimits(size_t min_bytes, size_t max_bytes = 0);
+
+    /// @brief Выводит журнал событий в файл (пустой путь - в консоль)
+    /// @return false, если файл не открылся
+    bool setLogFile(const std::string& path);
+
+    /// @brief Передаёт строки журнала событий в обработчик (пустой - вывод в консоль)
+    void setLogCallback(LogCallback callback);
+
+    /// @brief Ограничивает число полных строк журнала в секунду (0 - без ограничения)
+    /// @details Повторы одного вида ошибок сверх лимита выводятся итогом "HTTP 503 ×N"
+    void setLogRateLimit(int lines_per_second);
+
+    /// @brief Добавляет сценарий в смесь запросов
+    /// @details Пока сценариев нет, тест шлёт POST на target_url с телом из
+    /// конфигурации полей и проверками ответа LoadTester. Бросает исключение
+    /// при некорректном шаблоне тела или отрицательном (не конечном) весе
+    /// @return Номер сценария
+    int addScenario(const ScenarioConfig& scenario);
+
+    /// @brief Сценарий по номеру (для дополнения заголовками и проверками)
+    ScenarioConfig& scenarioConfig(int index);
+
+    /// @brief Удаляет все сценарии (возврат к одному запросу на target_url)
+    void clearScenarios();
+
+    /// @brief Воспроизводит записанные запросы из файла JSONL или HAR
+    /// @param speed Ускорение относительно исходного темпа (2 - вдвое быстрее)
+    /// @param pacing true - отправлять в моменты из записи, false - по RPS/профилю теста
+    /// @param loop Повторять запись по кругу до конца теста
+    /// @details Запись заменяет тела из конфигурации полей и сценарии; URL и метод
+    /// берутся из записи, если в ней есть. Бросает std::runtime_error, если файл не
+    /// открылся или в записях нет моментов отправки при pacing = true
+    void setReplayFile(const std::string& path, double speed = 1.0, bool pacing = true, bool loop = false);
+
+    /// @brief Отключает воспроизведение
+    void clearReplay();
+
+    /// @brief Задаёт разогрев: первые seconds секунд нагрузки не входят в итоги
+    /// @details Разогрев повторяет начало теста (та же интенсивность, профиль или запись)
+    /// на тех же соединениях, затем статистика обнуляется и тест начинается заново
+    void setWarmup(int seconds);
+
+    /// @brief Задаёт время на завершение запросов в полёте после конца теста
+    /// @details Новые запросы после конца теста не отправляются; не успевшие за
+    /// drain_seconds прерываются и учитываются как прерванные, а не как ошибки
+    void setDrainTimeout(double seconds);
+
+    /// @brief Включает keep-alive (true) или новое соединение на каждый запрос (false)
+    void setKeepAlive(bool enabled);
+
+    /// @brief Задаёт зерно генераторов: при одинаковом зерне данные запросов воспроизводимы
+    void setSeed(uint64_t seed);
+
+    /// @brief Выбирает модель отправки запросов
+    /// @param mode Блокирующие потоки или событийные циклы curl_multi
+    /// @param in_flight Число запросов в полёте на один цикл (для EngineMode::Multi)
+    /// @return false, если идёт тест (модель не меняется)
+    bool setEngineMode(EngineMode mode, int in_flight = 64);
+
+    /// @brief Текущая модель отправки запросов
+    EngineMode engineMode() const { return engine_mode; }
+
+    /// @brief Число запросов в полёте на один событийный цикл
+    int maxInFlight() const { return max_in_flight; }
+
+    /// @brief Выбирает версию HTTP и ограничения соединений
+    /// @param max_connections Соединений с хостом на событийный цикл (0 - без ограничения).
+    /// Запросы сверх ограничения ждут свободного соединения или потока в нём
+    /// @param max_streams Одновременных потоков HTTP/2 на соединение
+    /// @details Мультиплексирование потоков - только в режиме EngineMode::Multi:
+    /// у блокирующего потока один запрос в полёте
+    void setProtocol(HttpProtocol protocol, int max_connections = 0, int max_streams = 100);
+
+    /// @brief Задаёт размещение потоков теста по ядрам
+    /// @param worker_cpus Ядра рабочих потоков, по одному потоку на ядро по кругу (пусто - без привязки)
+    /// @param reporter_cpus Ядра потоков метрик, журнала и трассы (пусто - все, кроме рабочих)
+    /// @details Контексты потоков создаются на их ядрах, поэтому буферы, хэндлы CURL
+    /// и гистограммы попадают в память NUMA-узла своего потока
+    void setCpuAffinity(const std::vector<int>& worker_cpus, const std::vector<int>& reporter_cpus = {});
+
     /// @brief Отправляет один HTTP-запрос на целевой сервер
+    /// @return false при неудачном запросе или ошибке в сценариях
     bool sendRequest(int thread_id, int request_id);
 
+    /// @brief Задаёт профиль интенсивности (перекрывает requests_per_second в runTest)
+    void setRateProfile(const RateProfile& profile, ArrivalProcess process = ArrivalProcess::Uniform);
+
+    /// @brief Задаёт распределение моментов прибытия запросов
+    void setArrivalProcess(ArrivalProcess process);
+
+    /// @brief Добавляет участок в конец профиля интенсивности
+    void addRateSegment(const RateSegment& segment);
+
+    /// @brief Сбрасывает профиль интенсивности
+    void clearRateProfile();
+
+    /// @brief Отправляет HTTP-запрос через контекст рабочего потока
+    /// @param intended_time Запланированный момент отправки, от него считается задержка
+    /// @param record Записанный запрос (режим воспроизведения)
+    bool sendRequest(WorkerContext& ctx, int request_id,
+                     std::chrono::steady_clock::time_point intended_time = {},
+                     const ReplayRecord* record = nullptr);
+
     /// @brief Запускает нагрузочный тест с указанными параметрами
-    void runTest(int num_threads, int duration_seconds, int requests_per_second = 0);
+    /// @param num_threads Количество потоков (в режиме EngineMode::Multi - событийных циклов, 0 = по числу ядер)
+    /// @return false, если уже идёт другой тест (startTest, runTest или поиск предела)
+    /// или тест не начался из-за ошибки в сценариях
+    bool runTest(int num_threads, int duration_seconds, int requests_per_second = 0);
+
+    /// @brief Запускает тест на заданной модели отправки
+    /// @details Модель и окно действуют только на время теста; настройка setEngineMode
+    /// сохраняется. Меняются после захвата теста, поэтому не задевают идущий тест
+    /// @param in_flight Запросов в полёте на цикл (0 - окно из setEngineMode)
+    /// @return false, если уже идёт другой тест или тест не начался из-за ошибки в сценариях
+    bool runTest(int num_threads, int duration_seconds, int requests_per_second,
+                 EngineMode mode, int in_flight);
+
+    /// @brief Ищет наибольшую интенсивность, при которой выполняется SLO
+    /// @details Ступени с постоянной интенсивностью идут на одних и тех же контекстах
+    /// потоков: соединения, кэш DNS и буферы не создаются заново на каждой ступени.
+    /// Профиль интенсивности и темп записи не используются
+    /// @param num_threads Количество потоков (в режиме EngineMode::Multi - событийных циклов, 0 = по числу ядер)
+    CapacitySearchResult findMaxThroughput(int num_threads, const CapacitySearchConfig& config);
+
+    /// @brief Запускает тест в фоновом потоке и сразу возвращает управление
+    /// @return false, если тест уже идёт
+    bool startTest(int num_threads, int duration_seconds, int requests_per_second = 0);
+
+    /// @brief Просит идущий тест остановиться и сразу возвращает управление
+    /// @details Только выставляет флаг (можно вызывать из обработчика сигнала). Новые
+    /// запросы не отправляются, запросы в полёте прерываются
+    void requestStop();
+
+    /// @brief Останавливает идущий тест и дожидается его завершения
+    /// @details Без запущенного теста только дожидается фонового потока startTest
+    void stopTest();
+
+    /// @brief Идёт ли тест (запущенный startTest или runTest)
+    bool isRunning() const;
+
+    /// @brief Последний опубликованный снимок метрик
+    /// @details Снимок публикуется потоком метрик раз в 100 мс; чтение не блокирует
+    /// ни рабочие потоки, ни поток метрик
+    MetricsSnapshot snapshot() const;
+
+    /// @brief Регистрирует обработчик снимков (пустой - отключить)
+    /// @param interval_ms Период вызова, не чаще раза в 100 мс. Вызывается из потока
+    /// метрик, последний раз - после завершения теста
+    void setSnapshotCallback(SnapshotCallback callback, int interval_ms = 1000);
 
     /// @brief Выводит итоговую статистику тестирования
     void printResults();
 
+    /// @brief Выводит общую часть итогов: счётчики, пропускную способность и задержки
+    /// @details Используется и для теста одного процесса, и для слитых итогов агентов
+    static void printSummary(const CounterTotals& totals, const LatencyHistogram& latency,
+                             double elapsed_seconds);
+
+    /// @brief Выводит разбивку задержки по фазам запроса
+    static void printPhaseSummary(const PhaseHistograms& phases);
+
+    /// @brief Итоги в машиночитаемом виде: счётчики, ошибки по видам, пропускная
+    /// способность, перцентили задержки (мс) и фазы запроса
+    static nlohmann::json summaryJson(const CounterTotals& totals, const LatencyHistogram& latency,
+                                      const PhaseHistograms& phases, double elapsed_seconds);
+
+    /// @brief Итоги последнего теста в виде JSON (summaryJson и таблица по сценариям)
+    nlohmann::json resultsJson() const;
+
+    /// @brief Стенное время последнего теста, с
+    double testDuration() const { return test_elapsed_seconds; }
+
+    /// @brief Настройки теста в виде JSON-плана (для передачи агентам)
+    /// @details Цель, тело, проверки, сценарии, соединения, модель отправки,
+    /// профиль интенсивности, зерно и воспроизведение
+    nlohmann::json exportPlan() const;
+
+    /// @brief Применяет JSON-план (формат exportPlan)
+    /// @details Ключи, которых нет в плане, настроек не меняют. Бросает исключение
+    /// при некорректном плане
+    void applyPlan(const nlohmann::json& plan);
+
+    /// @brief Задаёт файл для выгрузки итоговой гистограммы задержек (CSV)
+    void setHistogramExportPath(const std::string& path);
+
+    /// @brief Задаёт файл посекундного временного ряда (".jsonl" - JSON Lines, иначе CSV)
+    /// @details Строки пишутся во время теста: отправлено, завершено, успешно, ошибки
+    /// по видам, запросы в полёте и перцентили задержки за каждую секунду
+    void setTimeSeriesPath(const std::string& path);
+
+    /// @brief Задаёт файл двоичной трассы запросов (пусто - без трассы)
+    /// @details По записи на каждый запрос измеряемой части теста (формат - request_trace.hpp);
+    /// разбирается утилитой trace_analyzer
+    void setTracePath(const std::string& path);
+
+    /// @brief Суммирует статистику одного сценария по всем потокам
+    /// @details Доступно, когда в тесте больше одного сценария
+    void collectScenario(size_t index, CounterTotals& totals, LatencyHistogram& latency) const;
+
+    /// @brief Сливает гистограммы задержек всех потоков
+    void collectLatency(LatencyHistogram& out) const;
+
+    /// @brief Сливает гистограммы фаз запроса всех потоков
+    void collectPhases(PhaseHistograms& out) const;
+
+    /// @brief Суммирует шарды счётчиков всех потоков
+    CounterTotals collectCounters() const;
+
 private:
-    std::atomic<long> requests_sent;            //< Общее количество отправленных запросов
-    std::atomic<long> requests_failed;          //< Количество неудачных запросов
-    std::atomic<long> success_responses;        //< Количество успешных ответов
-    std::atomic<long> error_responses;          //< Количество ответов с ошибкой
-    std::atomic<long> total_response_time;      //< Суммарное время ответов
+    WorkerCounters standalone_counters;         //< Счётчики запросов, отправленных вне runTest
 
     std::string target_url;                     //< Целевой URL для тестирования
+    bool keep_alive = true;                     //< Переиспользовать соединения между запросами
+    EngineMode engine_mode = EngineMode::Blocking; //< Модель отправки запросов
+    int max_in_flight = 64;                     //< Запросов в полёте на событийный цикл
+    HttpProtocol protocol = HttpProtocol::Http1; //< Версия HTTP
+    int max_host_connections = 0;               //< Соединений на событийный цикл (0 - без ограничения)
+    int max_streams = 100;                      //< Потоков HTTP/2 на соединение
+    AffinityPlan affinity;                      //< Размещение потоков по ядрам
+    RateProfile rate_profile;                   //< Профиль интенсивности
+    ArrivalProcess arrival_process = ArrivalProcess::Uniform; //< Распределение прибытия
+    std::string histogram_export_path;          //< Файл выгрузки гистограммы задержек
+    std::string time_series_path;               //< Файл временного ряда
+    TimeSeriesWriter time_series;               //< Запись временного ряда (поток метрик)
+    std::string trace_path;                     //< Файл трассы запросов
+    TraceWriter trace_writer;                   //< Запись трассы (фоновый поток)
+    double test_elapsed_seconds = 0;            //< Стенное время последнего теста
+    int warmup_seconds = 0;                     //< Разогрев, не входящий в итоги
+    double drain_seconds = 2.0;                 //< Время на завершение запросов после конца теста
+    std::chrono::steady_clock::time_point hard_stop{}; //< Момент прерывания запросов в полёте (пустой - вне теста)
+
+    EventLog event_log;                         //< Журнал событий (переживает контексты потоков)
+    std::vector<std::unique_ptr<WorkerContext>> workers; //< Контексты рабочих потоков
+
+    std::atomic<bool> test_active{false};       //< Тест идёт
+    std::atomic<bool> stop_requested{false};    //< Запрошена остановка теста
+    std::thread runner;                         //< Фоновый поток startTest
+    SnapshotBuffer snapshot_buffer;             //< Последний снимок метрик
+    SnapshotCallback snapshot_callback;         //< Обработчик снимков
+    std::chrono::milliseconds snapshot_interval{1000}; //< Период вызова обработчика
 
     TestDataConfig data_config;                 //< Конфигурация тестовых данных
-    std::random_device rd;                      //< Генератор случайных чисел
-    std::mt19937 gen;                           //< Генератор Mersenne Twister
+    BodyTemplate body_template;                 //< Скомпилированное тело запроса
+    std::string body_template_source;           //< JSON-шаблон тела (пусто - тело из полей)
+    DataPools data_pools;                       //< Таблицы данных для генераторов pool
+    uint64_t seed = 0;                          //< Зерно генераторов потоков
+    bool has_seed = false;                      //< Зерно задано явно
 
     std::vector<ResponseCheckConfig> response_checks; //< Конфигурация проверок ответа
+    ResponseMatcher response_matcher;           //< Скомпилированные проверки ответа
+
+    std::vector<ScenarioConfig> scenario_configs; //< Сценарии смеси
+    std::vector<std::unique_ptr<Scenario>> scenarios; //< Сценарии, подготовленные к тесту
+    AliasSampler scenario_sampler;              //< Выбор сценария по весам
+    std::mutex scenarios_mutex;                 //< Сборка сценариев и одиночные запросы вне теста
+
+    std::unique_ptr<ReplaySource> replay;       //< Записанные запросы (nullptr - без воспроизведения)
+    double replay_speed = 1.0;                  //< Ускорение воспроизведения
+    bool replay_pacing = true;                  //< Отправлять в моменты из записи
+    size_t replay_part = 0;                     //< Доля записи этого процесса (распределённый тест)
+    size_t replay_parts = 1;
+    size_t agent_part = 0;                      //< Номер агента распределённого теста (seq без повторов)
+    size_t agent_parts = 1;                     //< Всего агентов
+
+    /// @brief Выводит пропускную способность каждого рабочего потока
+    void printWorkerSummary() const;
+
+    /// @brief Проводит тест; test_active выставляет и снимает вызывающий (runTest, startTest)
+    /// @return false, если тест не начался (ошибка в сценариях)
+    bool executeTest(int num_threads, int duration_seconds, int requests_per_second);
 
     /// @brief Выводит информацию о настройках теста
+    /// @param duration_seconds Длительность теста (0 - поиск предела: длительность и темп задают ступени)
     void printTestHeader(int num_threads, int duration_seconds, int requests_per_second) const;
 
     /// @brief Callback-функция для записи ответа от сервера
     static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* response);
 
-    /// @brief Генерирует значение для поля
-    std::string generateFieldValue(const FieldConfig& config);
+    /// @brief Готовит сценарии к тесту (без сценариев - один из target_url и настроек полей)
+    void buildScenarios();
+
+    /// @brief Настраивает хэндл слота под сценарий
+    static void applyScenario(RequestSlot& slot, const Scenario& scenario);
+
+    /// @brief Выставляет метод HTTP хэндла
+    static void applyMethod(CURL* curl, const std::string& method);
+
+    /// @brief Выдаёт запланированный момент и (при воспроизведении) запись очередного запроса
+    /// @param[out] intended Момент отправки; пустой - отправлять сразу
+    /// @return false, если запросов больше не будет
+    bool nextArrival(WorkerContext& ctx, ArrivalScheduler* scheduler,
+                     std::chrono::steady_clock::time_point start_time,
+                     ReplayRecord& record, std::chrono::steady_clock::time_point& intended);
+
+    /// @brief Настраивает постоянные опции CURL для контекста потока
+    void prepareWorker(WorkerContext& ctx) const;
+
+    /// @brief Готовит слот к отправке очередного запроса
+    void beginRequest(WorkerContext& ctx, RequestSlot& slot, int request_id,
+                      std::chrono::steady_clock::time_point intended_time,
+                      const ReplayRecord* record = nullptr);
+
+    /// @brief Обрабатывает завершённый запрос и обновляет статистику
+    bool finishRequest(WorkerContext& ctx, RequestSlot& slot, int res);
+
+    /// @brief Создаёт и настраивает контексты рабочих потоков
+    void createWorkers(int num_threads);
+
+    /// @brief Запускает рабочие потоки на заданное время и дожидается их
+    /// @param with_metrics Запустить поток метрик (снимки, прогресс, временной ряд)
+    /// @return Стенное время прогона, с
+    double runWorkers(int duration_seconds, ArrivalScheduler* scheduler, bool with_metrics);
+
+    /// @brief Поток метрик: публикует снимки, вызывает обработчик и выводит прогресс
+    void runMetrics(std::chrono::steady_clock::time_point start_time, int duration_seconds,
+                    const std::atomic<bool>& workers_done);
+
+    /// @brief Записывает строку временного ряда за интервал [from, to]
+    void writeTimeSeriesRow(std::chrono::steady_clock::time_point from,
+                            const CounterTotals& from_totals, const LatencyHistogram& from_latency,
+                            std::chrono::steady_clock::time_point to,
+                            const CounterTotals& to_totals, const LatencyHistogram& to_latency,
+                            std::chrono::steady_clock::time_point start_time);
+
+    /// @brief Обнуляет статистику потоков (после разогрева)
+    void resetWorkerStats();
 
-    /// @brief Генерирует тестовые данные для запроса
-    nlohmann::json generateTestData();
+    /// @brief Событийный цикл curl_multi для одного потока
+    void runEventLoop(WorkerContext& ctx, std::chrono::steady_clock::time_point start_time,
+                      int duration_seconds, ArrivalScheduler* scheduler);
 
-    /// @brief Проверяет успешность ответа от сервера
-    bool checkResponseSuccess(const std::string& response_json);
+    /// @brief Проверяет заголовки, размер и поля ответа с допустимым кодом HTTP
+    bool checkResponseSuccess(const RequestSlot& slot) const;
 };
 
 #endif // LOAD_TESTER_HPP
\ No newline at end of file
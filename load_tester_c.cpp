@@ -3,7 +3,12 @@
 
 #include "load_tester_c.h"
 #include "load_tester.hpp"
+#include "distributed.hpp"
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,10 +41,15 @@ void set_target_url(LoadTesterPtr tester, const char* url) {
     t->setTargetUrl(std::string(url));
 }
 
-void set_test_data_config(LoadTesterPtr tester, TestDataConfigPtr config) {
+int set_test_data_config(LoadTesterPtr tester, TestDataConfigPtr config) {
     LoadTester* t = static_cast<LoadTester*>(tester);
     TestDataConfig* c = static_cast<TestDataConfig*>(config);
-    t->setTestDataConfig(*c);
+    try {
+        t->setTestDataConfig(*c);
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
 }
 
 void add_field_to_config(TestDataConfigPtr config, const char* field_name, 
@@ -53,6 +63,53 @@ void add_field_to_config(TestDataConfigPtr config, const char* field_name,
     (*c)[std::string(field_name)] = field_config;
 }
 
+int add_generated_field(TestDataConfigPtr config, const char* field_name, const char* generator) {
+    TestDataConfig* c = static_cast<TestDataConfig*>(config);
+    if (!field_name || !generator) {
+        return -1;
+    }
+    // Таблицы pool известны только тестеру - их проверяет set_test_data_config
+    const std::string spec = generator;
+    if (spec != "pool" && spec.compare(0, 5, "pool:") != 0) {
+        try {
+            FieldGenerator parsed;
+            std::shared_ptr<const DataPool> pool_ref;
+            if (!FieldGenerator::parse(spec, {}, parsed, pool_ref)) {
+                return -1;
+            }
+        } catch (const std::exception&) {
+            return -1;
+        }
+    }
+    FieldConfig field_config;
+    field_config.generator = spec;
+    (*c)[std::string(field_name)] = field_config;
+    return 0;
+}
+
+int set_body_template(LoadTesterPtr tester, const char* json_template) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    try {
+        t->setBodyTemplate(json_template ? std::string(json_template) : "{}");
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int add_data_pool(LoadTesterPtr tester, const char* name, const char* csv_path) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    if (!name || !csv_path) {
+        return -1;
+    }
+    try {
+        t->addDataPool(name, csv_path);
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
 void add_response_check(LoadTesterPtr tester, const char* field_path, 
                        const char* expected_value, int check_exists) {
     LoadTester* t = static_cast<LoadTester*>(tester);
@@ -66,9 +123,344 @@ void clear_response_checks(LoadTesterPtr tester) {
     t->clearResponseChecks();
 }
 
-void run_test(LoadTesterPtr tester, int num_threads, int duration_seconds, int requests_per_second) {
+void add_status_check(LoadTesterPtr tester, long status) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->addStatusCheck(status);
+}
+
+void add_header_check(LoadTesterPtr tester, const char* name, const char* expected_value) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->addHeaderCheck(std::string(name), expected_value ? std::string(expected_value) : "");
+}
+
+void set_body_size_limits(LoadTesterPtr tester, unsigned long min_bytes, unsigned long max_bytes) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->setBodySizeLimits(min_bytes, max_bytes);
+}
+
+int set_log_file(LoadTesterPtr tester, const char* path) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    return t->setLogFile(path ? std::string(path) : "") ? 0 : -1;
+}
+
+void set_log_callback(LoadTesterPtr tester, LogCallbackFn callback, void* user_data) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    if (!callback) {
+        t->setLogCallback(nullptr);
+        return;
+    }
+    t->setLogCallback([callback, user_data](const LogRecord& record, const std::string& line) {
+        callback(static_cast<int>(record.kind), line.c_str(), user_data);
+    });
+}
+
+void set_log_rate_limit(LoadTesterPtr tester, int lines_per_second) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->setLogRateLimit(lines_per_second);
+}
+
+void set_seed(LoadTesterPtr tester, unsigned long long seed) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->setSeed(seed);
+}
+
+void set_keep_alive(LoadTesterPtr tester, int enabled) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->setKeepAlive(enabled != 0);
+}
+
+void set_arrival_process(LoadTesterPtr tester, int poisson) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->setArrivalProcess(poisson != 0 ? ArrivalProcess::Poisson : ArrivalProcess::Uniform);
+}
+
+void add_rate_ramp(LoadTesterPtr tester, double start_rps, double end_rps, double seconds) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->addRateSegment({seconds, start_rps, end_rps});
+}
+
+void add_rate_step(LoadTesterPtr tester, double rps, double seconds) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->addRateSegment({seconds, rps, rps});
+}
+
+void clear_rate_profile(LoadTesterPtr tester) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->clearRateProfile();
+}
+
+void set_histogram_export_path(LoadTesterPtr tester, const char* path) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->setHistogramExportPath(path ? std::string(path) : "");
+}
+
+void set_timeseries_path(LoadTesterPtr tester, const char* path) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->setTimeSeriesPath(path ? std::string(path) : "");
+}
+
+void set_trace_path(LoadTesterPtr tester, const char* path) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->setTracePath(path ? std::string(path) : "");
+}
+
+int add_scenario(LoadTesterPtr tester, const char* name, const char* url, const char* method,
+                 const char* body_template, double weight) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    ScenarioConfig scenario;
+    scenario.name = name ? name : "";
+    scenario.url = url ? url : "";
+    if (method && *method) {
+        scenario.method = method;
+    }
+    scenario.body_template = body_template ? body_template : "";
+    scenario.weight = weight;
+    try {
+        return t->addScenario(scenario);
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int add_scenario_header(LoadTesterPtr tester, int scenario, const char* header) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    if (!header) {
+        return -1;
+    }
+    try {
+        t->scenarioConfig(scenario).headers.push_back(std::string(header));
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int add_scenario_check(LoadTesterPtr tester, int scenario, const char* field_path,
+                       const char* expected_value, int check_exists) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    if (!field_path) {
+        return -1;
+    }
+    ResponseCheckConfig check;
+    check.field_path = field_path;
+    check.expected_value = expected_value ? std::string(expected_value) : "";
+    check.check_exists = check_exists != 0;
+    try {
+        t->scenarioConfig(scenario).checks.push_back(check);
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int add_scenario_status(LoadTesterPtr tester, int scenario, long status) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    try {
+        t->scenarioConfig(scenario).accepted_statuses.push_back(status);
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+void clear_scenarios(LoadTesterPtr tester) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->clearScenarios();
+}
+
+int set_replay_file(LoadTesterPtr tester, const char* path, double speed, int pacing, int loop) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    try {
+        t->setReplayFile(path ? std::string(path) : "", speed, pacing != 0, loop != 0);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Replay: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+void clear_replay(LoadTesterPtr tester) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->clearReplay();
+}
+
+int run_distributed(LoadTesterPtr tester, const char* agents, const char* agent_path,
+                    int threads_per_agent, int duration_seconds, int requests_per_second) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    LoadCoordinator coordinator;
+    std::stringstream list(agents ? agents : "");
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        size_t colon = item.rfind(':');
+        if (colon == std::string::npos) {
+            std::cerr << "Bad agent address: " << item << std::endl;
+            return -1;
+        }
+        std::string host = item.substr(0, colon);
+        int value = std::atoi(item.c_str() + colon + 1);
+        if (host == "local") {
+            if (!coordinator.spawnLocalAgents(value, agent_path ? agent_path : "./load_agent")) {
+                return -1;
+            }
+        } else {
+            coordinator.addAgent(host, value);
+        }
+    }
+
+    bool ok = coordinator.run(t->exportPlan(), threads_per_agent, duration_seconds, requests_per_second);
+    coordinator.printResults();
+    return ok ? 0 : -1;
+}
+
+int run_test(LoadTesterPtr tester, int num_threads, int duration_seconds, int requests_per_second) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    // Блокирующая модель - только на время теста: настройка set_engine сохраняется
+    const bool completed = t->runTest(num_threads, duration_seconds, requests_per_second,
+                                      EngineMode::Blocking, 0);
+    return completed ? 0 : -1;
+}
+
+int run_test_multi(LoadTesterPtr tester, int num_loops, int max_in_flight,
+                   int duration_seconds, int requests_per_second) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    const bool completed = t->runTest(num_loops, duration_seconds, requests_per_second,
+                                      EngineMode::Multi, max_in_flight);
+    return completed ? 0 : -1;
+}
+
+/// @brief Переносит снимок метрик в C-структуру
+static void toCSnapshot(const MetricsSnapshot& in, LoadTestSnapshot* out) {
+    out->running = static_cast<int>(in.running);
+    out->elapsed_seconds = in.elapsed_seconds;
+    out->requests_started = in.requests_started;
+    out->requests_sent = in.requests_sent;
+    out->requests_failed = in.requests_failed;
+    out->success_responses = in.success_responses;
+    out->error_responses = in.error_responses;
+    out->http_errors = in.http_errors;
+    out->transport_errors = in.transport_errors;
+    out->in_flight = in.in_flight;
+    out->interval_rps = in.interval_rps;
+    out->cumulative_rps = in.cumulative_rps;
+    out->interval_p50_ms = in.interval_p50_ms;
+    out->interval_p99_ms = in.interval_p99_ms;
+    out->mean_ms = in.mean_ms;
+    out->p50_ms = in.p50_ms;
+    out->p90_ms = in.p90_ms;
+    out->p99_ms = in.p99_ms;
+    out->p999_ms = in.p999_ms;
+    out->max_ms = in.max_ms;
+    static_assert(kRequestPhaseCount == sizeof(out->phase_p50_ms) / sizeof(double), "phase count mismatch");
+    for (size_t i = 0; i < kRequestPhaseCount; ++i) {
+        out->phase_p50_ms[i] = in.phase_p50_ms[i];
+        out->phase_p99_ms[i] = in.phase_p99_ms[i];
+    }
+}
+
+int set_engine(LoadTesterPtr tester, int use_multi, int max_in_flight) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    return t->setEngineMode(use_multi != 0 ? EngineMode::Multi : EngineMode::Blocking, max_in_flight) ? 0 : -1;
+}
+
+int set_protocol(LoadTesterPtr tester, const char* protocol, int max_connections, int max_streams) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    const std::string name = protocol ? protocol : "";
+    if (name == "http1.1") {
+        t->setProtocol(HttpProtocol::Http1, max_connections, max_streams);
+    } else if (name == "http2") {
+        t->setProtocol(HttpProtocol::Http2, max_connections, max_streams);
+    } else if (name == "h2c") {
+        t->setProtocol(HttpProtocol::Http2PriorKnowledge, max_connections, max_streams);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+int set_cpu_affinity(LoadTesterPtr tester, const char* worker_cpus, const char* reporter_cpus) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    std::vector<int> workers;
+    std::vector<int> reporter;
+    if (!parseCpuList(worker_cpus ? worker_cpus : "", workers) ||
+        !parseCpuList(reporter_cpus ? reporter_cpus : "", reporter)) {
+        return -1;
+    }
+    t->setCpuAffinity(workers, reporter);
+    return 0;
+}
+
+double find_max_throughput(LoadTesterPtr tester, int num_threads, double start_rps, double max_rps,
+                           int step_seconds, double p99_ms, double max_error_rate,
+                           const char* curve_path) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    CapacitySearchConfig config;
+    config.start_rps = start_rps;
+    config.max_rps = max_rps;
+    config.step_seconds = step_seconds;
+    config.p99_ms = p99_ms;
+    config.max_error_rate = max_error_rate;
+    config.curve_path = curve_path ? curve_path : "";
+    const CapacitySearchResult result = t->findMaxThroughput(num_threads, config);
+    return result.rejected ? -1 : result.max_rps;
+}
+
+int start_test(LoadTesterPtr tester, int num_threads, int duration_seconds,
+               int requests_per_second) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    return t->startTest(num_threads, duration_seconds, requests_per_second) ? 0 : -1;
+}
+
+void request_stop(LoadTesterPtr tester) {
+    static_cast<LoadTester*>(tester)->requestStop();
+}
+
+void set_warmup(LoadTesterPtr tester, int seconds) {
+    static_cast<LoadTester*>(tester)->setWarmup(seconds);
+}
+
+void set_drain_timeout(LoadTesterPtr tester, double seconds) {
+    static_cast<LoadTester*>(tester)->setDrainTimeout(seconds);
+}
+
+void stop_test(LoadTesterPtr tester) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    t->stopTest();
+}
+
+int is_test_running(LoadTesterPtr tester) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    return t->isRunning() ? 1 : 0;
+}
+
+void get_snapshot(LoadTesterPtr tester, LoadTestSnapshot* out) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    if (out) {
+        toCSnapshot(t->snapshot(), out);
+    }
+}
+
+int save_results_json(LoadTesterPtr tester, const char* path) {
+    LoadTester* t = static_cast<LoadTester*>(tester);
+    if (!path || !*path) {
+        return -1;
+    }
+    std::ofstream out(path);
+    out << t->resultsJson().dump(2) << std::endl;
+    return out ? 0 : -1;
+}
+
+void set_snapshot_callback(LoadTesterPtr tester, SnapshotCallbackFn callback,
+                           void* user_data, int interval_ms) {
     LoadTester* t = static_cast<LoadTester*>(tester);
-    t->runTest(num_threads, duration_seconds, requests_per_second);
+    if (!callback) {
+        t->setSnapshotCallback(nullptr);
+        return;
+    }
+    t->setSnapshotCallback([callback, user_data](const MetricsSnapshot& snapshot) {
+        LoadTestSnapshot c_snapshot;
+        toCSnapshot(snapshot, &c_snapshot);
+        callback(&c_snapshot, user_data);
+    }, interval_ms);
 }
 
 #ifdef __cplusplus
@@ -17,6 +17,47 @@ typedef void* FieldConfigPtr;
 // Тип указателя на TestDataConfig  
 typedef void* TestDataConfigPtr;
 
+// Обработчик строк журнала событий: вид события (0 - успех, 1 - не прошёл проверки,
+// 2 - ошибка HTTP, 3 - ошибка CURL, 4 - исключение), строка, пользовательские данные
+typedef void (*LogCallbackFn)(int kind, const char* line, void* user_data);
+
+/// @brief Снимок метрик идущего теста
+/// @details Интервальные значения - за последнюю секунду, накопительные - с начала теста.
+/// Задержки в миллисекундах, считаются от запланированного момента отправки
+typedef struct LoadTestSnapshot {
+    int running;                    //< 1, пока тест идёт
+    double elapsed_seconds;         //< Время с начала теста
+
+    long long requests_started;     //< Отправлено запросов
+    long long requests_sent;        //< Ответов с допустимым кодом HTTP
+    long long requests_failed;      //< Неудачных запросов (всего)
+    long long success_responses;    //< Ответов, прошедших проверки
+    long long error_responses;      //< Ответов, не прошедших проверки
+    long long http_errors;          //< Ответов с недопустимым кодом HTTP
+    long long transport_errors;     //< Ошибок CURL (соединение, таймаут)
+    long long in_flight;            //< Запросов в полёте
+
+    double interval_rps;            //< Завершённых запросов в секунду за последнюю секунду
+    double cumulative_rps;          //< Завершённых запросов в секунду с начала теста
+
+    double interval_p50_ms;
+    double interval_p99_ms;
+    double mean_ms;
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double p999_ms;
+    double max_ms;
+
+    // Фазы запроса за последнюю секунду (тайминги CURL):
+    // 0 - dns, 1 - connect, 2 - tls, 3 - ttfb, 4 - transfer
+    double phase_p50_ms[5];
+    double phase_p99_ms[5];
+} LoadTestSnapshot;
+
+// Обработчик снимков метрик (вызывается из потока метрик библиотеки)
+typedef void (*SnapshotCallbackFn)(const LoadTestSnapshot* snapshot, void* user_data);
+
 // === Создание и уничтожение объектов ===
 
 /// @brief Создает новый экземпляр LoadTester
@@ -50,7 +91,8 @@ void set_target_url(LoadTesterPtr tester, const char* url);
 /// @brief Устанавливает конфигурацию тестовых данных
 /// @param tester Указатель на LoadTester
 /// @param config Указатель на TestDataConfig
-void set_test_data_config(LoadTesterPtr tester, TestDataConfigPtr config);
+/// @return 0 при успехе, -1 при ошибке в описании генератора поля
+int set_test_data_config(LoadTesterPtr tester, TestDataConfigPtr config);
 
 /// @brief Добавляет поле в конфигурацию тестовых данных
 /// @param config Указатель на TestDataConfig
@@ -62,9 +104,32 @@ void set_test_data_config(LoadTesterPtr tester, TestDataConfigPtr config);
 void add_field_to_config(TestDataConfigPtr config, const char* field_name, 
                         const char* value, int is_random, int min_val, int max_val);
 
+/// @brief Добавляет в конфигурацию поле со значением от генератора
+/// @param config Указатель на TestDataConfig
+/// @param field_name Имя поля (или JSON Pointer)
+/// @param generator Описание генератора: "int:1:100", "seq:1", "uuid4", "uuid7", "timestamp:iso",
+///                  "string:16", "zipf:100000:1.1", "gauss:500:100:0:1000", "pool:users:email"
+/// @return 0 при успехе, -1 при неизвестном генераторе или ошибке в аргументах
+/// (таблицу pool проверяет set_test_data_config)
+int add_generated_field(TestDataConfigPtr config, const char* field_name, const char* generator);
+
+/// @brief Задаёт тело запроса JSON-шаблоном (вложенные объекты и массивы)
+/// @param tester Указатель на LoadTester
+/// @param json_template JSON; строки "{{random}}" / "{{random:MIN:MAX}}" заменяются случайными числами,
+///                      "{{SPEC}}" - значениями генератора SPEC (как в add_generated_field)
+/// @return 0 при успехе, -1 при некорректном JSON или генераторе
+int set_body_template(LoadTesterPtr tester, const char* json_template);
+
+/// @brief Загружает таблицу данных из CSV (первая строка - имена столбцов)
+/// @param tester Указатель на LoadTester
+/// @param name Имя таблицы в генераторах "pool:NAME:COLUMN"
+/// @param csv_path Путь к файлу
+/// @return 0 при успехе, -1 если файл не читается или пуст
+int add_data_pool(LoadTesterPtr tester, const char* name, const char* csv_path);
+
 /// @brief Добавляет проверку ответа
 /// @param tester Указатель на LoadTester
-/// @param field_path Путь к полю в JSON
+/// @param field_path Путь к полю в JSON ("success", "data.status", "items[0].id")
 /// @param expected_value Ожидаемое значение
 /// @param check_exists Проверять существование (0=false, 1=true)
 void add_response_check(LoadTesterPtr tester, const char* field_path, 
@@ -74,15 +139,271 @@ void add_response_check(LoadTesterPtr tester, const char* field_path,
 /// @param tester Указатель на LoadTester
 void clear_response_checks(LoadTesterPtr tester);
 
+/// @brief Добавляет допустимый код HTTP ответа (без вызовов допустим только 200)
+/// @param tester Указатель на LoadTester
+/// @param status Код HTTP
+void add_status_check(LoadTesterPtr tester, long status);
+
+/// @brief Добавляет проверку заголовка ответа
+/// @param tester Указатель на LoadTester
+/// @param name Имя заголовка
+/// @param expected_value Ожидаемое значение (NULL или "" - только наличие)
+void add_header_check(LoadTesterPtr tester, const char* name, const char* expected_value);
+
+/// @brief Ограничивает размер тела ответа
+/// @param tester Указатель на LoadTester
+/// @param min_bytes Минимальный размер в байтах
+/// @param max_bytes Максимальный размер в байтах (0 = без ограничения)
+void set_body_size_limits(LoadTesterPtr tester, unsigned long min_bytes, unsigned long max_bytes);
+
+/// @brief Задаёт зерно генераторов случайных значений (воспроизводимые данные запросов)
+/// @param tester Указатель на LoadTester
+/// @param seed Зерно
+void set_seed(LoadTesterPtr tester, unsigned long long seed);
+
+/// @brief Устанавливает режим соединений
+/// @param tester Указатель на LoadTester
+/// @param enabled 1 = keep-alive (переиспользование), 0 = новое соединение на каждый запрос
+void set_keep_alive(LoadTesterPtr tester, int enabled);
+
+/// @brief Задаёт распределение моментов прибытия запросов
+/// @param tester Указатель на LoadTester
+/// @param poisson 1 = пуассоновский поток, 0 = равномерные интервалы
+void set_arrival_process(LoadTesterPtr tester, int poisson);
+
+/// @brief Добавляет в профиль участок линейного изменения интенсивности
+/// @param tester Указатель на LoadTester
+/// @param start_rps Интенсивность в начале участка
+/// @param end_rps Интенсивность в конце участка
+/// @param seconds Длительность участка
+void add_rate_ramp(LoadTesterPtr tester, double start_rps, double end_rps, double seconds);
+
+/// @brief Добавляет в профиль ступень постоянной интенсивности
+/// @param tester Указатель на LoadTester
+/// @param rps Интенсивность ступени
+/// @param seconds Длительность ступени
+void add_rate_step(LoadTesterPtr tester, double rps, double seconds);
+
+/// @brief Сбрасывает профиль интенсивности (используется requests_per_second)
+/// @param tester Указатель на LoadTester
+void clear_rate_profile(LoadTesterPtr tester);
+
+/// @brief Задаёт файл для выгрузки итоговой гистограммы задержек
+/// @param tester Указатель на LoadTester
+/// @param path Путь к CSV-файлу (lower_ns,upper_ns,count); NULL или "" - не выгружать
+void set_histogram_export_path(LoadTesterPtr tester, const char* path);
+
+/// @brief Выводит журнал событий в файл
+/// @param tester Указатель на LoadTester
+/// @param path Путь к файлу (NULL или "" - вывод в консоль)
+/// @return 0 при успехе, -1 если файл не открылся
+int set_log_file(LoadTesterPtr tester, const char* path);
+
+/// @brief Передаёт строки журнала событий в обработчик
+/// @param tester Указатель на LoadTester
+/// @param callback Обработчик (NULL - вывод в консоль); вызывается из фонового потока журнала
+/// @param user_data Передаётся в обработчик без изменений
+void set_log_callback(LoadTesterPtr tester, LogCallbackFn callback, void* user_data);
+
+/// @brief Ограничивает число полных строк журнала в секунду
+/// @param tester Указатель на LoadTester
+/// @param lines_per_second Лимит (0 = без ограничения); повторы выводятся итогом "HTTP 503 ×N"
+void set_log_rate_limit(LoadTesterPtr tester, int lines_per_second);
+
+/// @brief Задаёт файл посекундного временного ряда метрик
+/// @param tester Указатель на LoadTester
+/// @param path Путь к файлу: ".jsonl" - JSON Lines, иначе CSV; NULL или "" - не писать
+void set_timeseries_path(LoadTesterPtr tester, const char* path);
+
+/// @brief Задаёт файл двоичной трассы запросов (запись на каждый запрос)
+/// @param tester Указатель на LoadTester
+/// @param path Путь к файлу (разбирается утилитой trace_analyzer); NULL или "" - не писать
+void set_trace_path(LoadTesterPtr tester, const char* path);
+
+// === Сценарии ===
+
+/// @brief Добавляет сценарий в смесь запросов
+/// @param tester Указатель на LoadTester
+/// @param name Имя сценария в отчёте
+/// @param url Целевой URL
+/// @param method Метод HTTP (NULL - POST)
+/// @param body_template JSON-шаблон тела (NULL или "" - без тела)
+/// @param weight Относительная доля сценария в смеси
+/// @return Индекс сценария или -1, если шаблон тела некорректен или вес отрицателен
+/// @note Пока не добавлен ни один сценарий, тест идёт по target_url и общим настройкам
+int add_scenario(LoadTesterPtr tester, const char* name, const char* url, const char* method,
+                 const char* body_template, double weight);
+
+/// @brief Добавляет заголовок запроса сценария
+/// @param tester Указатель на LoadTester
+/// @param scenario Индекс сценария
+/// @param header Заголовок "Имя: значение"
+/// @return 0 при успехе, -1 при неверном индексе сценария
+int add_scenario_header(LoadTesterPtr tester, int scenario, const char* header);
+
+/// @brief Добавляет проверку поля ответа сценария
+/// @param tester Указатель на LoadTester
+/// @param scenario Индекс сценария
+/// @param field_path Путь к полю
+/// @param expected_value Ожидаемое значение (NULL - проверка только существования)
+/// @param check_exists 1 = проверять существование поля
+/// @return 0 при успехе, -1 при неверном индексе сценария
+int add_scenario_check(LoadTesterPtr tester, int scenario, const char* field_path,
+                       const char* expected_value, int check_exists);
+
+/// @brief Добавляет допустимый код HTTP сценария (первый вызов заменяет код 200 по умолчанию)
+/// @param tester Указатель на LoadTester
+/// @param scenario Индекс сценария
+/// @param status Код HTTP
+/// @return 0 при успехе, -1 при неверном индексе сценария
+int add_scenario_status(LoadTesterPtr tester, int scenario, long status);
+
+/// @brief Удаляет все сценарии (тест снова идёт по target_url)
+/// @param tester Указатель на LoadTester
+void clear_scenarios(LoadTesterPtr tester);
+
+// === Воспроизведение записанных запросов ===
+
+/// @brief Воспроизводит записанные запросы из файла JSONL или HAR
+/// @param tester Указатель на LoadTester
+/// @param path Путь к файлу (отображается в память, в ОЗУ не загружается)
+/// @param speed Ускорение относительно исходного темпа (2.0 - вдвое быстрее)
+/// @param pacing 1 = отправлять в моменты из записи, 0 = по RPS/профилю теста
+/// @param loop 1 = повторять запись по кругу до конца теста
+/// @return 0 при успехе, -1 если файл не открылся или в нём нет моментов отправки при pacing = 1
+int set_replay_file(LoadTesterPtr tester, const char* path, double speed, int pacing, int loop);
+
+/// @brief Отключает воспроизведение
+/// @param tester Указатель на LoadTester
+void clear_replay(LoadTesterPtr tester);
+
+// === Распределённый тест ===
+
+/// @brief Проводит тест на нескольких агентах (load_agent) с настройками tester
+/// @param tester Указатель на LoadTester (источник плана теста)
+/// @param agents Агенты через запятую: "хост:порт" - запущенный агент,
+/// "local:N" - N локальных агентов, запускаемых из agent_path
+/// @param agent_path Путь к load_agent для локальных агентов (NULL - "./load_agent")
+/// @param threads_per_agent Потоков на агента
+/// @param duration_seconds Длительность теста в секундах
+/// @param requests_per_second Общая интенсивность, делится между агентами (0 = максимальная скорость)
+/// @return 0 при успехе, -1 если хотя бы один агент не выполнил тест
+int run_distributed(LoadTesterPtr tester, const char* agents, const char* agent_path,
+                    int threads_per_agent, int duration_seconds, int requests_per_second);
+
 // === Запуск теста ===
 
-/// @brief Запускает нагрузочный тест
+/// @brief Запускает нагрузочный тест на блокирующих потоках
+/// @details Модель и окно, заданные set_engine, после теста остаются прежними
 /// @param tester Указатель на LoadTester
 /// @param num_threads Количество потоков
 /// @param duration_seconds Длительность теста в секундах
 /// @param requests_per_second Запросов в секунду (0 = максимальная скорость)
-void run_test(LoadTesterPtr tester, int num_threads, int duration_seconds, 
-              int requests_per_second);
+/// @return 0 после завершения теста, -1 если уже идёт другой тест или сценарии некорректны
+int run_test(LoadTesterPtr tester, int num_threads, int duration_seconds, 
+             int requests_per_second);
+
+/// @brief Запускает нагрузочный тест на событийных циклах curl_multi
+/// @details Модель и окно, заданные set_engine, после теста остаются прежними
+/// @param tester Указатель на LoadTester
+/// @param num_loops Количество событийных циклов (0 = по числу ядер)
+/// @param max_in_flight Количество запросов в полёте на один цикл
+/// @param duration_seconds Длительность теста в секундах
+/// @param requests_per_second Запросов в секунду (0 = максимальная скорость)
+/// @return 0 после завершения теста, -1 если уже идёт другой тест или сценарии некорректны
+int run_test_multi(LoadTesterPtr tester, int num_loops, int max_in_flight,
+                   int duration_seconds, int requests_per_second);
+
+/// @brief Выбирает модель отправки запросов для start_test
+/// @param tester Указатель на LoadTester
+/// @param use_multi 1 = событийные циклы curl_multi, 0 = блокирующие потоки
+/// @param max_in_flight Количество запросов в полёте на один цикл (для curl_multi)
+/// @return 0 при успехе, -1 если идёт тест (модель не меняется)
+int set_engine(LoadTesterPtr tester, int use_multi, int max_in_flight);
+
+/// @brief Выбирает версию HTTP и ограничения соединений
+/// @param tester Указатель на LoadTester
+/// @param protocol "http1.1", "http2" (ALPN/Upgrade) или "h2c" (HTTP/2 без согласования)
+/// @param max_connections Соединений на событийный цикл (0 = без ограничения)
+/// @param max_streams Одновременных потоков HTTP/2 на соединение
+/// @return 0 при успехе, -1 при неизвестном протоколе
+int set_protocol(LoadTesterPtr tester, const char* protocol, int max_connections, int max_streams);
+
+/// @brief Задаёт размещение потоков теста по ядрам
+/// @param tester Указатель на LoadTester
+/// @param worker_cpus Ядра рабочих потоков, например "2-15,18-31" (NULL или "" - без привязки)
+/// @param reporter_cpus Ядра потоков метрик, журнала и трассы (NULL или "" - все, кроме рабочих)
+/// @return 0 при успехе, -1 при ошибке в списке ядер
+int set_cpu_affinity(LoadTesterPtr tester, const char* worker_cpus, const char* reporter_cpus);
+
+/// @brief Ищет наибольшую интенсивность, при которой выполняется SLO
+/// @param tester Указатель на LoadTester
+/// @param num_threads Количество потоков (циклов для curl_multi, 0 = по числу ядер)
+/// @param start_rps Интенсивность первой ступени; дальше она удваивается до нарушения SLO,
+/// затем граница уточняется делением пополам
+/// @param max_rps Верхняя граница поиска (0 = без границы)
+/// @param step_seconds Длительность ступени в секундах
+/// @param p99_ms Порог p99 задержки в миллисекундах
+/// @param max_error_rate Порог доли ошибок (0..1)
+/// @param curve_path CSV кривой "интенсивность - задержка" (NULL или "" = не писать)
+/// @return Наибольшая интенсивность в рамках SLO (0 - ни одна ступень не уложилась,
+/// -1 - поиск не запущен: идёт другой тест, сценарии некорректны или включено воспроизведение с темпом)
+double find_max_throughput(LoadTesterPtr tester, int num_threads, double start_rps, double max_rps,
+                           int step_seconds, double p99_ms, double max_error_rate,
+                           const char* curve_path);
+
+/// @brief Запускает тест в фоновом потоке и сразу возвращает управление
+/// @param tester Указатель на LoadTester
+/// @param num_threads Количество потоков (циклов для curl_multi)
+/// @param duration_seconds Длительность теста в секундах
+/// @param requests_per_second Запросов в секунду (0 = максимальная скорость)
+/// @return 0 при успехе, -1 если тест уже идёт
+int start_test(LoadTesterPtr tester, int num_threads, int duration_seconds,
+               int requests_per_second);
+
+/// @brief Просит тест остановиться и сразу возвращает управление
+/// @details Только выставляет флаг: подходит для run_test, идущего в другом потоке,
+/// и для обработчика сигнала. Запросы в полёте прерываются и в итоги не входят
+/// @param tester Указатель на LoadTester
+void request_stop(LoadTesterPtr tester);
+
+/// @brief Задаёт разогрев, не входящий в итоги
+/// @param tester Указатель на LoadTester
+/// @param seconds Длительность разогрева в секундах (0 = без разогрева)
+void set_warmup(LoadTesterPtr tester, int seconds);
+
+/// @brief Задаёт время на завершение запросов в полёте после конца теста
+/// @param tester Указатель на LoadTester
+/// @param seconds Секунды; не успевшие запросы прерываются и в итоги не входят
+void set_drain_timeout(LoadTesterPtr tester, double seconds);
+
+/// @brief Останавливает тест и дожидается его завершения (итоги выводятся как обычно)
+/// @param tester Указатель на LoadTester
+void stop_test(LoadTesterPtr tester);
+
+/// @brief Идёт ли тест
+/// @param tester Указатель на LoadTester
+/// @return 1 - идёт, 0 - нет
+int is_test_running(LoadTesterPtr tester);
+
+/// @brief Копирует последний снимок метрик (без блокировок, можно вызывать часто)
+/// @param tester Указатель на LoadTester
+/// @param out Куда записать снимок
+void get_snapshot(LoadTesterPtr tester, LoadTestSnapshot* out);
+
+/// @brief Записывает итоги последнего теста в JSON-файл (формат итогов load_tester_cli)
+/// @param tester Указатель на LoadTester
+/// @param path Путь к файлу
+/// @return 0 при успехе, -1 если файл не записался
+int save_results_json(LoadTesterPtr tester, const char* path);
+
+/// @brief Регистрирует обработчик снимков метрик
+/// @param tester Указатель на LoadTester
+/// @param callback Обработчик (NULL - отключить)
+/// @param user_data Передаётся в обработчик без изменений
+/// @param interval_ms Период вызова в миллисекундах (не меньше 100)
+void set_snapshot_callback(LoadTesterPtr tester, SnapshotCallbackFn callback,
+                           void* user_data, int interval_ms);
 
 #ifdef __cplusplus
 }
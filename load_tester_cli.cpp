@@ -0,0 +1,274 @@
+/// @file load_tester_cli.cpp
+/// @brief Запуск теста из командной строки по JSON-плану: итоги в JSON и сравнение с эталоном
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "load_tester.hpp"
+#include "regression_gate.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+/// @brief Параметры запуска; ключи "run" и "gate" плана, перекрываются опциями
+struct Options {
+    std::string plan_path;
+    int threads = 1;
+    int duration = 0;               //< 0 - по длительности профиля интенсивности
+    int rps = 0;
+    std::string output = "-";       //< Файл итогов в JSON ("-" - stdout)
+    std::string log_path;           //< Журнал событий (пусто - в поток отчёта)
+    std::string baseline_path;      //< Эталонные итоги для сравнения
+    std::string save_baseline_path; //< Куда сохранить итоги как новый эталон
+    GateThresholds gate;            //< Пороги (отрицательные - не проверять)
+    bool quiet = false;             //< Без человекочитаемого отчёта
+    bool dump_plan = false;         //< Вывести итоговый план и выйти
+};
+
+LoadTester* active_tester = nullptr;
+
+void onSignal(int) {
+    if (active_tester) {
+        active_tester->requestStop();
+    }
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " PLAN.json [--threads N] [--duration S] [--rps R]\n"
+              << "       [--output FILE|-] [--log FILE] [--quiet] [--dump-plan]\n"
+              << "       [--baseline FILE] [--save-baseline FILE]\n"
+              << "       [--max-p99-ms MS] [--max-p99-increase PCT] [--max-throughput-drop PCT]\n"
+              << "       [--max-error-rate PCT]" << std::endl;
+}
+
+bool readJson(const std::string& path, json& out) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    try {
+        out = json::parse(file);
+    } catch (const json::exception& e) {
+        std::cerr << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool writeJson(const std::string& path, const json& value) {
+    if (path == "-") {
+        std::cout << value.dump(2) << std::endl;
+        return true;
+    }
+    std::ofstream file(path);
+    file << value.dump(2) << std::endl;
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/// @brief Заполняет параметры из ключей "run" и "gate" плана
+void optionsFromPlan(const json& plan, Options& options) {
+    if (plan.contains("run")) {
+        const json& run = plan["run"];
+        options.threads = run.value("threads", options.threads);
+        options.duration = run.value("duration", options.duration);
+        options.rps = run.value("rps", options.rps);
+    }
+    if (options.duration == 0 && plan.contains("rate_profile")) {
+        double total = 0;
+        for (const auto& segment : plan["rate_profile"]) {
+            total += segment.value("duration", 0.0);
+        }
+        options.duration = static_cast<int>(total + 0.999);
+    }
+    if (plan.contains("gate")) {
+        const json& gate = plan["gate"];
+        options.baseline_path = gate.value("baseline", options.baseline_path);
+        options.gate.max_p99_ms = gate.value("max_p99_ms", options.gate.max_p99_ms);
+        options.gate.max_p99_increase = gate.value("max_p99_increase_pct", options.gate.max_p99_increase);
+        options.gate.max_throughput_drop = gate.value("max_throughput_drop_pct", options.gate.max_throughput_drop);
+        options.gate.max_error_rate = gate.value("max_error_rate_pct", options.gate.max_error_rate);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // Опции командной строки перекрывают "run" и "gate" плана; -1 и пустая строка - не заданы
+    Options cli;
+    cli.threads = -1;
+    cli.duration = -1;
+    cli.rps = -1;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "--threads") == 0 && has_value) {
+            cli.threads = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--duration") == 0 && has_value) {
+            cli.duration = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--rps") == 0 && has_value) {
+            cli.rps = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--output") == 0 && has_value) {
+            cli.output = argv[++i];
+        } else if (std::strcmp(arg, "--log") == 0 && has_value) {
+            cli.log_path = argv[++i];
+        } else if (std::strcmp(arg, "--baseline") == 0 && has_value) {
+            cli.baseline_path = argv[++i];
+        } else if (std::strcmp(arg, "--save-baseline") == 0 && has_value) {
+            cli.save_baseline_path = argv[++i];
+        } else if (std::strcmp(arg, "--max-p99-ms") == 0 && has_value) {
+            cli.gate.max_p99_ms = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--max-p99-increase") == 0 && has_value) {
+            cli.gate.max_p99_increase = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--max-throughput-drop") == 0 && has_value) {
+            cli.gate.max_throughput_drop = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--max-error-rate") == 0 && has_value) {
+            cli.gate.max_error_rate = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--quiet") == 0) {
+            cli.quiet = true;
+        } else if (std::strcmp(arg, "--dump-plan") == 0) {
+            cli.dump_plan = true;
+        } else if (arg[0] != '-' && cli.plan_path.empty()) {
+            cli.plan_path = arg;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (cli.plan_path.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    json plan;
+    if (!readJson(cli.plan_path, plan)) {
+        return 2;
+    }
+    Options options;
+    optionsFromPlan(plan, options);
+    options.output = cli.output;
+    options.log_path = cli.log_path;
+    options.save_baseline_path = cli.save_baseline_path;
+    options.quiet = cli.quiet;
+    options.dump_plan = cli.dump_plan;
+    if (cli.threads >= 0) {
+        options.threads = cli.threads;
+    }
+    if (cli.duration >= 0) {
+        options.duration = cli.duration;
+    }
+    if (cli.rps >= 0) {
+        options.rps = cli.rps;
+    }
+    if (!cli.baseline_path.empty()) {
+        options.baseline_path = cli.baseline_path;
+    }
+    if (cli.gate.max_p99_ms >= 0) {
+        options.gate.max_p99_ms = cli.gate.max_p99_ms;
+    }
+    if (cli.gate.max_p99_increase >= 0) {
+        options.gate.max_p99_increase = cli.gate.max_p99_increase;
+    }
+    if (cli.gate.max_throughput_drop >= 0) {
+        options.gate.max_throughput_drop = cli.gate.max_throughput_drop;
+    }
+    if (cli.gate.max_error_rate >= 0) {
+        options.gate.max_error_rate = cli.gate.max_error_rate;
+    }
+
+    LoadTester tester;
+    try {
+        tester.applyPlan(plan);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid plan " << cli.plan_path << ": " << e.what() << std::endl;
+        return 2;
+    }
+    if (options.dump_plan) {
+        json effective = tester.exportPlan();
+        effective["run"] = {{"threads", options.threads}, {"duration", options.duration}, {"rps", options.rps}};
+        std::cout << effective.dump(2) << std::endl;
+        return 0;
+    }
+    if (options.duration <= 0) {
+        std::cerr << "Test duration is not set: use --duration or \"run\": {\"duration\": S} in the plan" << std::endl;
+        return 2;
+    }
+
+    json baseline;
+    if (!options.baseline_path.empty() && !readJson(options.baseline_path, baseline)) {
+        return 2;
+    }
+
+    // stdout отдан под JSON - человекочитаемый отчёт и журнал уходят в stderr
+    std::ostream* report = options.quiet ? nullptr : (options.output == "-" ? &std::cerr : &std::cout);
+    std::streambuf* saved_cout = std::cout.rdbuf(report ? report->rdbuf() : nullptr);
+    if (!options.log_path.empty()) {
+        if (!tester.setLogFile(options.log_path)) {
+            std::cerr << "Cannot open log file " << options.log_path << std::endl;
+            std::cout.rdbuf(saved_cout);
+            return 2;
+        }
+    } else if (report != &std::cout) {
+        tester.setLogCallback([report](const LogRecord&, const std::string& line) {
+            if (report) {
+                *report << line << '\n';
+            }
+        });
+    }
+
+    active_tester = &tester;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    const bool ran = tester.runTest(options.threads, options.duration, options.rps);
+    active_tester = nullptr;
+    std::cout.rdbuf(saved_cout);
+    if (!ran) {
+        std::cerr << "Test did not run" << std::endl;
+        return 2;
+    }
+
+    json results = tester.resultsJson();
+    results["plan"] = cli.plan_path;
+    const std::vector<GateCheck> checks = checkGates(results, baseline.is_null() ? nullptr : &baseline, options.gate);
+    bool passed = true;
+    json gate = json::array();
+    for (const auto& check : checks) {
+        gate.push_back({{"name", check.name}, {"baseline", check.baseline}, {"current", check.current},
+                        {"limit", check.limit}, {"passed", check.passed}});
+        passed = passed && check.passed;
+    }
+    if (!checks.empty()) {
+        results["gate"] = {{"passed", passed}, {"baseline", options.baseline_path}, {"checks", gate}};
+    }
+
+    bool written = writeJson(options.output, results);
+    if (!options.save_baseline_path.empty()) {
+        json stored = results;
+        stored.erase("gate");
+        written = writeJson(options.save_baseline_path, stored) && written;
+    }
+
+    for (const auto& check : checks) {
+        if (!check.passed) {
+            std::cerr << "Regression: " << check.name << " " << check.current << " (baseline "
+                      << check.baseline << ", limit " << check.limit << ")" << std::endl;
+        }
+    }
+    if (!written) {
+        return 2;
+    }
+    return passed ? 0 : 1;
+}
@@ -27,9 +27,97 @@ lib.destroy_tester.argtypes = [ctypes.c_void_p]
 lib.destroy_test_data_config.argtypes = [ctypes.c_void_p]
 lib.set_target_url.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
 lib.set_test_data_config.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+lib.set_test_data_config.restype = ctypes.c_int
 lib.add_field_to_config.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+lib.add_generated_field.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]
+lib.add_generated_field.restype = ctypes.c_int
+lib.set_body_template.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+lib.set_body_template.restype = ctypes.c_int
+lib.add_data_pool.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]
+lib.add_data_pool.restype = ctypes.c_int
 lib.add_response_check.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int]
+lib.add_status_check.argtypes = [ctypes.c_void_p, ctypes.c_long]
+lib.add_header_check.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]
+lib.set_body_size_limits.argtypes = [ctypes.c_void_p, ctypes.c_ulong, ctypes.c_ulong]
+lib.set_seed.argtypes = [ctypes.c_void_p, ctypes.c_ulonglong]
+lib.set_keep_alive.argtypes = [ctypes.c_void_p, ctypes.c_int]
+lib.set_arrival_process.argtypes = [ctypes.c_void_p, ctypes.c_int]
+lib.add_rate_ramp.argtypes = [ctypes.c_void_p, ctypes.c_double, ctypes.c_double, ctypes.c_double]
+lib.add_rate_step.argtypes = [ctypes.c_void_p, ctypes.c_double, ctypes.c_double]
+lib.clear_rate_profile.argtypes = [ctypes.c_void_p]
+lib.set_log_file.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+LOG_CALLBACK = ctypes.CFUNCTYPE(None, ctypes.c_int, ctypes.c_char_p, ctypes.c_void_p)
+lib.set_log_callback.argtypes = [ctypes.c_void_p, LOG_CALLBACK, ctypes.c_void_p]
+lib.set_log_rate_limit.argtypes = [ctypes.c_void_p, ctypes.c_int]
+lib.set_timeseries_path.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+lib.set_trace_path.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+lib.add_scenario.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_double]
+lib.add_scenario.restype = ctypes.c_int
+lib.add_scenario_header.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_char_p]
+lib.add_scenario_header.restype = ctypes.c_int
+lib.add_scenario_check.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int]
+lib.add_scenario_check.restype = ctypes.c_int
+lib.add_scenario_status.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_long]
+lib.add_scenario_status.restype = ctypes.c_int
+lib.clear_scenarios.argtypes = [ctypes.c_void_p]
+lib.set_replay_file.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_double, ctypes.c_int, ctypes.c_int]
+lib.set_replay_file.restype = ctypes.c_int
+lib.clear_replay.argtypes = [ctypes.c_void_p]
+lib.run_distributed.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+lib.run_distributed.restype = ctypes.c_int
+lib.set_histogram_export_path.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
 lib.run_test.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+lib.run_test.restype = ctypes.c_int
+lib.run_test_multi.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+lib.run_test_multi.restype = ctypes.c_int
+
+class LoadTestSnapshot(ctypes.Structure):
+    """Снимок метрик (struct LoadTestSnapshot из load_tester_c.h)"""
+    _fields_ = [
+        ("running", ctypes.c_int),
+        ("elapsed_seconds", ctypes.c_double),
+        ("requests_started", ctypes.c_longlong),
+        ("requests_sent", ctypes.c_longlong),
+        ("requests_failed", ctypes.c_longlong),
+        ("success_responses", ctypes.c_longlong),
+        ("error_responses", ctypes.c_longlong),
+        ("http_errors", ctypes.c_longlong),
+        ("transport_errors", ctypes.c_longlong),
+        ("in_flight", ctypes.c_longlong),
+        ("interval_rps", ctypes.c_double),
+        ("cumulative_rps", ctypes.c_double),
+        ("interval_p50_ms", ctypes.c_double),
+        ("interval_p99_ms", ctypes.c_double),
+        ("mean_ms", ctypes.c_double),
+        ("p50_ms", ctypes.c_double),
+        ("p90_ms", ctypes.c_double),
+        ("p99_ms", ctypes.c_double),
+        ("p999_ms", ctypes.c_double),
+        ("max_ms", ctypes.c_double),
+        ("phase_p50_ms", ctypes.c_double * 5),
+        ("phase_p99_ms", ctypes.c_double * 5),
+    ]
+
+lib.set_engine.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+lib.set_engine.restype = ctypes.c_int
+lib.set_protocol.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int, ctypes.c_int]
+lib.set_protocol.restype = ctypes.c_int
+lib.set_cpu_affinity.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]
+lib.set_cpu_affinity.restype = ctypes.c_int
+lib.find_max_throughput.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_double, ctypes.c_double,
+                                    ctypes.c_int, ctypes.c_double, ctypes.c_double, ctypes.c_char_p]
+lib.find_max_throughput.restype = ctypes.c_double
+lib.start_test.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+lib.start_test.restype = ctypes.c_int
+lib.request_stop.argtypes = [ctypes.c_void_p]
+lib.set_warmup.argtypes = [ctypes.c_void_p, ctypes.c_int]
+lib.set_drain_timeout.argtypes = [ctypes.c_void_p, ctypes.c_double]
+lib.stop_test.argtypes = [ctypes.c_void_p]
+lib.is_test_running.argtypes = [ctypes.c_void_p]
+lib.is_test_running.restype = ctypes.c_int
+lib.get_snapshot.argtypes = [ctypes.c_void_p, ctypes.POINTER(LoadTestSnapshot)]
+lib.save_results_json.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+lib.save_results_json.restype = ctypes.c_int
 
 class LoadTesterGUI:
     def __init__(self):
@@ -39,8 +127,11 @@ class LoadTesterGUI:
         
         self.tester = None
         self.config = None
-        self.test_thread = None
         self.log_queue = queue.Queue()
+        # События теста приходят из фонового потока журнала C++ - только через очередь.
+        # Ссылка на обработчик хранится, пока жив объект, иначе ctypes его освободит
+        self.log_callback = LOG_CALLBACK(
+            lambda kind, line, user_data: self.log_queue.put(line.decode('utf-8', 'replace')))
         
         # Пустые стандартные поля - пользователь сам настроит через JSON
         self.standard_fields = []
@@ -90,6 +181,26 @@ class LoadTesterGUI:
         self.rps_entry.grid(row=3, column=1, sticky=tk.W, pady=2, padx=(5, 0))
         self.rps_entry.insert(0, "50")
         
+        # Keep-alive
+        self.keep_alive_var = tk.BooleanVar(value=True)
+        ttk.Checkbutton(settings_frame, text="Переиспользовать соединения (keep-alive)",
+                        variable=self.keep_alive_var).grid(row=4, column=1, sticky=tk.W, pady=2, padx=(5, 0))
+        
+        # Событийный движок curl_multi
+        self.multi_var = tk.BooleanVar(value=False)
+        ttk.Checkbutton(settings_frame, text="Событийный движок curl_multi (потоки = циклы)",
+                        variable=self.multi_var).grid(row=5, column=1, sticky=tk.W, pady=2, padx=(5, 0))
+        
+        # Пуассоновский поток
+        self.poisson_var = tk.BooleanVar(value=False)
+        ttk.Checkbutton(settings_frame, text="Пуассоновский поток запросов",
+                        variable=self.poisson_var).grid(row=7, column=1, sticky=tk.W, pady=2, padx=(5, 0))
+        
+        ttk.Label(settings_frame, text="Запросов в полёте на цикл:").grid(row=6, column=0, sticky=tk.W, pady=2)
+        self.in_flight_entry = ttk.Entry(settings_frame, width=10)
+        self.in_flight_entry.grid(row=6, column=1, sticky=tk.W, pady=2, padx=(5, 0))
+        self.in_flight_entry.insert(0, "64")
+        
         # === Секция JSON полей (рядом друг с другом) ===
         json_frame = ttk.LabelFrame(main_frame, text="JSON данные", padding="5")
         json_frame.grid(row=1, column=0, columnspan=2, sticky=(tk.W, tk.E), pady=(0, 10))
@@ -138,6 +249,9 @@ class LoadTesterGUI:
         self.start_btn = ttk.Button(button_frame, text="Начать тестирование", command=self.start_test)
         self.start_btn.pack(side=tk.LEFT, padx=(0, 10))
         
+        self.stop_btn = ttk.Button(button_frame, text="Остановить", command=self.stop_test, state='disabled')
+        self.stop_btn.pack(side=tk.LEFT, padx=(0, 10))
+        
         self.reset_btn = ttk.Button(button_frame, text="Сбросить данные", command=self.reset_data)
         self.reset_btn.pack(side=tk.LEFT, padx=(0, 10))
         
@@ -181,34 +295,28 @@ class LoadTesterGUI:
             
             # Создаем новые объекты
             self.tester = lib.create_tester_with_url(url.encode('utf-8'))
+            lib.set_log_callback(self.tester, self.log_callback, None)
             self.config = lib.create_test_data_config()
             
-            # Добавляем поля из JSON запроса
+            # Шаблон тела запроса из JSON (вложенные объекты и массивы сохраняются)
+            body_template = None
             request_json = self.request_json_text.get("1.0", tk.END).strip()
             if request_json:
                 try:
                     import json as py_json
                     request_data = py_json.loads(request_json)
-                    for key, value in request_data.items():
-                        # Определяем, является ли поле случайным
-                        is_random = False
-                        min_val = 0
-                        max_val = 0
-                        
-                        # Если значение пустое или содержит ключевые слова - делаем случайным
+                    
+                    def mark_random(value):
+                        # Пустое значение или ключевое слово - случайное число
+                        if isinstance(value, dict):
+                            return {k: mark_random(v) for k, v in value.items()}
+                        if isinstance(value, list):
+                            return [mark_random(v) for v in value]
                         if value == "" or str(value).lower() in ["random", "rand", "rnd"]:
-                            is_random = True
-                            min_val = 1000
-                            max_val = 9999
-                        
-                        lib.add_field_to_config(
-                            self.config,
-                            key.encode('utf-8'),
-                            str(value).encode('utf-8') if not is_random else b"",
-                            1 if is_random else 0,
-                            min_val,
-                            max_val
-                        )
+                            return "{{random:1000:9999}}"
+                        return value
+                    
+                    body_template = py_json.dumps(mark_random(request_data))
                     self.log(f"Добавлено {len(request_data)} полей из входного запроса")
                 except Exception as e:
                     self.log(f"Ошибка парсинга JSON запроса: {e}")
@@ -245,6 +353,13 @@ class LoadTesterGUI:
             
             # Применяем конфигурацию
             lib.set_test_data_config(self.tester, self.config)
+            if body_template is not None:
+                if lib.set_body_template(self.tester, body_template.encode('utf-8')) != 0:
+                    self.log("Ошибка в генераторе поля входного запроса")
+                    messagebox.showerror("Ошибка", "Неверное описание генератора во входном запросе")
+                    return
+            lib.set_keep_alive(self.tester, 1 if self.keep_alive_var.get() else 0)
+            lib.set_arrival_process(self.tester, 1 if self.poisson_var.get() else 0)
             
             self.log("Тест успешно настроен")
             self.status_var.set("Тест настроен - готов к запуску")
@@ -263,8 +378,10 @@ class LoadTesterGUI:
             threads = int(self.threads_entry.get())
             duration = int(self.duration_entry.get())
             rps = int(self.rps_entry.get())
+            in_flight = int(self.in_flight_entry.get())
+            use_multi = self.multi_var.get()
             
-            if threads <= 0 or duration <= 0 or rps < 0:
+            if threads <= 0 or duration <= 0 or rps < 0 or in_flight <= 0:
                 messagebox.showwarning("Предупреждение", "Проверьте корректность введенных значений!")
                 return
             
@@ -273,13 +390,12 @@ class LoadTesterGUI:
             self.setup_btn.config(state='disabled')
             self.status_var.set("Тестирование запущено...")
             
-            # Запускаем тест в отдельном потоке
-            self.test_thread = threading.Thread(
-                target=self.run_test_thread,
-                args=(threads, duration, rps),
-                daemon=True
-            )
-            self.test_thread.start()
+            # Тест идёт в фоновом потоке библиотеки, ход опрашиваем снимками
+            lib.set_engine(self.tester, 1 if use_multi else 0, in_flight)
+            if lib.start_test(self.tester, threads, duration, rps) != 0:
+                raise RuntimeError("тест уже запущен")
+            self.stop_btn.config(state='normal')
+            self.root.after(100, self.poll_snapshot)
             
             self.log(f"Запуск теста: {threads} потоков, {duration} сек, {rps} RPS")
             
@@ -289,15 +405,31 @@ class LoadTesterGUI:
             self.log(f"Ошибка запуска теста: {e}")
             messagebox.showerror("Ошибка", f"Не удалось запустить тест: {e}")
     
-    def run_test_thread(self, threads, duration, rps):
-        """Запуск теста в отдельном потоке"""
-        try:
-            lib.run_test(self.tester, threads, duration, rps)
-            self.log_queue.put("Тестирование завершено")
-        except Exception as e:
-            self.log_queue.put(f"Ошибка во время теста: {e}")
-        finally:
-            self.log_queue.put("DONE")  # Сигнал завершения
+    def stop_test(self):
+        """Досрочная остановка теста"""
+        self.stop_btn.config(state='disabled')
+        self.status_var.set("Остановка теста...")
+        # stop_test дожидается завершения теста - не блокируем главный цикл
+        threading.Thread(target=lib.stop_test, args=(self.tester,), daemon=True).start()
+    
+    def poll_snapshot(self):
+        """Опрос снимка метрик (10 раз в секунду)"""
+        snapshot = LoadTestSnapshot()
+        lib.get_snapshot(self.tester, ctypes.byref(snapshot))
+        self.status_var.set(
+            f"{snapshot.elapsed_seconds:.0f} с | RPS: {snapshot.interval_rps:.0f} | "
+            f"Успешно: {snapshot.success_responses} | Ошибки проверок: {snapshot.error_responses} | "
+            f"HTTP: {snapshot.http_errors} | Сеть: {snapshot.transport_errors} | "
+            f"В полёте: {snapshot.in_flight} | p50: {snapshot.interval_p50_ms:.1f} мс | "
+            f"p99: {snapshot.interval_p99_ms:.1f} мс (ожидание ответа {snapshot.phase_p99_ms[3]:.1f} мс)")
+        
+        if lib.is_test_running(self.tester):
+            self.root.after(100, self.poll_snapshot)
+            return
+        
+        self.log(f"Тестирование завершено: {snapshot.requests_started} запросов, "
+                 f"средний RPS {snapshot.cumulative_rps:.1f}, p99 {snapshot.p99_ms:.2f} мс")
+        self.log_queue.put("DONE")  # Сигнал завершения
     
     def reset_data(self):
         """Сброс данных к значениям по умолчанию"""
@@ -312,6 +444,13 @@ class LoadTesterGUI:
         self.rps_entry.delete(0, tk.END)
         self.rps_entry.insert(0, "50")
         
+        self.keep_alive_var.set(True)
+        self.multi_var.set(False)
+        self.poisson_var.set(False)
+        
+        self.in_flight_entry.delete(0, tk.END)
+        self.in_flight_entry.insert(0, "64")
+        
         # Очищаем JSON поля
         self.request_json_text.delete("1.0", tk.END)
         self.request_json_text.insert(tk.END, '{\n    "username": "test_user",\n    "action": "test"\n}')
@@ -342,7 +481,7 @@ class LoadTesterGUI:
                     # Разблокируем кнопки после завершения теста
                     self.start_btn.config(state='normal')
                     self.setup_btn.config(state='normal')
-                    self.status_var.set("Тестирование завершено")
+                    self.stop_btn.config(state='disabled')
                 else:
                     self.log(message)
         except queue.Empty:
@@ -367,9 +506,8 @@ if __name__ == "__main__":
     if not os.path.exists('./libload_tester.so'):
         print("Ошибка: файл libload_tester.so не найден!")
         print("Скомпилируйте C++ код сначала:")
-        print("g++ -std=c++17 -fPIC -O2 -c load_tester.cpp -o load_tester.o")
-        print("g++ -std=c++17 -fPIC -O2 -c load_tester_c.cpp -o load_tester_c.o")
-        print("g++ -shared -o libload_tester.so load_tester.o load_tester_c.o -lcurl -ljsoncpp -lpthread")
+        print("cmake -S . -B build && cmake --build build -j")
+        print("cp build/libload_tester.so .")
         input("Нажмите Enter для выхода...")  # <-- Ждет нажатия Enter
         sys.exit(1)
     
@@ -0,0 +1,60 @@
+/// @file regression_gate.cpp
+/// @brief Реализация проверки итогов по порогам
+
+#include "regression_gate.hpp"
+
+using json = nlohmann::json;
+
+std::vector<GateCheck> checkGates(const json& results, const json* baseline, const GateThresholds& thresholds) {
+    std::vector<GateCheck> checks;
+    const double p99 = results["latency_ms"].value("p99", 0.0);
+    const double rps = results["throughput"].value("rps", 0.0);
+
+    // Прогон без единого успешного ответа (ничего не завершилось или сервер недоступен)
+    // проходил бы пороги p99: задержка отказа в соединении мала
+    GateCheck succeeded;
+    succeeded.name = "requests_succeeded";
+    succeeded.baseline = baseline ? (*baseline)["requests"].value("success", 0.0) : 0;
+    succeeded.current = results["requests"].value("success", 0.0);
+    succeeded.limit = 1;
+    succeeded.passed = succeeded.current >= succeeded.limit;
+    checks.push_back(succeeded);
+
+    if (thresholds.max_p99_ms >= 0) {
+        GateCheck check;
+        check.name = "p99_ms_limit";
+        check.baseline = baseline ? (*baseline)["latency_ms"].value("p99", 0.0) : 0;
+        check.current = p99;
+        check.limit = thresholds.max_p99_ms;
+        check.passed = check.current <= check.limit;
+        checks.push_back(check);
+    }
+    if (baseline && thresholds.max_p99_increase >= 0) {
+        GateCheck check;
+        check.name = "p99_ms";
+        check.baseline = (*baseline)["latency_ms"].value("p99", 0.0);
+        check.current = p99;
+        check.limit = check.baseline * (1 + thresholds.max_p99_increase / 100);
+        check.passed = check.current <= check.limit;
+        checks.push_back(check);
+    }
+    if (baseline && thresholds.max_throughput_drop >= 0) {
+        GateCheck check;
+        check.name = "throughput_rps";
+        check.baseline = (*baseline)["throughput"].value("rps", 0.0);
+        check.current = rps;
+        check.limit = check.baseline * (1 - thresholds.max_throughput_drop / 100);
+        check.passed = check.current >= check.limit;
+        checks.push_back(check);
+    }
+    if (thresholds.max_error_rate >= 0) {
+        GateCheck check;
+        check.name = "error_rate_pct";
+        check.baseline = baseline ? baseline->value("error_rate", 0.0) * 100 : 0;
+        check.current = results.value("error_rate", 0.0) * 100;
+        check.limit = thresholds.max_error_rate;
+        check.passed = check.current <= check.limit;
+        checks.push_back(check);
+    }
+    return checks;
+}
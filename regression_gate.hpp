@@ -0,0 +1,42 @@
+/// @file regression_gate.hpp
+/// @brief Проверка итогов теста по порогам и эталонному прогону
+
+#ifndef REGRESSION_GATE_HPP
+#define REGRESSION_GATE_HPP
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * @struct GateThresholds
+ * @brief Пороги проверки; отрицательное значение - порог не задан
+ */
+struct GateThresholds {
+    double max_p99_ms = -1;             //< Допустимый p99, мс
+    double max_p99_increase = -1;       //< Допустимый рост p99 от эталона, %
+    double max_throughput_drop = -1;    //< Допустимое падение RPS, %
+    double max_error_rate = -1;         //< Допустимая доля ошибок, %
+};
+
+/**
+ * @struct GateCheck
+ * @brief Результат одной проверки порога
+ */
+struct GateCheck {
+    std::string name;
+    double baseline = 0;
+    double current = 0;
+    double limit = 0;                   //< Порог в единицах current
+    bool passed = true;
+};
+
+/// @brief Проверяет итоги (LoadTester::summaryJson) по порогам и эталону
+/// @details Рост p99 и падение RPS считаются относительно эталона; p99 в мс и доля ошибок -
+/// абсолютные пороги. Прогон без успешных ответов не проходит никогда
+/// @param baseline Итоги эталонного прогона (nullptr - без эталона)
+std::vector<GateCheck> checkGates(const nlohmann::json& results, const nlohmann::json* baseline,
+                                  const GateThresholds& thresholds);
+
+#endif // REGRESSION_GATE_HPP
@@ -0,0 +1,393 @@
+/// @file replay_source.cpp
+/// @brief Реализация источника записанных запросов
+
+#include "replay_source.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "json_scan.hpp"
+
+/// @brief Совпадает ли ключ JSON с литералом
+static bool keyIs(const char* key, size_t size, const char* literal) {
+    return std::strlen(literal) == size && std::memcmp(key, literal, size) == 0;
+}
+
+/// @brief Читает число из буфера без завершающего нуля
+static bool parseNumber(const char* data, size_t size, double& value) {
+    char buffer[64];
+    if (size == 0 || size >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, data, size);
+    buffer[size] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + size;
+}
+
+/// @brief Читает count цифр
+static bool parseDigits(const char*& p, const char* end, int count, int& value) {
+    value = 0;
+    for (int i = 0; i < count; ++i, ++p) {
+        if (p >= end || *p < '0' || *p > '9') {
+            return false;
+        }
+        value = value * 10 + (*p - '0');
+    }
+    return true;
+}
+
+/// @brief Дней от 1970-01-01 до даты (алгоритм Howard Hinnant)
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+/// @brief Разбирает момент ISO 8601 ("2024-01-02T03:04:05.123+03:00") в наносекунды UNIX
+static bool parseIso8601(const char* p, size_t size, int64_t& time_ns) {
+    const char* end = p + size;
+    int year, month, day, hour, minute, second;
+    if (!parseDigits(p, end, 4, year) || p >= end || *p++ != '-' ||
+        !parseDigits(p, end, 2, month) || p >= end || *p++ != '-' ||
+        !parseDigits(p, end, 2, day) || p >= end || (*p != 'T' && *p != ' ') ||
+        !parseDigits(++p, end, 2, hour) || p >= end || *p++ != ':' ||
+        !parseDigits(p, end, 2, minute) || p >= end || *p++ != ':' ||
+        !parseDigits(p, end, 2, second)) {
+        return false;
+    }
+
+    int64_t fraction_ns = 0;
+    if (p < end && *p == '.') {
+        int64_t scale = 100000000;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            fraction_ns += (*p - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    int64_t offset_seconds = 0;
+    if (p < end && (*p == '+' || *p == '-')) {
+        const int sign = *p++ == '-' ? -1 : 1;
+        int offset_hours, offset_minutes = 0;
+        if (!parseDigits(p, end, 2, offset_hours)) {
+            return false;
+        }
+        if (p < end && *p == ':') {
+            ++p;
+        }
+        if (p < end && !parseDigits(p, end, 2, offset_minutes)) {
+            return false;
+        }
+        offset_seconds = sign * (offset_hours * 3600 + offset_minutes * 60);
+    } else if (p < end && *p == 'Z') {
+        ++p;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    const int64_t seconds = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400 +
+                            hour * 3600 + minute * 60 + second - offset_seconds;
+    time_ns = seconds * 1000000000 + fraction_ns;
+    return true;
+}
+
+/// @brief Разбирает объект записи; вложенные request и postData (HAR) разбираются тем же кодом
+static bool parseRecordObject(JsonCursor& cursor, ReplayRecord& record, int64_t& time_ns,
+                              bool& has_time, int depth) {
+    if (depth > 4 || !cursor.consume('{')) {
+        return false;
+    }
+    if (cursor.consume('}')) {
+        return true;
+    }
+
+    do {
+        cursor.skipWhitespace();
+        const char* key;
+        size_t key_size;
+        bool escaped;
+        if (!cursor.readString(key, key_size, escaped) || !cursor.consume(':')) {
+            return false;
+        }
+        cursor.skipWhitespace();
+
+        const char* data;
+        size_t size;
+        if (keyIs(key, key_size, "ts")) {
+            double seconds;
+            if (!cursor.readScalar(data, size) || !parseNumber(data, size, seconds)) {
+                return false;
+            }
+            time_ns = static_cast<int64_t>(std::llround(seconds * 1e9));
+            has_time = true;
+        } else if ((keyIs(key, key_size, "timestamp") || keyIs(key, key_size, "startedDateTime")) &&
+                   cursor.peek() == '"') {
+            if (!cursor.readString(data, size, escaped)) {
+                return false;
+            }
+            has_time = parseIso8601(data, size, time_ns) || has_time;
+        } else if (keyIs(key, key_size, "method") && cursor.peek() == '"') {
+            if (!cursor.readString(record.method, record.method_size, escaped)) {
+                return false;
+            }
+        } else if (keyIs(key, key_size, "url") && cursor.peek() == '"') {
+            if (!cursor.readString(record.url, record.url_size, record.url_escaped)) {
+                return false;
+            }
+        } else if (keyIs(key, key_size, "body") || keyIs(key, key_size, "text")) {
+            if (cursor.peek() == '"') {
+                if (!cursor.readString(record.body, record.body_size, record.body_escaped)) {
+                    return false;
+                }
+            } else {
+                // Объект или массив передаётся как есть - срезом исходного текста
+                const char* begin = cursor.p;
+                if (!cursor.skipValue(depth + 1)) {
+                    return false;
+                }
+                if (!keyIs(begin, static_cast<size_t>(cursor.p - begin), "null")) {
+                    record.body = begin;
+                    record.body_size = static_cast<size_t>(cursor.p - begin);
+                    record.body_escaped = false;
+                }
+            }
+        } else if ((keyIs(key, key_size, "request") || keyIs(key, key_size, "postData")) &&
+                   cursor.peek() == '{') {
+            if (!parseRecordObject(cursor, record, time_ns, has_time, depth + 1)) {
+                return false;
+            }
+        } else if (!cursor.skipValue(depth + 1)) {
+            return false;
+        }
+    } while (cursor.consume(','));
+
+    return cursor.consume('}');
+}
+
+/// @brief Находит массив entries внутри объекта HAR и запоминает начало каждого элемента
+static bool findHarEntries(JsonCursor& cursor, const char* base, std::vector<uint64_t>& offsets, int depth) {
+    if (depth > 2 || !cursor.consume('{')) {
+        return false;
+    }
+    if (cursor.consume('}')) {
+        return true;
+    }
+
+    do {
+        cursor.skipWhitespace();
+        const char* key;
+        size_t key_size;
+        bool escaped;
+        if (!cursor.readString(key, key_size, escaped) || !cursor.consume(':')) {
+            return false;
+        }
+        cursor.skipWhitespace();
+
+        if (keyIs(key, key_size, "log") && cursor.peek() == '{') {
+            if (!findHarEntries(cursor, base, offsets, depth + 1)) {
+                return false;
+            }
+        } else if (keyIs(key, key_size, "entries") && cursor.consume('[')) {
+            if (cursor.consume(']')) {
+                continue;
+            }
+            do {
+                cursor.skipWhitespace();
+                offsets.push_back(static_cast<uint64_t>(cursor.p - base));
+                if (!cursor.skipValue(depth + 1)) {
+                    return false;
+                }
+            } while (cursor.consume(','));
+            if (!cursor.consume(']')) {
+                return false;
+            }
+        } else if (!cursor.skipValue(depth + 1)) {
+            return false;
+        }
+    } while (cursor.consume(','));
+
+    return cursor.consume('}');
+}
+
+ReplaySource::~ReplaySource() {
+    close();
+}
+
+void ReplaySource::close() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    offsets_.clear();
+    offsets_.shrink_to_fit();
+    has_timestamps_ = false;
+    first_ns_ = span_ns_ = period_ns_ = 0;
+    malformed_.store(0, std::memory_order_relaxed);
+    rewind();
+}
+
+void ReplaySource::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open replay file " + path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("replay file " + path + " is empty");
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("cannot map replay file " + path + ": " + std::strerror(errno));
+    }
+    data_ = static_cast<const char*>(mapped);
+    size_ = static_cast<size_t>(st.st_size);
+    path_ = path;
+    // Файл читается от начала к концу - ядро упреждающе читает и раньше вытесняет прочитанное
+    madvise(mapped, size_, MADV_SEQUENTIAL);
+
+    JsonCursor probe(data_, size_);
+    probe.skipWhitespace();
+    bool har = probe.peek() == '[';
+    if (probe.peek() == '{') {
+        // Объект с ключом "log" - HAR, любой другой - первая строка JSONL
+        const char* key;
+        size_t key_size;
+        bool escaped;
+        ++probe.p;
+        probe.skipWhitespace();
+        har = probe.readString(key, key_size, escaped) && keyIs(key, key_size, "log");
+    }
+    if (har) {
+        indexHar();
+    } else {
+        indexLines();
+    }
+    if (offsets_.empty()) {
+        close();
+        throw std::runtime_error("replay file " + path + " contains no requests");
+    }
+
+    // Границы шкалы времени - по первой и последней разобранным записям с моментом
+    int64_t first_ns = 0;
+    int64_t last_ns = 0;
+    const bool first_timed = findTimestamp(true, first_ns);
+    const bool last_timed = findTimestamp(false, last_ns);
+    has_timestamps_ = first_timed && last_timed;
+    if (has_timestamps_) {
+        first_ns_ = first_ns;
+        span_ns_ = std::max<int64_t>(0, last_ns - first_ns);
+        // Круг длиннее записи на средний интервал, чтобы стык кругов не давал всплеска
+        period_ns_ = offsets_.size() > 1
+            ? span_ns_ + span_ns_ / static_cast<int64_t>(offsets_.size() - 1)
+            : 1000000000;
+    }
+}
+
+bool ReplaySource::findTimestamp(bool from_front, int64_t& time_ns) const {
+    constexpr size_t kMaxProbes = 1000;
+    const size_t count = offsets_.size();
+    for (size_t i = 0; i < std::min(count, kMaxProbes); ++i) {
+        const uint64_t offset = offsets_[from_front ? i : count - 1 - i];
+        JsonCursor cursor(data_ + offset, size_ - offset);
+        ReplayRecord record;
+        bool has_time = false;
+        if (parseRecordObject(cursor, record, time_ns, has_time, 0) && has_time) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ReplaySource::indexLines() {
+    const char* p = data_;
+    const char* end = data_ + size_;
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!line_end) {
+            line_end = end;
+        }
+        const char* q = p;
+        while (q < line_end && (*q == ' ' || *q == '\t' || *q == '\r')) {
+            ++q;
+        }
+        if (q < line_end && *q == '{') {
+            offsets_.push_back(static_cast<uint64_t>(q - data_));
+        }
+        p = line_end + 1;
+    }
+}
+
+void ReplaySource::indexHar() {
+    JsonCursor cursor(data_, size_);
+    cursor.skipWhitespace();
+    if (cursor.peek() == '[') {
+        // Массив записей без обёртки log
+        ++cursor.p;
+        if (cursor.consume(']')) {
+            return;
+        }
+        do {
+            cursor.skipWhitespace();
+            offsets_.push_back(static_cast<uint64_t>(cursor.p - data_));
+            if (!cursor.skipValue()) {
+                break;
+            }
+        } while (cursor.consume(','));
+        return;
+    }
+    findHarEntries(cursor, data_, offsets_, 0);
+}
+
+bool ReplaySource::parse(size_t index, uint64_t loop, ReplayRecord& record) const {
+    const uint64_t offset = offsets_[index];
+    JsonCursor cursor(data_ + offset, size_ - offset);
+    record = ReplayRecord();
+    int64_t time_ns = first_ns_;
+    bool has_time = false;
+    if (!parseRecordObject(cursor, record, time_ns, has_time, 0)) {
+        return false;
+    }
+    // Записи захвата бывают слегка не по порядку - раньше первой не отправляем
+    record.offset_ns = has_timestamps_ ? std::max<int64_t>(0, time_ns - first_ns_) : 0;
+    record.offset_ns += static_cast<int64_t>(loop) * period_ns_;
+    return true;
+}
+
+bool ReplaySource::next(ReplayRecord& record) {
+    const size_t count = offsets_.size();
+    if (count == 0) {
+        return false;
+    }
+    // Испорченные записи пропускаются, но не больше круга подряд
+    for (size_t attempt = 0; attempt < count; ++attempt) {
+        const uint64_t sequence = cursor_.fetch_add(1, std::memory_order_relaxed) * parts_ + part_;
+        if (!looping_ && sequence >= count) {
+            return false;
+        }
+        if (parse(static_cast<size_t>(sequence % count), sequence / count, record)) {
+            return true;
+        }
+        malformed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
@@ -0,0 +1,129 @@
+/// @file replay_source.hpp
+/// @brief Воспроизведение записанных запросов из отображённого в память файла
+
+#ifndef REPLAY_SOURCE_HPP
+#define REPLAY_SOURCE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ReplayRecord
+ * @brief Записанный запрос
+ *
+ * Строки указывают прямо в отображённый файл и не завершаются нулём.
+ * Пустой метод или URL - берутся настройки теста.
+ */
+struct ReplayRecord {
+    const char* method = nullptr;   //< Метод HTTP
+    size_t method_size = 0;
+    const char* url = nullptr;      //< Целевой URL
+    size_t url_size = 0;
+    bool url_escaped = false;       //< В URL есть escape-последовательности JSON
+    const char* body = nullptr;     //< Тело запроса (nullptr - без тела)
+    size_t body_size = 0;
+    bool body_escaped = false;      //< Тело - строка JSON с escape-последовательностями
+    int64_t offset_ns = 0;          //< Момент отправки от начала записи (с учётом повторов)
+};
+
+/**
+ * @class ReplaySource
+ * @brief Источник записанных запросов (JSONL или HAR)
+ *
+ * Файл отображается в память только для чтения и не копируется: при
+ * открытии строится индекс смещений записей (8 байт на запись), тела
+ * передаются в CURL срезами отображения. Страницы файла - чистый кэш
+ * страниц, ядро вытесняет их по мере чтения, поэтому размер файла не
+ * ограничен объёмом памяти.
+ *
+ * Рабочие потоки берут записи из общего атомарного курсора. Запись
+ * разбирается в момент выдачи потоковым курсором JSON без выделений.
+ *
+ * Формат JSONL - по объекту на строку:
+ * {"ts": 1700000000.25, "method": "POST", "url": "http://...", "body": {...}}
+ * ts - секунды UNIX (или "timestamp" строкой ISO 8601), body - JSON-значение
+ * или строка. В HAR берутся log.entries[].startedDateTime,
+ * request.method, request.url и request.postData.text.
+ */
+class ReplaySource {
+public:
+    ReplaySource() = default;
+    ~ReplaySource();
+
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    /// @brief Отображает файл и строит индекс записей
+    /// @details Формат определяется по первому символу: '[' или '{' с ключом "log" - HAR,
+    /// иначе JSONL. Бросает std::runtime_error, если файл не открылся или пуст
+    void open(const std::string& path);
+
+    /// @brief Освобождает отображение
+    void close();
+
+    /// @brief Повторять запись по кругу после последнего запроса
+    void setLooping(bool looping) { looping_ = looping; }
+
+    bool looping() const { return looping_; }
+
+    /// @brief Берёт только каждую parts-ю запись, начиная с part (доля одного агента)
+    /// @details Доли агентов не пересекаются и вместе дают исходную запись в исходном темпе
+    void setPartition(size_t part, size_t parts) {
+        parts_ = parts > 0 ? parts : 1;
+        part_ = part % parts_;
+    }
+
+    /// @brief Число записей в файле
+    size_t size() const { return offsets_.size(); }
+
+    /// @brief Есть ли в записях моменты отправки (нужны для воспроизведения в исходном темпе)
+    bool hasTimestamps() const { return has_timestamps_; }
+
+    /// @brief Длительность записи от первого до последнего запроса
+    double spanSeconds() const { return span_ns_ / 1e9; }
+
+    const std::string& path() const { return path_; }
+
+    /// @brief Пропущено записей, которые не разобрались
+    uint64_t malformed() const { return malformed_.load(std::memory_order_relaxed); }
+
+    /// @brief Сбрасывает курсор на первую запись
+    void rewind() { cursor_.store(0, std::memory_order_relaxed); }
+
+    /// @brief Выдаёт следующую запись (из любого потока)
+    /// @return false, если записи кончились (без повтора) или целый круг записей не разобрался
+    bool next(ReplayRecord& record);
+
+private:
+    /// @brief Разбирает запись с номером index, повтор loop
+    bool parse(size_t index, uint64_t loop, ReplayRecord& record) const;
+
+    /// @brief Ищет момент первой (или последней) записи, пропуская испорченные
+    bool findTimestamp(bool from_front, int64_t& time_ns) const;
+
+    /// @brief Индексирует JSONL: начало каждой непустой строки
+    void indexLines();
+
+    /// @brief Индексирует HAR: начало каждого объекта log.entries
+    void indexHar();
+
+    const char* data_ = nullptr;        //< Отображение файла
+    size_t size_ = 0;                   //< Размер файла
+    std::string path_;
+    std::vector<uint64_t> offsets_;     //< Смещения записей
+    int64_t first_ns_ = 0;              //< Момент первой записи
+    int64_t span_ns_ = 0;               //< От первой до последней записи
+    int64_t period_ns_ = 0;             //< Длина круга при повторе
+    bool has_timestamps_ = false;
+    bool looping_ = false;
+    size_t part_ = 0;                   //< Доля агента
+    size_t parts_ = 1;                  //< Число долей
+
+    alignas(64) std::atomic<uint64_t> cursor_{0};   //< Номер следующей записи (сквозной по кругам)
+    std::atomic<uint64_t> malformed_{0};            //< Пропущено испорченных записей
+};
+
+#endif // REPLAY_SOURCE_HPP
@@ -0,0 +1,39 @@
+/// @file request_phases.cpp
+/// @brief Реализация гистограмм фаз запроса
+
+#include "request_phases.hpp"
+
+const char* requestPhaseName(size_t phase) {
+    static const char* const kNames[kRequestPhaseCount] = {"dns", "connect", "tls", "ttfb", "transfer"};
+    return phase < kRequestPhaseCount ? kNames[phase] : "unknown";
+}
+
+void PhaseHistograms::merge(const PhaseHistograms& other) {
+    for (size_t i = 0; i < kRequestPhaseCount; ++i) {
+        phase[i].merge(other.phase[i]);
+    }
+}
+
+void PhaseHistograms::subtract(const PhaseHistograms& earlier) {
+    for (size_t i = 0; i < kRequestPhaseCount; ++i) {
+        phase[i].subtract(earlier.phase[i]);
+    }
+}
+
+void PhaseHistograms::reset() {
+    for (auto& histogram : phase) {
+        histogram.reset();
+    }
+}
+
+void PhaseRecorder::snapshotInto(PhaseHistograms& out) const {
+    for (size_t i = 0; i < kRequestPhaseCount; ++i) {
+        phases_[i].snapshotInto(out.phase[i]);
+    }
+}
+
+void PhaseRecorder::reset() {
+    for (auto& recorder : phases_) {
+        recorder.reset();
+    }
+}
@@ -0,0 +1,93 @@
+/// @file request_phases.hpp
+/// @brief Разбивка задержки запроса по фазам (тайминги CURL)
+
+#ifndef REQUEST_PHASES_HPP
+#define REQUEST_PHASES_HPP
+
+#include "latency_histogram.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum RequestPhase
+ * @brief Фаза запроса
+ *
+ * Границы фаз - отметки CURL: NAMELOOKUP, CONNECT, APPCONNECT, PRETRANSFER,
+ * STARTTRANSFER и TOTAL. Фазы установки соединения есть только у запросов,
+ * открывших новое соединение.
+ */
+enum class RequestPhase {
+    Dns,        //< Разрешение имени: 0 .. NAMELOOKUP
+    Connect,    //< TCP: NAMELOOKUP .. CONNECT
+    Tls,        //< Рукопожатие TLS: CONNECT .. APPCONNECT
+    Ttfb,       //< От отправки до первого байта ответа: PRETRANSFER .. STARTTRANSFER
+    Transfer    //< Приём тела ответа: STARTTRANSFER .. TOTAL
+};
+
+constexpr size_t kRequestPhaseCount = 5;
+
+/// @brief Короткое имя фазы для отчётов
+const char* requestPhaseName(size_t phase);
+
+/**
+ * @struct PhaseTimes
+ * @brief Длительности фаз одного запроса, нс
+ */
+struct PhaseTimes {
+    uint64_t ns[kRequestPhaseCount] = {};
+    unsigned measured = 0;          //< Битовая маска фаз, которые были у запроса
+
+    /// @brief Задаёт длительность фазы по отметкам CURL, мкс
+    void set(RequestPhase phase, int64_t from_us, int64_t to_us) {
+        const size_t i = static_cast<size_t>(phase);
+        ns[i] = to_us > from_us ? static_cast<uint64_t>(to_us - from_us) * 1000 : 0;
+        measured |= 1u << i;
+    }
+};
+
+/**
+ * @struct PhaseHistograms
+ * @brief Гистограммы всех фаз (слияние и анализ)
+ */
+struct PhaseHistograms {
+    LatencyHistogram phase[kRequestPhaseCount];
+
+    /// @brief Добавляет гистограммы другого набора
+    void merge(const PhaseHistograms& other);
+
+    /// @brief Вычитает более раннее состояние того же набора (для интервалов)
+    void subtract(const PhaseHistograms& earlier);
+
+    /// @brief Обнуляет все гистограммы
+    void reset();
+};
+
+/**
+ * @class PhaseRecorder
+ * @brief Гистограммы фаз одного рабочего потока
+ *
+ * Как и HistogramRecorder, пишется только потоком-владельцем без RMW-операций.
+ */
+class PhaseRecorder {
+public:
+    /// @brief Записывает измеренные фазы запроса (только поток-владелец)
+    void record(const PhaseTimes& times) {
+        for (size_t i = 0; i < kRequestPhaseCount; ++i) {
+            if (times.measured & (1u << i)) {
+                phases_[i].record(times.ns[i]);
+            }
+        }
+    }
+
+    /// @brief Добавляет текущее состояние в out
+    void snapshotInto(PhaseHistograms& out) const;
+
+    /// @brief Обнуляет гистограммы (только когда поток-владелец не пишет)
+    void reset();
+
+private:
+    HistogramRecorder phases_[kRequestPhaseCount];
+};
+
+#endif // REQUEST_PHASES_HPP
@@ -0,0 +1,194 @@
+/// @file request_trace.cpp
+/// @brief Реализация двоичной трассы запросов
+
+#include "request_trace.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "cpu_affinity.hpp"
+
+namespace {
+constexpr size_t kFlushBytes = 4 << 20;     // Блок записи в файл
+constexpr auto kDrainPeriod = std::chrono::milliseconds(5);
+
+/// @brief Пишет буфер целиком, повторяя прерванные и частичные записи
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+} // namespace
+
+TraceRing::TraceRing(size_t capacity) : mask_(capacity - 1), records_(new TraceRecord[capacity]) {}
+
+size_t TraceRing::capacityFor(size_t rings) {
+    const size_t share = kTotalBudget / std::max<size_t>(rings, 1);
+    size_t capacity = kMinCapacity;
+    while (capacity * 2 <= share && capacity < kMaxCapacity) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+void TraceRing::push(const TraceRecord& record) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) > mask_) {
+        dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    records_[head & mask_] = record;
+    head_.store(head + 1, std::memory_order_release);
+}
+
+size_t TraceRing::drainTo(std::vector<char>& out) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) {
+        return 0;
+    }
+    // Занятая часть кольца - не больше двух непрерывных кусков
+    const size_t count = head - tail;
+    const size_t first = std::min(count, mask_ + 1 - (tail & mask_));
+    const char* base = reinterpret_cast<const char*>(records_.get());
+    out.insert(out.end(), base + (tail & mask_) * sizeof(TraceRecord),
+               base + ((tail & mask_) + first) * sizeof(TraceRecord));
+    out.insert(out.end(), base, base + (count - first) * sizeof(TraceRecord));
+    tail_.store(head, std::memory_order_release);
+    return count;
+}
+
+TraceWriter::~TraceWriter() {
+    stop();
+}
+
+bool TraceWriter::open(const std::string& path) {
+    stop();
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    fd_ = fd;
+    path_ = path;
+    header_ = TraceFileHeader();
+    std::memcpy(header_.magic, TraceFileHeader::kMagic, sizeof(header_.magic));
+    header_.version = TraceFileHeader::kVersion;
+    header_.record_size = sizeof(TraceRecord);
+    rings_.clear();
+    buffer_.clear();
+    buffer_.reserve(kFlushBytes + TraceRing::kMaxCapacity * sizeof(TraceRecord));
+    written_ = 0;
+    dropped_ = 0;
+    write_failed_ = false;
+    // Заголовок пишется сразу: незакрытый файл (аварийное завершение) всё равно читается
+    write_failed_ = !writeAll(fd_, reinterpret_cast<const char*>(&header_), sizeof(header_));
+    return true;
+}
+
+TraceRing* TraceWriter::attach(size_t rings) {
+    rings_.push_back(std::make_unique<TraceRing>(TraceRing::capacityFor(rings)));
+    return rings_.back().get();
+}
+
+void TraceWriter::start(std::chrono::steady_clock::time_point origin) {
+    if (fd_ < 0 || running_) {
+        return;
+    }
+    header_.origin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(origin.time_since_epoch()).count();
+    const auto unix_now = std::chrono::system_clock::now();
+    const auto since_origin = std::chrono::steady_clock::now() - origin;
+    header_.origin_unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        (unix_now - since_origin).time_since_epoch()).count();
+    if (::pwrite(fd_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_))) {
+        write_failed_ = true;
+    }
+
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    running_ = true;
+    thread_ = std::thread(&TraceWriter::run, this);
+}
+
+void TraceWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        if (running_) {
+            running_ = false;
+            wake_.notify_one();
+        }
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (fd_ < 0) {
+        return;
+    }
+
+    drain(true);
+    for (const auto& ring : rings_) {
+        dropped_ += ring->dropped();
+    }
+    header_.record_count = write_failed_ ? 0 : written_;
+    header_.dropped = dropped_;
+    if (::pwrite(fd_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_))) {
+        write_failed_ = true;
+    }
+    if (write_failed_) {
+        std::cerr << "Failed to write request trace " << path_ << ": " << std::strerror(errno) << std::endl;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    rings_.clear();
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+void TraceWriter::run() {
+    if (!affinity_.empty()) {
+        pinCurrentThread(affinity_);
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (running_) {
+        wake_.wait_for(lock, kDrainPeriod);
+        lock.unlock();
+        drain(false);
+        lock.lock();
+    }
+}
+
+void TraceWriter::drain(bool final) {
+    for (const auto& ring : rings_) {
+        written_ += ring->drainTo(buffer_);
+        // Кольцо опустошается целиком, поэтому буфер растёт не больше чем на кольцо за раз
+        if (buffer_.size() >= kFlushBytes) {
+            flush();
+        }
+    }
+    if (final) {
+        flush();
+    }
+}
+
+bool TraceWriter::flush() {
+    if (buffer_.empty()) {
+        return true;
+    }
+    if (!write_failed_ && !writeAll(fd_, buffer_.data(), buffer_.size())) {
+        write_failed_ = true;
+    }
+    buffer_.clear();
+    return !write_failed_;
+}
@@ -0,0 +1,180 @@
+/// @file request_trace.hpp
+/// @brief Двоичная трасса запросов: запись по записи на каждый запрос
+
+#ifndef REQUEST_TRACE_HPP
+#define REQUEST_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @enum TraceOutcome
+ * @brief Итог запроса в трассе
+ */
+enum class TraceOutcome : uint8_t {
+    Success,            //< Допустимый код, проверки пройдены
+    CheckFailed,        //< Допустимый код, проверки не пройдены
+    HttpError,          //< Недопустимый код HTTP
+    TransportError,     //< Ошибка CURL
+    Cancelled           //< Прерван остановкой теста
+};
+
+/// @brief Флаги записи трассы
+enum TraceFlags : uint8_t {
+    kTraceNewConnection = 1 << 0    //< Запрос открыл соединение
+};
+
+/**
+ * @struct TraceRecord
+ * @brief Запись трассы фиксированного размера (48 байт)
+ *
+ * Моменты - steady_clock в наносекундах, как в самом генераторе;
+ * начало отсчёта теста хранится в заголовке файла.
+ */
+struct TraceRecord {
+    int64_t scheduled_ns = 0;       //< Запланированный момент отправки
+    int64_t start_ns = 0;           //< Фактический момент отправки
+    int64_t end_ns = 0;             //< Завершение запроса
+    uint32_t bytes_received = 0;    //< Тело ответа, байт
+    uint32_t bytes_sent = 0;        //< Тело запроса, байт
+    int32_t status = 0;             //< Код HTTP (0 - ответа не было)
+    int32_t error = 0;              //< CURLcode (0 - без ошибки)
+    uint16_t thread_id = 0;         //< Номер рабочего потока
+    uint16_t scenario = 0;          //< Номер сценария
+    TraceOutcome outcome = TraceOutcome::Success;
+    uint8_t flags = 0;              //< TraceFlags
+    uint16_t reserved = 0;
+};
+
+static_assert(sizeof(TraceRecord) == 48, "trace record layout is part of the file format");
+
+/**
+ * @struct TraceFileHeader
+ * @brief Заголовок файла трассы; за ним подряд идут записи TraceRecord
+ */
+struct TraceFileHeader {
+    static constexpr char kMagic[8] = {'L', 'T', 'T', 'R', 'A', 'C', 'E', '1'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8] = {};
+    uint32_t version = 0;
+    uint32_t record_size = 0;       //< sizeof(TraceRecord)
+    int64_t origin_ns = 0;          //< Начало измеряемой части теста (steady_clock)
+    int64_t origin_unix_ns = 0;     //< Тот же момент по системным часам
+    uint64_t record_count = 0;      //< Записей (0 - файл не закрыт, считать по размеру)
+    uint64_t dropped = 0;           //< Отброшено при переполнении колец
+};
+
+static_assert(sizeof(TraceFileHeader) == 48, "trace header layout is part of the file format");
+
+/**
+ * @class TraceRing
+ * @brief Кольцо записей трассы одного рабочего потока (один писатель, один читатель)
+ *
+ * Как и EventRing, запись не блокируется: при переполнении запись
+ * отбрасывается и учитывается в счётчике.
+ */
+class TraceRing {
+public:
+    static constexpr size_t kMaxCapacity = 1 << 16; //< Наибольшая ёмкость (3 МБ)
+    static constexpr size_t kMinCapacity = 1 << 12; //< Наименьшая ёмкость (192 КБ)
+    static constexpr size_t kTotalBudget = 1 << 20; //< Записей во всех кольцах вместе (48 МБ)
+
+    /// @param capacity Ёмкость, степень двойки
+    explicit TraceRing(size_t capacity = kMaxCapacity);
+
+    /// @brief Ёмкость кольца, при которой rings колец укладываются в kTotalBudget
+    /// @details Сотни блокирующих потоков получают маленькие кольца, несколько
+    /// событийных циклов - большие; поток записи опустошает их каждые 5 мс
+    static size_t capacityFor(size_t rings);
+
+    /// @brief Добавляет запись (поток-владелец)
+    void push(const TraceRecord& record);
+
+    /// @brief Переносит накопленные записи в конец out (поток записи)
+    /// @return Число перенесённых записей
+    size_t drainTo(std::vector<char>& out);
+
+    /// @brief Отброшено записей
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<size_t> head_{0};   //< Позиция записи (пишет владелец)
+    std::atomic<uint64_t> dropped_{0};          //< Отброшено при переполнении (пишет владелец)
+    alignas(64) std::atomic<size_t> tail_{0};   //< Позиция чтения (пишет поток записи)
+    size_t mask_;                               //< Ёмкость - 1
+    std::unique_ptr<TraceRecord[]> records_;
+};
+
+/**
+ * @class TraceWriter
+ * @brief Запись трассы в файл фоновым потоком
+ *
+ * Фоновый поток каждые несколько миллисекунд забирает записи из колец
+ * в общий буфер и пишет его в файл крупными последовательными блоками.
+ * Рабочие потоки не делают системных вызовов и не берут блокировок.
+ */
+class TraceWriter {
+public:
+    TraceWriter() = default;
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /// @brief Создаёт файл трассы (перезаписывает существующий)
+    /// @return false, если файл не создался
+    bool open(const std::string& path);
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    /// @brief Заводит кольцо для рабочего потока (до start)
+    /// @param rings Сколько всего колец заводится на тест (задаёт ёмкость, см. TraceRing::capacityFor)
+    TraceRing* attach(size_t rings = 1);
+
+    /// @brief Ядра фонового потока (пусто - без привязки); действует со следующего start
+    void setThreadAffinity(std::vector<int> cpus) { affinity_ = std::move(cpus); }
+
+    /// @brief Запоминает начало отсчёта и запускает фоновый поток
+    void start(std::chrono::steady_clock::time_point origin);
+
+    /// @brief Останавливает поток, дописывает остатки, обновляет заголовок и закрывает файл
+    /// @details Рабочие потоки к этому моменту уже не должны писать в кольца
+    void stop();
+
+    /// @brief Записано записей
+    uint64_t written() const { return written_; }
+
+    /// @brief Отброшено записей при переполнении колец
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    void run();
+    void drain(bool final);
+    bool flush();
+
+    int fd_ = -1;
+    std::string path_;
+    TraceFileHeader header_;
+    std::vector<std::unique_ptr<TraceRing>> rings_;
+    std::vector<char> buffer_;                  //< Накопленные записи до записи в файл
+    uint64_t written_ = 0;
+    uint64_t dropped_ = 0;
+    bool write_failed_ = false;
+
+    std::thread thread_;
+    std::vector<int> affinity_;                 //< Ядра фонового потока
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+};
+
+#endif // REQUEST_TRACE_HPP
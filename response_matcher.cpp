@@ -0,0 +1,365 @@
+/// @file response_matcher.cpp
+/// @brief Реализация скомпилированных проверок ответа
+
+#include "response_matcher.hpp"
+#include "json_scan.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <utility>
+
+using json = nlohmann::json;
+
+/// @brief Состояние одного разбора тела ответа
+struct ResponseMatcher::MatchState {
+    unsigned char* decided;     //< Флаги решённых проверок
+    size_t remaining;           //< Сколько проверок ещё не решено
+    bool failed;                //< Какая-то проверка не прошла
+    bool stop;                  //< Исход известен, разбор можно прекратить
+    std::string* scratch;       //< Буфер для строк с escape-последовательностями
+};
+
+/// @brief Сравнение строк без учёта регистра
+static bool equalsIgnoreCase(const char* data, size_t size, const char* literal) {
+    size_t i = 0;
+    for (; i < size && literal[i]; ++i) {
+        if (std::tolower(static_cast<unsigned char>(data[i])) != literal[i]) {
+            return false;
+        }
+    }
+    return i == size && literal[i] == '\0';
+}
+
+/// @brief Разбивает путь "data.items[2].id" на сегменты (имя, индекс)
+static std::vector<std::pair<std::string, long>> parsePath(const std::string& path) {
+    std::vector<std::pair<std::string, long>> segments;
+    auto push = [&segments](const std::string& key) {
+        long index = -1;
+        if (!key.empty() && std::all_of(key.begin(), key.end(), ::isdigit)) {
+            index = std::strtol(key.c_str(), nullptr, 10);
+        }
+        segments.emplace_back(key, index);
+    };
+
+    std::string current;
+    for (size_t i = 0; i < path.size(); ++i) {
+        char c = path[i];
+        if (c == '.') {
+            if (!current.empty()) {
+                push(current);
+                current.clear();
+            }
+        } else if (c == '[') {
+            if (!current.empty()) {
+                push(current);
+                current.clear();
+            }
+            size_t close = path.find(']', i);
+            if (close == std::string::npos) {
+                close = path.size();
+            }
+            push(path.substr(i + 1, close - i - 1));
+            i = close;
+        } else {
+            current.push_back(c);
+        }
+    }
+    if (!current.empty()) {
+        push(current);
+    }
+    return segments;
+}
+
+ResponseMatcher::ResponseMatcher() : nodes_(1), accepted_statuses_{200} {
+}
+
+void ResponseMatcher::setBodyChecks(const std::vector<ResponseCheckConfig>& checks) {
+    nodes_.assign(1, Node());
+    checks_.clear();
+
+    for (const auto& config : checks) {
+        int node = 0;
+        for (const auto& [key, index] : parsePath(config.field_path)) {
+            int child = -1;
+            for (int candidate : nodes_[node].children) {
+                if (nodes_[candidate].key == key) {
+                    child = candidate;
+                    break;
+                }
+            }
+            if (child < 0) {
+                child = static_cast<int>(nodes_.size());
+                Node created;
+                created.key = key;
+                created.index = index;
+                nodes_.push_back(std::move(created));
+                nodes_[node].children.push_back(child);
+            }
+            node = child;
+        }
+
+        Check check;
+        check.check_exists = config.check_exists;
+        const std::string& expected = config.expected_value;
+        check.expected = expected;
+        if (expected.empty()) {
+            check.kind = ExpectedKind::Any;
+        } else if (equalsIgnoreCase(expected.data(), expected.size(), "true") ||
+                   equalsIgnoreCase(expected.data(), expected.size(), "false")) {
+            check.kind = ExpectedKind::Boolean;
+            check.expected_bool = std::tolower(static_cast<unsigned char>(expected[0])) == 't';
+        } else if (equalsIgnoreCase(expected.data(), expected.size(), "null") ||
+                   equalsIgnoreCase(expected.data(), expected.size(), "none")) {
+            check.kind = ExpectedKind::Null;
+        } else if ((expected[0] == '{' || expected[0] == '[') && json::accept(expected)) {
+            check.kind = ExpectedKind::Document;
+            check.document = json::parse(expected);
+        } else {
+            check.kind = ExpectedKind::Text;
+            // Значение в кавычках (как его печатает dump()) сравниваем по содержимому
+            if (expected.size() >= 2 && expected.front() == '"' && expected.back() == '"' &&
+                json::accept(expected)) {
+                check.expected = json::parse(expected).get<std::string>();
+            }
+            char* end = nullptr;
+            check.number = std::strtod(check.expected.c_str(), &end);
+            check.is_number = !check.expected.empty() && end == check.expected.c_str() + check.expected.size();
+        }
+
+        nodes_[node].checks.push_back(static_cast<int>(checks_.size()));
+        checks_.push_back(std::move(check));
+    }
+}
+
+void ResponseMatcher::addAcceptedStatus(long status) {
+    // Первый явно заданный код заменяет значение по умолчанию
+    if (!explicit_statuses_) {
+        accepted_statuses_.clear();
+        explicit_statuses_ = true;
+    }
+    accepted_statuses_.push_back(status);
+}
+
+void ResponseMatcher::clearAcceptedStatuses() {
+    accepted_statuses_.assign(1, 200);
+    explicit_statuses_ = false;
+}
+
+void ResponseMatcher::addHeaderCheck(const HeaderCheckConfig& check) {
+    header_checks_.push_back(check);
+}
+
+void ResponseMatcher::clearHeaderChecks() {
+    header_checks_.clear();
+}
+
+void ResponseMatcher::setBodySizeLimits(size_t min_bytes, size_t max_bytes) {
+    min_body_size_ = min_bytes;
+    max_body_size_ = max_bytes;
+}
+
+bool ResponseMatcher::statusAccepted(long status) const {
+    return std::find(accepted_statuses_.begin(), accepted_statuses_.end(), status) !=
+           accepted_statuses_.end();
+}
+
+bool ResponseMatcher::bodySizeAccepted(size_t size) const {
+    return size >= min_body_size_ && (max_body_size_ == 0 || size <= max_body_size_);
+}
+
+int ResponseMatcher::childByKey(int node, const char* key, size_t size) const {
+    for (int child : nodes_[node].children) {
+        const std::string& name = nodes_[child].key;
+        if (name.size() == size && name.compare(0, size, key, size) == 0) {
+            return child;
+        }
+    }
+    return -1;
+}
+
+int ResponseMatcher::childByIndex(int node, long index) const {
+    for (int child : nodes_[node].children) {
+        if (nodes_[child].index == index) {
+            return child;
+        }
+    }
+    return -1;
+}
+
+bool ResponseMatcher::compare(const Check& check, const char* data, size_t size,
+                              bool is_string, bool escaped) const {
+    if (check.kind == ExpectedKind::Any) {
+        return true;
+    }
+
+    if (is_string) {
+        // Строку сравниваем с ожидаемым текстом при любом виде ожидаемого значения
+        if (!escaped) {
+            return check.expected.size() == size && check.expected.compare(0, size, data, size) == 0;
+        }
+        thread_local std::string unescaped;
+        return unescapeJsonString(data, size, unescaped) && unescaped == check.expected;
+    }
+
+    switch (check.kind) {
+    case ExpectedKind::Boolean:
+        return (data[0] == 't' || data[0] == 'f') && check.expected_bool == (data[0] == 't');
+    case ExpectedKind::Null:
+        return data[0] == 'n';
+    case ExpectedKind::Document:
+        if (data[0] != '{' && data[0] != '[') {
+            return false;
+        }
+        // Редкий случай: сравнение целого поддерева требует построить его
+        return json::parse(data, data + size, nullptr, false) == check.document;
+    case ExpectedKind::Text: {
+        if (check.expected.size() == size && check.expected.compare(0, size, data, size) == 0) {
+            return true;
+        }
+        bool is_number = data[0] == '-' || (data[0] >= '0' && data[0] <= '9');
+        if (!check.is_number || !is_number || size >= 64) {
+            return false;
+        }
+        char number[64];
+        std::copy(data, data + size, number);
+        number[size] = '\0';
+        return std::strtod(number, nullptr) == check.number;
+    }
+    default:
+        return false;
+    }
+}
+
+void ResponseMatcher::decide(int node, const char* data, size_t size, bool is_string,
+                             bool escaped, MatchState& state) const {
+    for (int id : nodes_[node].checks) {
+        if (state.decided[id]) {
+            continue;
+        }
+        state.decided[id] = 1;
+        --state.remaining;
+        if (!compare(checks_[id], data, size, is_string, escaped)) {
+            state.failed = true;
+            state.stop = true;
+            return;
+        }
+    }
+    if (state.remaining == 0) {
+        state.stop = true;
+    }
+}
+
+bool ResponseMatcher::walk(JsonCursor& cursor, int node, int depth, MatchState& state) const {
+    cursor.skipWhitespace();
+    if (cursor.atEnd() || depth > JsonCursor::kMaxDepth) {
+        return false;
+    }
+
+    const char* begin = cursor.p;
+    const char* data;
+    size_t size;
+    bool escaped;
+
+    switch (*cursor.p) {
+    case '{':
+        ++cursor.p;
+        if (cursor.consume('}')) {
+            break;
+        }
+        do {
+            cursor.skipWhitespace();
+            if (!cursor.readString(data, size, escaped) || !cursor.consume(':')) {
+                return false;
+            }
+            int child;
+            if (escaped) {
+                if (!unescapeJsonString(data, size, *state.scratch)) {
+                    return false;
+                }
+                child = childByKey(node, state.scratch->data(), state.scratch->size());
+            } else {
+                child = childByKey(node, data, size);
+            }
+            if (child < 0 ? !cursor.skipValue(depth + 1) : !walk(cursor, child, depth + 1, state)) {
+                return false;
+            }
+        } while (cursor.consume(','));
+        if (!cursor.consume('}')) {
+            return false;
+        }
+        break;
+    case '[': {
+        ++cursor.p;
+        if (cursor.consume(']')) {
+            break;
+        }
+        long index = 0;
+        do {
+            int child = childByIndex(node, index++);
+            if (child < 0 ? !cursor.skipValue(depth + 1) : !walk(cursor, child, depth + 1, state)) {
+                return false;
+            }
+        } while (cursor.consume(','));
+        if (!cursor.consume(']')) {
+            return false;
+        }
+        break;
+    }
+    case '"':
+        if (!cursor.readString(data, size, escaped)) {
+            return false;
+        }
+        decide(node, data, size, true, escaped, state);
+        return !state.stop;
+    default:
+        if (!cursor.readScalar(data, size)) {
+            return false;
+        }
+        decide(node, data, size, false, false, state);
+        return !state.stop;
+    }
+
+    if (!nodes_[node].checks.empty()) {
+        decide(node, begin, static_cast<size_t>(cursor.p - begin), false, false, state);
+    }
+    return !state.stop;
+}
+
+bool ResponseMatcher::matchBody(const char* data, size_t size) const {
+    JsonCursor cursor(data, size);
+
+    if (checks_.empty()) {
+        // Без проверок считаем любой валидный JSON успешным
+        if (!cursor.skipValue()) {
+            return false;
+        }
+        cursor.skipWhitespace();
+        return cursor.atEnd();
+    }
+
+    thread_local std::vector<unsigned char> decided;
+    thread_local std::string scratch;
+    decided.assign(checks_.size(), 0);
+
+    MatchState state{decided.data(), checks_.size(), false, false, &scratch};
+    bool parsed = walk(cursor, 0, 0, state);
+    if (state.stop) {
+        return !state.failed;
+    }
+    if (!parsed) {
+        return false;
+    }
+    cursor.skipWhitespace();
+    if (!cursor.atEnd()) {
+        return false;
+    }
+
+    // Поля, которых нет в ответе
+    for (size_t id = 0; id < checks_.size(); ++id) {
+        if (!decided[id] && checks_[id].check_exists) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,133 @@
+/// @file response_matcher.hpp
+/// @brief Скомпилированные проверки ответа сервера
+
+#ifndef RESPONSE_MATCHER_HPP
+#define RESPONSE_MATCHER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+struct JsonCursor;
+
+/**
+ * @struct ResponseCheckConfig
+ * @brief Структура поля ответа на входной запрос
+ */
+struct ResponseCheckConfig {
+    std::string field_path;         //< Путь к полю (например: "success", "data.status", "items[0].id")
+    std::string expected_value;     //< Ожидаемое значение
+    bool check_exists = true;       //< Проверять существование поля
+};
+
+/**
+ * @struct HeaderCheckConfig
+ * @brief Проверка заголовка ответа
+ */
+struct HeaderCheckConfig {
+    std::string name;               //< Имя заголовка (без учёта регистра)
+    std::string expected_value;     //< Ожидаемое значение (пусто - только наличие)
+};
+
+/**
+ * @class ResponseMatcher
+ * @brief Проверки ответа, скомпилированные в дерево путей
+ *
+ * Пути проверок сливаются в префиксное дерево. Тело ответа разбирается
+ * потоково прямо в буфере: поддеревья вне путей только пропускаются,
+ * значения сравниваются без построения DOM. Разбор прекращается, как
+ * только исход всех проверок известен. Методы match* не меняют
+ * состояние и безопасны для вызова из нескольких потоков.
+ */
+class ResponseMatcher {
+public:
+    ResponseMatcher();
+
+    /// @brief Компилирует проверки полей тела ответа
+    void setBodyChecks(const std::vector<ResponseCheckConfig>& checks);
+
+    /// @brief Добавляет допустимый код HTTP (по умолчанию допустим только 200)
+    void addAcceptedStatus(long status);
+
+    /// @brief Возвращает к допустимому коду 200
+    void clearAcceptedStatuses();
+
+    /// @brief Добавляет проверку заголовка ответа
+    void addHeaderCheck(const HeaderCheckConfig& check);
+
+    /// @brief Удаляет проверки заголовков
+    void clearHeaderChecks();
+
+    /// @brief Ограничивает размер тела ответа в байтах (max_bytes = 0 - без верхней границы)
+    void setBodySizeLimits(size_t min_bytes, size_t max_bytes);
+
+    /// @brief Допустим ли код HTTP
+    bool statusAccepted(long status) const;
+
+    /// @brief Укладывается ли размер тела в ограничения
+    bool bodySizeAccepted(size_t size) const;
+
+    /// @brief Допустимые коды HTTP
+    const std::vector<long>& acceptedStatuses() const { return accepted_statuses_; }
+
+    size_t minBodySize() const { return min_body_size_; }
+    size_t maxBodySize() const { return max_body_size_; }
+
+    /// @brief Проверки заголовков (выполняются вызывающей стороной по хэндлу CURL)
+    const std::vector<HeaderCheckConfig>& headerChecks() const { return header_checks_; }
+
+    /// @brief Проверяет поля тела ответа
+    /// @details Без проверок полей тело должно быть корректным JSON
+    bool matchBody(const char* data, size_t size) const;
+
+private:
+    /// @brief Вид ожидаемого значения
+    enum class ExpectedKind {
+        Any,        //< Значение не задано - достаточно наличия
+        Text,       //< Строка или число
+        Boolean,    //< true / false (без учёта регистра)
+        Null,       //< null / None
+        Document    //< Объект или массив
+    };
+
+    /// @brief Скомпилированная проверка поля
+    struct Check {
+        std::string expected;       //< Ожидаемое значение (без внешних кавычек)
+        ExpectedKind kind = ExpectedKind::Any;
+        bool expected_bool = false;
+        bool is_number = false;     //< Ожидаемое значение - число
+        double number = 0;
+        nlohmann::json document;    //< Ожидаемый объект или массив
+        bool check_exists = true;
+    };
+
+    /// @brief Узел дерева путей
+    struct Node {
+        std::string key;            //< Имя поля
+        long index = -1;            //< Индекс элемента массива (-1 - не индекс)
+        std::vector<int> children;  //< Дочерние узлы
+        std::vector<int> checks;    //< Проверки, привязанные к узлу
+    };
+
+    /// @brief Состояние одного разбора
+    struct MatchState;
+
+    int childByKey(int node, const char* key, size_t size) const;
+    int childByIndex(int node, long index) const;
+    bool walk(JsonCursor& cursor, int node, int depth, MatchState& state) const;
+    void decide(int node, const char* data, size_t size, bool is_string, bool escaped,
+                MatchState& state) const;
+    bool compare(const Check& check, const char* data, size_t size, bool is_string,
+                 bool escaped) const;
+
+    std::vector<Node> nodes_;                   //< Дерево путей, корень - nodes_[0]
+    std::vector<Check> checks_;                 //< Проверки полей
+    std::vector<long> accepted_statuses_;       //< Допустимые коды HTTP
+    bool explicit_statuses_ = false;            //< Коды заданы явно (200 уже не по умолчанию)
+    std::vector<HeaderCheckConfig> header_checks_; //< Проверки заголовков
+    size_t min_body_size_ = 0;                  //< Минимальный размер тела
+    size_t max_body_size_ = 0;                  //< Максимальный размер тела (0 - без ограничения)
+};
+
+#endif // RESPONSE_MATCHER_HPP
@@ -0,0 +1,56 @@
+/// @file scenario.cpp
+/// @brief Реализация выбора сценария по весам
+
+#include "scenario.hpp"
+
+#include <stdexcept>
+
+void AliasSampler::build(const std::vector<double>& weights) {
+    const size_t n = weights.size();
+    prob_.assign(n, 1.0);
+    alias_.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        alias_[i] = static_cast<uint32_t>(i);
+    }
+
+    double total = 0;
+    for (double weight : weights) {
+        if (weight < 0) {
+            throw std::invalid_argument("scenario weight must be non-negative");
+        }
+        total += weight;
+    }
+    if (n == 0 || total <= 0) {
+        throw std::invalid_argument("at least one scenario weight must be positive");
+    }
+
+    // Масштабируем веса так, чтобы средняя ячейка была ровно 1, и делим на
+    // "малые" (< 1) и "большие" ячейки: каждая малая добирает недостающее у большой
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * n / total;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+
+    while (!small.empty() && !large.empty()) {
+        uint32_t less = small.back();
+        small.pop_back();
+        uint32_t more = large.back();
+        large.pop_back();
+
+        prob_[less] = scaled[less];
+        alias_[less] = more;
+        scaled[more] = scaled[more] + scaled[less] - 1.0;
+        (scaled[more] < 1.0 ? small : large).push_back(more);
+    }
+
+    // Остатки из-за погрешности округления - полные ячейки
+    for (uint32_t i : large) {
+        prob_[i] = 1.0;
+    }
+    for (uint32_t i : small) {
+        prob_[i] = 1.0;
+    }
+}
@@ -0,0 +1,70 @@
+/// @file scenario.hpp
+/// @brief Сценарии нагрузки: взвешенная смесь запросов к разным эндпоинтам
+
+#ifndef SCENARIO_HPP
+#define SCENARIO_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fast_random.hpp"
+#include "latency_histogram.hpp"
+#include "response_matcher.hpp"
+#include "worker_stats.hpp"
+
+/**
+ * @struct ScenarioConfig
+ * @brief Описание одного вида запроса в смеси
+ */
+struct ScenarioConfig {
+    std::string name;                           //< Имя сценария в отчёте
+    std::string url;                            //< Целевой URL
+    std::string method = "POST";                //< Метод HTTP (GET, POST, PUT, PATCH, DELETE...)
+    std::vector<std::string> headers;           //< Дополнительные заголовки "Имя: значение"
+    std::string body_template;                  //< JSON-шаблон тела ("{{random:MIN:MAX}}"), пусто - без тела
+    std::vector<ResponseCheckConfig> checks;    //< Проверки полей ответа
+    std::vector<long> accepted_statuses;        //< Допустимые коды HTTP (пусто - только 200)
+    double weight = 1.0;                        //< Доля сценария в смеси (относительная)
+};
+
+/**
+ * @class AliasSampler
+ * @brief Выбор индекса по весам за O(1) (метод Уолкера, построение Воуза)
+ *
+ * Таблица строится один раз; выбор - одно случайное целое и одно
+ * сравнение с вероятностью ячейки, независимо от числа сценариев.
+ */
+class AliasSampler {
+public:
+    /// @brief Строит таблицу по неотрицательным весам (хотя бы один положительный)
+    void build(const std::vector<double>& weights);
+
+    /// @brief Выбирает индекс с вероятностью, пропорциональной весу
+    size_t sample(Xoshiro256& rng) const {
+        if (prob_.size() <= 1) {
+            return 0;
+        }
+        size_t column = static_cast<size_t>(rng.uniformInt(0, static_cast<int64_t>(prob_.size()) - 1));
+        return rng.uniformDouble() < prob_[column] ? column : alias_[column];
+    }
+
+    size_t size() const { return prob_.size(); }
+
+private:
+    std::vector<double> prob_;      //< Вероятность остаться в ячейке
+    std::vector<uint32_t> alias_;   //< Альтернатива ячейки
+};
+
+/**
+ * @struct ScenarioStats
+ * @brief Статистика одного сценария в одном рабочем потоке
+ *
+ * Как и общие счётчики, пишется только потоком-владельцем.
+ */
+struct ScenarioStats {
+    WorkerCounters counters;        //< Счётчики сценария (выровнены по кэш-линии)
+    HistogramRecorder latency;      //< Задержки сценария
+};
+
+#endif // SCENARIO_HPP
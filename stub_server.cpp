@@ -0,0 +1,474 @@
+/// @file stub_server.cpp
+/// @brief Реализация HTTP-заглушки на epoll
+
+#include "stub_server.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <queue>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "fast_random.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kMaxHeaderBytes = 64 * 1024;   // Больше - не HTTP-клиент, закрываем соединение
+
+/// @brief Ответ в очереди соединения
+struct PendingResponse {
+    Clock::time_point ready;            //< Когда можно отправлять
+    const std::string* shared = nullptr; //< Заранее собранный ответ
+    std::string owned;                  //< Собранный под запрос ответ (/echo)
+};
+
+/// @brief Соединение клиента
+struct Connection {
+    int fd = -1;
+    uint64_t id = 0;                    //< Уникален в пределах потока (дескрипторы переиспользуются)
+    std::string in;                     //< Принятые, ещё не разобранные байты
+    std::string out;                    //< Готовые к записи байты
+    size_t out_offset = 0;              //< Уже записано из out
+    std::deque<PendingResponse> pending; //< Ответы по порядку запросов
+    bool close_after = false;           //< Клиент попросил Connection: close
+    bool want_write = false;            //< Подписаны на EPOLLOUT
+};
+
+/// @brief Таймер задержанного ответа
+struct Timer {
+    Clock::time_point when;
+    int fd;
+    uint64_t id;
+
+    bool operator>(const Timer& other) const { return when > other.when; }
+};
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 504: return "Gateway Timeout";
+    default: return "Error";
+    }
+}
+
+std::string buildResponse(int status, const std::string& body) {
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reasonPhrase(status) + "\r\n";
+    response += "Content-Type: application/json\r\n";
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+    response += body;
+    return response;
+}
+
+/// @brief Ищет заголовок без учёта регистра в блоке заголовков
+/// @return Значение без ведущих пробелов или пустая строка
+std::string headerValue(const char* headers, size_t size, const char* name) {
+    const size_t name_size = std::strlen(name);
+    size_t line = 0;
+    while (line < size) {
+        const char* eol = static_cast<const char*>(std::memchr(headers + line, '\n', size - line));
+        size_t line_end = eol ? static_cast<size_t>(eol - headers) : size;
+        if (line_end - line > name_size && headers[line + name_size] == ':' &&
+            strncasecmp(headers + line, name, name_size) == 0) {
+            size_t value = line + name_size + 1;
+            while (value < line_end && headers[value] == ' ') {
+                ++value;
+            }
+            size_t value_end = line_end;
+            while (value_end > value && (headers[value_end - 1] == '\r' || headers[value_end - 1] == ' ')) {
+                --value_end;
+            }
+            return std::string(headers + value, value_end - value);
+        }
+        line = line_end + 1;
+    }
+    return std::string();
+}
+
+int openListener(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 1024) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+/// @brief Состояние событийного цикла одного потока
+struct StubServer::Loop {
+    int epoll_fd = -1;
+    int listen_fd = -1;
+    int wake_fd = -1;                   //< eventfd остановки
+    int timer_fd = -1;                  //< timerfd ближайшего задержанного ответа
+    Clock::time_point armed{};          //< На какой момент взведён timer_fd
+    Xoshiro256 rng;
+    std::atomic<uint64_t> served{0};    //< Пишет только поток цикла
+    uint64_t next_id = 1;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    std::string ok_response;            //< Заранее собранный успешный ответ
+    std::string error_response;         //< Заранее собранный ответ с ошибкой
+
+    ~Loop() {
+        for (auto& entry : connections) {
+            close(entry.first);
+        }
+        for (int fd : {epoll_fd, listen_fd, wake_fd, timer_fd}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+};
+
+StubServer::StubServer() = default;
+
+StubServer::~StubServer() {
+    stop();
+}
+
+bool StubServer::start(const StubServerConfig& config) {
+    stop();
+    served_stopped_ = 0;
+    config_ = config;
+    config_.threads = std::max(1, config_.threads);
+    stopping_ = false;
+
+    // Тело успешного ответа дополняется полем pad до заданного размера
+    std::string ok_body = "{\"success\": true, \"status\": \"ok\", \"data\": {\"status\": \"ready\"}";
+    const std::string pad_prefix = ", \"pad\": \"";
+    if (config_.response_size > ok_body.size() + pad_prefix.size() + 2) {
+        ok_body += pad_prefix + std::string(config_.response_size - ok_body.size() - pad_prefix.size() - 2, 'x') + "\"";
+    }
+    ok_body += "}";
+    const std::string ok_response = buildResponse(200, ok_body);
+    const std::string error_response = buildResponse(config_.error_status, "{\"success\": false, \"status\": \"error\"}");
+
+    int port = config_.port;
+    for (int i = 0; i < config_.threads; ++i) {
+        auto loop = std::make_unique<Loop>();
+        loop->rng.reseed(config_.seed + static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull);
+        loop->ok_response = ok_response;
+        loop->error_response = error_response;
+        loop->listen_fd = openListener(port);
+        loop->epoll_fd = epoll_create1(0);
+        loop->wake_fd = eventfd(0, EFD_NONBLOCK);
+        loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        if (loop->listen_fd < 0 || loop->epoll_fd < 0 || loop->wake_fd < 0 || loop->timer_fd < 0) {
+            loops_.clear();
+            return false;
+        }
+        if (port == 0) {
+            // Первый сокет выбрал свободный порт - остальные занимают его же
+            sockaddr_in address{};
+            socklen_t length = sizeof(address);
+            getsockname(loop->listen_fd, reinterpret_cast<sockaddr*>(&address), &length);
+            port = ntohs(address.sin_port);
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = loop->listen_fd;
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->listen_fd, &event);
+        event.data.fd = loop->wake_fd;
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &event);
+        event.data.fd = loop->timer_fd;
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->timer_fd, &event);
+        loops_.push_back(std::move(loop));
+    }
+    port_ = port;
+
+    for (auto& loop : loops_) {
+        threads_.emplace_back([this, &loop = *loop]() { runLoop(loop); });
+    }
+    return true;
+}
+
+void StubServer::stop() {
+    stopping_ = true;
+    for (auto& loop : loops_) {
+        uint64_t one = 1;
+        ssize_t written = write(loop->wake_fd, &one, sizeof(one));
+        (void)written;
+    }
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+    for (const auto& loop : loops_) {
+        served_stopped_ += loop->served.load(std::memory_order_relaxed);
+    }
+    loops_.clear();
+}
+
+uint64_t StubServer::requestsServed() const {
+    uint64_t total = served_stopped_;
+    for (const auto& loop : loops_) {
+        total += loop->served.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void StubServer::runLoop(Loop& loop) {
+    const StubServerConfig& config = config_;
+
+    auto sampleDelay = [&]() -> Clock::duration {
+        const double mean = config.mean_latency_us;
+        double us = 0;
+        switch (config.latency) {
+        case StubLatency::None:
+            return Clock::duration::zero();
+        case StubLatency::Fixed:
+            us = mean;
+            break;
+        case StubLatency::Uniform:
+            us = 2 * mean * loop.rng.uniformDouble();
+            break;
+        case StubLatency::Exponential:
+            us = -mean * std::log(1.0 - loop.rng.uniformDouble());
+            break;
+        case StubLatency::LogNormal: {
+            // Box-Muller; mu выбрано так, чтобы среднее было равно mean
+            const double sigma = config.latency_sigma;
+            const double u1 = 1.0 - loop.rng.uniformDouble();
+            const double u2 = loop.rng.uniformDouble();
+            const double normal = std::sqrt(-2.0 * std::log(u1)) * std::cos(2 * M_PI * u2);
+            us = std::exp(std::log(std::max(mean, 1e-3)) - sigma * sigma / 2 + sigma * normal);
+            break;
+        }
+        }
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(us));
+    };
+
+    auto closeConnection = [&](Connection& conn) {
+        epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, conn.fd, nullptr);
+        close(conn.fd);
+        loop.connections.erase(conn.fd);
+    };
+
+    // Переносит готовые ответы в буфер записи и пишет, сколько примет сокет.
+    // Возвращает false, если соединение закрыто
+    auto flush = [&](Connection& conn) -> bool {
+        const auto now = Clock::now();
+        while (!conn.pending.empty() && conn.pending.front().ready <= now) {
+            const PendingResponse& response = conn.pending.front();
+            conn.out += response.shared ? *response.shared : response.owned;
+            conn.pending.pop_front();
+        }
+
+        while (conn.out_offset < conn.out.size()) {
+            ssize_t n = send(conn.fd, conn.out.data() + conn.out_offset, conn.out.size() - conn.out_offset,
+                             MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.out_offset += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            closeConnection(conn);
+            return false;
+        }
+        if (conn.out_offset == conn.out.size()) {
+            conn.out.clear();
+            conn.out_offset = 0;
+        }
+
+        if (conn.close_after && conn.out.empty() && conn.pending.empty()) {
+            closeConnection(conn);
+            return false;
+        }
+
+        const bool want_write = !conn.out.empty();
+        if (want_write != conn.want_write) {
+            epoll_event event{};
+            event.events = want_write ? (EPOLLIN | EPOLLOUT) : static_cast<uint32_t>(EPOLLIN);
+            event.data.fd = conn.fd;
+            epoll_ctl(loop.epoll_fd, EPOLL_CTL_MOD, conn.fd, &event);
+            conn.want_write = want_write;
+        }
+        return true;
+    };
+
+    // Разбирает все полные запросы в буфере (клиент может слать их конвейером)
+    auto handleRequests = [&](Connection& conn) -> bool {
+        size_t offset = 0;
+        while (true) {
+            const size_t header_end = conn.in.find("\r\n\r\n", offset);
+            if (header_end == std::string::npos) {
+                if (conn.in.size() - offset > kMaxHeaderBytes) {
+                    closeConnection(conn);
+                    return false;
+                }
+                break;
+            }
+            const char* headers = conn.in.data() + offset;
+            const size_t headers_size = header_end - offset;
+            const size_t content_length = static_cast<size_t>(
+                std::strtoull(headerValue(headers, headers_size, "Content-Length").c_str(), nullptr, 10));
+            const size_t request_end = header_end + 4 + content_length;
+            if (conn.in.size() < request_end) {
+                break;
+            }
+
+            const char* path = static_cast<const char*>(std::memchr(headers, ' ', headers_size));
+            const bool echo = path && static_cast<size_t>(headers + headers_size - path) > 5 &&
+                              std::memcmp(path + 1, "/echo", 5) == 0;
+            const std::string connection = headerValue(headers, headers_size, "Connection");
+            if (strcasecmp(connection.c_str(), "close") == 0) {
+                conn.close_after = true;
+            }
+
+            PendingResponse response;
+            response.ready = Clock::now() + sampleDelay();
+            if (config.error_rate > 0 && loop.rng.uniformDouble() < config.error_rate) {
+                response.shared = &loop.error_response;
+            } else if (echo) {
+                response.owned = buildResponse(200, content_length > 0
+                    ? conn.in.substr(header_end + 4, content_length) : std::string("{}"));
+            } else {
+                response.shared = &loop.ok_response;
+            }
+            if (response.ready > Clock::now()) {
+                loop.timers.push({response.ready, conn.fd, conn.id});
+            }
+            conn.pending.push_back(std::move(response));
+            loop.served.store(loop.served.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            offset = request_end;
+            if (conn.close_after) {
+                break;
+            }
+        }
+        conn.in.erase(0, offset);
+        return true;
+    };
+
+    std::vector<epoll_event> events(256);
+    char buffer[65536];
+    while (!stopping_.load(std::memory_order_relaxed)) {
+        // Таймаут epoll_wait - целые миллисекунды, поэтому срок ближайшего
+        // ответа отмеряет timerfd (steady_clock в Linux - это CLOCK_MONOTONIC)
+        if (!loop.timers.empty() && loop.timers.top().when != loop.armed) {
+            loop.armed = loop.timers.top().when;
+            const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                loop.armed.time_since_epoch()).count();
+            itimerspec spec{};
+            spec.it_value.tv_sec = static_cast<time_t>(since_epoch / 1000000000);
+            spec.it_value.tv_nsec = static_cast<long>(since_epoch % 1000000000);
+            if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+                spec.it_value.tv_nsec = 1;  // Нулевое значение снимает таймер
+            }
+            timerfd_settime(loop.timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+        }
+        int count = epoll_wait(loop.epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+        if (count < 0 && errno != EINTR) {
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == loop.wake_fd) {
+                continue;
+            }
+            if (fd == loop.timer_fd) {
+                uint64_t expirations = 0;
+                ssize_t got = read(loop.timer_fd, &expirations, sizeof(expirations));
+                (void)got;
+                loop.armed = Clock::time_point{};
+                continue;
+            }
+            if (fd == loop.listen_fd) {
+                while (true) {
+                    int client = accept4(loop.listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+                    if (client < 0) {
+                        break;
+                    }
+                    int one = 1;
+                    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    auto conn = std::make_unique<Connection>();
+                    conn->fd = client;
+                    conn->id = loop.next_id++;
+                    epoll_event event{};
+                    event.events = EPOLLIN;
+                    event.data.fd = client;
+                    epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, client, &event);
+                    loop.connections[client] = std::move(conn);
+                }
+                continue;
+            }
+
+            auto it = loop.connections.find(fd);
+            if (it == loop.connections.end()) {
+                continue;
+            }
+            Connection& conn = *it->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(conn);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    closeConnection(conn);
+                    continue;
+                }
+                if (n > 0) {
+                    conn.in.append(buffer, static_cast<size_t>(n));
+                    if (!handleRequests(conn)) {
+                        continue;
+                    }
+                }
+            }
+            flush(conn);
+        }
+
+        // Задержанные ответы, чей срок наступил
+        const auto now = Clock::now();
+        while (!loop.timers.empty() && loop.timers.top().when <= now) {
+            const Timer timer = loop.timers.top();
+            loop.timers.pop();
+            auto it = loop.connections.find(timer.fd);
+            if (it != loop.connections.end() && it->second->id == timer.id) {
+                flush(*it->second);
+            }
+        }
+    }
+}
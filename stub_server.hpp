@@ -0,0 +1,90 @@
+/// @file stub_server.hpp
+/// @brief Локальный HTTP-сервер-заглушка на epoll для замеров генератора
+
+#ifndef STUB_SERVER_HPP
+#define STUB_SERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @enum StubLatency
+ * @brief Распределение искусственной задержки ответа
+ */
+enum class StubLatency {
+    None,           //< Ответ сразу
+    Fixed,          //< Ровно mean_us
+    Uniform,        //< Равномерно в [0, 2 * mean_us]
+    Exponential,    //< Экспоненциальное со средним mean_us
+    LogNormal       //< Логнормальное со средним mean_us и параметром формы sigma
+};
+
+/**
+ * @struct StubServerConfig
+ * @brief Поведение заглушки
+ */
+struct StubServerConfig {
+    int port = 18080;                   //< Порт (0 - выбрать свободный)
+    int threads = 1;                    //< Событийных циклов (каждый со своим сокетом, SO_REUSEPORT)
+    StubLatency latency = StubLatency::None; //< Распределение задержки
+    double mean_latency_us = 0;         //< Средняя задержка, мкс
+    double latency_sigma = 1.0;         //< Параметр формы логнормального распределения
+    double error_rate = 0;              //< Доля ответов с ошибкой (0..1)
+    int error_status = 503;             //< Код ответа с ошибкой
+    size_t response_size = 128;         //< Размер тела успешного ответа, байт
+    uint64_t seed = 1;                  //< Зерно генераторов задержки и ошибок
+};
+
+/**
+ * @class StubServer
+ * @brief HTTP/1.1-заглушка: keep-alive, конвейерные запросы, задержка без блокировок
+ *
+ * Каждый поток - свой epoll и свой слушающий сокет на общем порту
+ * (SO_REUSEPORT), поэтому потоки не делят ни очередь соединений, ни
+ * блокировки. Ответы собраны заранее; задержанные ответы ждут в куче
+ * таймеров потока, и цикл не спит ни на одном соединении.
+ *
+ * Успешный ответ - JSON {"success": true, "status": "ok", "data": {"status": "ready"}, ...},
+ * дополненный до response_size. Запрос на путь /echo возвращает тело запроса.
+ */
+class StubServer {
+public:
+    StubServer();
+    ~StubServer();
+
+    StubServer(const StubServer&) = delete;
+    StubServer& operator=(const StubServer&) = delete;
+
+    /// @brief Занимает порт и запускает потоки
+    /// @return false, если порт занять не удалось
+    bool start(const StubServerConfig& config);
+
+    /// @brief Останавливает потоки и закрывает соединения
+    void stop();
+
+    /// @brief Фактический порт (после start)
+    int port() const { return port_; }
+
+    /// @brief Обслужено запросов с последнего start (доступно и после stop)
+    uint64_t requestsServed() const;
+
+private:
+    struct Loop;
+
+    /// @brief Событийный цикл одного потока
+    void runLoop(Loop& loop);
+
+    StubServerConfig config_;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    uint64_t served_stopped_ = 0;       //< Обслужено остановленными циклами
+    std::vector<std::unique_ptr<Loop>> loops_;
+    std::vector<std::thread> threads_;
+};
+
+#endif // STUB_SERVER_HPP
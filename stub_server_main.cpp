@@ -0,0 +1,101 @@
+/// @file stub_server_main.cpp
+/// @brief Запуск HTTP-заглушки из командной строки
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+#include "stub_server.hpp"
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--port PORT] [--threads N]\n"
+              << "       [--latency none|fixed|uniform|exp|lognormal] [--mean-us US] [--sigma S]\n"
+              << "       [--error-rate P] [--error-status CODE] [--response-size BYTES] [--seed N]"
+              << std::endl;
+}
+
+bool parseLatency(const std::string& name, StubLatency& latency) {
+    if (name == "none") {
+        latency = StubLatency::None;
+    } else if (name == "fixed") {
+        latency = StubLatency::Fixed;
+    } else if (name == "uniform") {
+        latency = StubLatency::Uniform;
+    } else if (name == "exp" || name == "exponential") {
+        latency = StubLatency::Exponential;
+    } else if (name == "lognormal") {
+        latency = StubLatency::LogNormal;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    StubServerConfig config;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "--port") == 0 && has_value) {
+            config.port = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--threads") == 0 && has_value) {
+            config.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--latency") == 0 && has_value) {
+            if (!parseLatency(argv[++i], config.latency)) {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else if (std::strcmp(arg, "--mean-us") == 0 && has_value) {
+            config.mean_latency_us = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--sigma") == 0 && has_value) {
+            config.latency_sigma = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--error-rate") == 0 && has_value) {
+            config.error_rate = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--error-status") == 0 && has_value) {
+            config.error_status = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--response-size") == 0 && has_value) {
+            config.response_size = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(arg, "--seed") == 0 && has_value) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (config.latency != StubLatency::None && config.mean_latency_us <= 0) {
+        std::cerr << "--mean-us must be positive for --latency other than none" << std::endl;
+        return 2;
+    }
+
+    StubServer server;
+    if (!server.start(config)) {
+        std::cerr << "Failed to listen on port " << config.port << std::endl;
+        return 1;
+    }
+    std::cout << "Stub server listening on 127.0.0.1:" << server.port()
+              << " (" << config.threads << " threads)" << std::endl;
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    while (!g_stop) {
+        pause();
+    }
+
+    server.stop();
+    std::cout << "Requests served: " << server.requestsServed() << std::endl;
+    return 0;
+}
@@ -0,0 +1,514 @@
+/// @file unit_tests.cpp
+/// @brief Модульные тесты чистых функций: гистограмма, шаблоны тела, генераторы,
+/// проверки ответа, воспроизведение записей и пороги регрессии
+///
+/// Без фреймворка: CHECK печатает место провала и продолжает, код возврата -
+/// число проваленных проверок. Запуск: ctest или ./unit_tests
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <regex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "body_template.hpp"
+#include "cpu_affinity.hpp"
+#include "fast_random.hpp"
+#include "field_generators.hpp"
+#include "latency_histogram.hpp"
+#include "regression_gate.hpp"
+#include "replay_source.hpp"
+#include "response_matcher.hpp"
+#include "scenario.hpp"
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__,   \
+                         #condition);                                               \
+            ++failures;                                                             \
+        }                                                                           \
+    } while (0)
+
+/// @brief Проверяет, что выражение бросает исключение типа E
+template <typename E>
+bool throwsAs(const std::function<void()>& action) {
+    try {
+        action();
+    } catch (const E&) {
+        return true;
+    } catch (...) {
+        return false;
+    }
+    return false;
+}
+
+/// @brief Временный файл с заданным содержимым, удаляется в деструкторе
+class TempFile {
+public:
+    TempFile(const std::string& suffix, const std::string& content) {
+        char pattern[] = "/tmp/load_tester_testXXXXXX";
+        int fd = mkstemp(pattern);
+        if (fd >= 0) {
+            close(fd);
+        }
+        path_ = std::string(pattern) + suffix;
+        std::rename(pattern, path_.c_str());
+        std::ofstream(path_, std::ios::binary) << content;
+    }
+    ~TempFile() { std::remove(path_.c_str()); }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+std::string render(const BodyTemplate& body, Xoshiro256& rng, GeneratorState& state) {
+    std::string out;
+    body.render(out, rng, state);
+    return out;
+}
+
+// === Гистограмма задержек ===
+
+void testHistogramBuckets() {
+    // Значения меньше числа подкорзин хранятся точно
+    for (uint64_t v = 0; v < LatencyHistogram::kSubBuckets; ++v) {
+        const size_t index = LatencyHistogram::bucketIndex(v);
+        CHECK(LatencyHistogram::bucketLower(index) == v);
+        CHECK(LatencyHistogram::bucketUpper(index) == v + 1);
+    }
+    // Корзина содержит своё значение, относительная ширина не больше 1/kSubBuckets
+    for (uint64_t v : {1000ull, 123456ull, 999999999ull, (1ull << 40) + 12345}) {
+        const size_t index = LatencyHistogram::bucketIndex(v);
+        const uint64_t lower = LatencyHistogram::bucketLower(index);
+        const uint64_t upper = LatencyHistogram::bucketUpper(index);
+        CHECK(lower <= v && v < upper);
+        CHECK(static_cast<double>(upper - lower) / lower <= 1.0 / LatencyHistogram::kSubBuckets);
+    }
+}
+
+void testHistogramPercentiles() {
+    LatencyHistogram histogram;
+    CHECK(histogram.percentile(99) == 0);
+    for (uint64_t v = 1; v <= 100; ++v) {
+        histogram.record(v);
+    }
+    CHECK(histogram.count() == 100);
+    CHECK(histogram.percentile(50) == 50);
+    CHECK(histogram.percentile(99) == 99);
+    CHECK(histogram.percentile(100) == 100);
+    CHECK(histogram.max() == 100);
+    CHECK(std::fabs(histogram.mean() - 50.5) < 1e-9);
+
+    // Большие значения - с точностью корзины
+    LatencyHistogram coarse;
+    coarse.record(5000000, 99);
+    coarse.record(80000000);
+    const double p50 = static_cast<double>(coarse.percentile(50));
+    CHECK(std::fabs(p50 - 5000000) / 5000000 < 1.0 / LatencyHistogram::kSubBuckets);
+    CHECK(coarse.percentile(100) == 80000000);
+}
+
+void testHistogramMergeAndSubtract() {
+    LatencyHistogram a;
+    LatencyHistogram b;
+    a.record(10, 3);
+    b.record(20, 2);
+    b.record(1000000);
+
+    LatencyHistogram merged = a;
+    merged.merge(b);
+    CHECK(merged.count() == 6);
+    CHECK(merged.sum() == 30 + 40 + 1000000);
+    CHECK(merged.max() == 1000000);
+    CHECK(merged.percentile(50) == 10);
+
+    // Перенос корзинами (как между агентами) даёт ту же гистограмму
+    std::vector<std::pair<size_t, uint64_t>> buckets;
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        if (b.bucketCount(i) > 0) {
+            buckets.emplace_back(i, b.bucketCount(i));
+        }
+    }
+    LatencyHistogram transferred = a;
+    transferred.addBuckets(buckets, b.sum(), b.max());
+    for (double p : {50.0, 90.0, 99.0, 100.0}) {
+        CHECK(transferred.percentile(p) == merged.percentile(p));
+    }
+
+    merged.subtract(a);
+    CHECK(merged.count() == b.count());
+    CHECK(merged.percentile(50) == b.percentile(50));
+}
+
+// === Генераторы и шаблоны тела ===
+
+FieldGenerator parseGenerator(const std::string& spec, const DataPools& pools = {}) {
+    FieldGenerator generator;
+    std::shared_ptr<const DataPool> pool_ref;
+    if (!FieldGenerator::parse(spec, pools, generator, pool_ref)) {
+        throw std::logic_error("unknown generator " + spec);
+    }
+    return generator;
+}
+
+void testGeneratorSpecs() {
+    FieldGenerator generator;
+    std::shared_ptr<const DataPool> pool_ref;
+    CHECK(!FieldGenerator::parse("uuid5", {}, generator, pool_ref));
+    CHECK(!FieldGenerator::parse("sqe:1", {}, generator, pool_ref));
+
+    CHECK(parseGenerator("int:1:100").kind == GeneratorKind::Uniform);
+    CHECK(!parseGenerator("int:1:100").quoted);
+    CHECK(parseGenerator("random").quoted);
+    CHECK(parseGenerator("seq:5:10").start == 5);
+    CHECK(parseGenerator("seq:5:10").step == 10);
+    CHECK(parseGenerator("uuid7").kind == GeneratorKind::Uuid7);
+    CHECK(parseGenerator("timestamp:iso").unit == TimestampUnit::Iso);
+    CHECK(parseGenerator("zipf:1000:1.1").kind == GeneratorKind::Zipf);
+    CHECK(parseGenerator("gauss:500:100:0:1000").clamp);
+
+    // Ошибки в аргументах
+    CHECK(throwsAs<std::invalid_argument>([] { parseGenerator("int:1"); }));
+    CHECK(throwsAs<std::invalid_argument>([] { parseGenerator("seq:a"); }));
+    CHECK(throwsAs<std::invalid_argument>([] { parseGenerator("uuid4:1"); }));
+    CHECK(throwsAs<std::invalid_argument>([] { parseGenerator("timestamp:h"); }));
+    CHECK(throwsAs<std::invalid_argument>([] { parseGenerator("pool:missing:email"); }));
+}
+
+void testGeneratorValues() {
+    Xoshiro256 rng(42);
+    GeneratorState state;
+
+    const std::regex uuid4("\"[0-9a-f]{8}-[0-9a-f]{4}-4[0-9a-f]{3}-[89ab][0-9a-f]{3}-[0-9a-f]{12}\"");
+    const FieldGenerator generator = parseGenerator("uuid4");
+    std::set<std::string> seen;
+    for (int i = 0; i < 100; ++i) {
+        std::string out;
+        generator.write(out, rng, state);
+        CHECK(out.size() <= generator.maxSize());
+        CHECK(std::regex_match(out, uuid4));
+        seen.insert(out);
+    }
+    CHECK(seen.size() == 100);
+
+    const FieldGenerator bounded = parseGenerator("int:-5:5");
+    for (int i = 0; i < 1000; ++i) {
+        std::string out;
+        bounded.write(out, rng, state);
+        const long value = std::stol(out);
+        CHECK(value >= -5 && value <= 5);
+    }
+}
+
+void testZipf() {
+    ZipfSampler zipf;
+    zipf.build(100, 1.0);
+    Xoshiro256 rng(7);
+    std::vector<int> counts(101, 0);
+    const int samples = 200000;
+    for (int i = 0; i < samples; ++i) {
+        const int64_t k = zipf.sample(rng);
+        CHECK(k >= 1 && k <= 100);
+        if (k >= 1 && k <= 100) {
+            ++counts[k];
+        }
+    }
+    // P(k) = 1 / (k * H_100), H_100 ~ 5.187
+    const double h100 = 5.187377517639621;
+    for (int k : {1, 2, 10}) {
+        const double expected = samples / (k * h100);
+        CHECK(std::fabs(counts[k] - expected) / expected < 0.05);
+    }
+    CHECK(counts[1] > counts[2] && counts[2] > counts[10]);
+}
+
+void testDataPool() {
+    TempFile csv(".csv", "id,email,note\n"
+                         "1,a@example.com,plain\n"
+                         "2,b@example.com,\"with, comma\"\n"
+                         "3,c@example.com,\"say \"\"hi\"\"\"\n");
+    auto pool = DataPool::load(csv.path());
+    CHECK(pool->rows() == 3);
+    CHECK(pool->columns() == 3);
+    CHECK(pool->column("email") == 1);
+    CHECK(pool->column("2") == 2);
+    CHECK(pool->column("missing") == -1);
+    CHECK(pool->cell(1, 2) == "with, comma");
+    CHECK(pool->cell(2, 2) == "say \\\"hi\\\"");
+    CHECK(pool->isNumeric(0));
+    CHECK(!pool->isNumeric(1));
+
+    TempFile header_only(".csv", "id,email\n");
+    CHECK(throwsAs<std::runtime_error>([&] { DataPool::load(header_only.path()); }));
+
+    // Поля одной таблицы в одном теле берут одну строку
+    DataPools pools{{"users", pool}};
+    BodyTemplate body = BodyTemplate::fromJson(
+        "{\"id\": \"{{pool:users:id:number}}\", \"email\": \"{{pool:users:email}}\"}", pools);
+    Xoshiro256 rng(1);
+    GeneratorState state;
+    body.initState(state, 0, 1);
+    for (int i = 0; i < 20; ++i) {
+        const nlohmann::json doc = nlohmann::json::parse(render(body, rng, state));
+        const int id = doc["id"].get<int>();
+        CHECK(doc["email"] == std::string(1, static_cast<char>('a' + id - 1)) + "@example.com");
+    }
+}
+
+void testBodyTemplates() {
+    Xoshiro256 rng(3);
+    GeneratorState state;
+
+    BodyTemplate nested = BodyTemplate::fromJson(
+        "{\"a\": {\"b\": [1, \"{{int:7:7}}\", \"{{random:3:3}}\"]}, \"c\": \"text\"}");
+    nested.initState(state, 0, 1);
+    CHECK(render(nested, rng, state) == "{\"a\":{\"b\":[1,7,\"3\"]},\"c\":\"text\"}");
+
+    // Последовательности чередуются между потоками (и агентами) без повторов
+    BodyTemplate seq = BodyTemplate::fromJson("{\"id\": \"{{seq:1}}\"}");
+    std::set<std::string> ids;
+    for (uint64_t thread = 0; thread < 4; ++thread) {
+        GeneratorState thread_state;
+        seq.initState(thread_state, thread, 4);
+        for (int i = 0; i < 25; ++i) {
+            ids.insert(render(seq, rng, thread_state));
+        }
+    }
+    CHECK(ids.size() == 100);
+    CHECK(ids.count("{\"id\":1}") == 1 && ids.count("{\"id\":100}") == 1);
+
+    // Поля конфигурации, в том числе по JSON Pointer
+    TestDataConfig config;
+    config["name"].value = "fixed";
+    config["/order/qty"].generator = "int:2:2";
+    BodyTemplate compiled = BodyTemplate::compile(config);
+    compiled.initState(state, 0, 1);
+    const nlohmann::json doc = nlohmann::json::parse(render(compiled, rng, state));
+    CHECK(doc["name"] == "fixed");
+    CHECK(doc["order"]["qty"] == 2);
+
+    // Опечатка в генераторе - ошибка, а не текст в теле
+    CHECK(throwsAs<std::invalid_argument>([] { BodyTemplate::fromJson("{\"a\": \"{{uuid5}}\"}"); }));
+    CHECK(throwsAs<std::invalid_argument>([] { BodyTemplate::fromJson("{\"a\": \"{{seq:x}}\"}"); }));
+    CHECK(throwsAs<nlohmann::json::exception>([] { BodyTemplate::fromJson("{\"a\": "); }));
+    TestDataConfig bad;
+    bad["x"].generator = "nope";
+    CHECK(throwsAs<std::invalid_argument>([&] { BodyTemplate::compile(bad); }));
+}
+
+// === Проверки ответа и выбор сценария ===
+
+void testResponseMatcher() {
+    ResponseMatcher matcher;
+    matcher.setBodyChecks({{"success", "true", true},
+                           {"data.status", "ok", true},
+                           {"items[1].id", "7", true},
+                           {"meta", "", true}});
+    const std::string good =
+        "{\"skip\": {\"deep\": [1, {\"x\": \"}\"}]}, \"success\": true, \"data\": {\"status\": \"ok\"},"
+        " \"items\": [{\"id\": 1}, {\"id\": 7.0}], \"meta\": null}";
+    CHECK(matcher.matchBody(good.data(), good.size()));
+
+    const std::string wrong_value = "{\"success\": true, \"data\": {\"status\": \"fail\"},"
+                                    " \"items\": [{\"id\": 1}, {\"id\": 7}], \"meta\": 1}";
+    CHECK(!matcher.matchBody(wrong_value.data(), wrong_value.size()));
+    const std::string missing = "{\"success\": true, \"data\": {\"status\": \"ok\"}, \"items\": [{\"id\": 7}]}";
+    CHECK(!matcher.matchBody(missing.data(), missing.size()));
+    const std::string truncated = "{\"success\": true, \"data\": {\"status\": \"ok\"";
+    CHECK(!matcher.matchBody(truncated.data(), truncated.size()));
+
+    ResponseMatcher any_json;
+    const std::string valid = "[1, 2, {\"a\": \"b\"}]";
+    const std::string invalid = "not json";
+    CHECK(any_json.matchBody(valid.data(), valid.size()));
+    CHECK(!any_json.matchBody(invalid.data(), invalid.size()));
+
+    CHECK(matcher.statusAccepted(200));
+    CHECK(!matcher.statusAccepted(503));
+    matcher.setBodySizeLimits(2, 10);
+    CHECK(!matcher.bodySizeAccepted(1));
+    CHECK(matcher.bodySizeAccepted(10));
+    CHECK(!matcher.bodySizeAccepted(11));
+}
+
+void testAliasSampler() {
+    AliasSampler sampler;
+    sampler.build({1.0, 0.0, 3.0});
+    Xoshiro256 rng(11);
+    std::vector<int> counts(3, 0);
+    const int samples = 100000;
+    for (int i = 0; i < samples; ++i) {
+        ++counts[sampler.sample(rng)];
+    }
+    CHECK(counts[1] == 0);
+    CHECK(std::fabs(counts[2] / static_cast<double>(samples) - 0.75) < 0.01);
+
+    CHECK(throwsAs<std::invalid_argument>([&] { sampler.build({1.0, -1.0}); }));
+    CHECK(throwsAs<std::invalid_argument>([&] { sampler.build({0.0, 0.0}); }));
+}
+
+void testCpuList() {
+    std::vector<int> cpus;
+    CHECK(parseCpuList("0-3,8,10-11", cpus));
+    CHECK((cpus == std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    std::vector<int> untouched{5};
+    CHECK(!parseCpuList("3-1", untouched));
+    CHECK(!parseCpuList("a", untouched));
+    CHECK((untouched == std::vector<int>{5}));
+}
+
+// === Воспроизведение записей ===
+
+std::string recordUrl(const ReplayRecord& record) {
+    return std::string(record.url, record.url_size);
+}
+
+void testReplayJsonl() {
+    TempFile jsonl(".jsonl",
+                   "{\"ts\": 100.0, \"method\": \"POST\", \"url\": \"http://h/a\", \"body\": {\"x\": 1}}\n"
+                   "\n"
+                   "{\"timestamp\": \"1970-01-01T00:01:40.500Z\", \"method\": \"GET\", \"url\": \"http://h/b\"}\n"
+                   "{\"ts\": 102.0, \"url\": \"http://h/c\", \"body\": \"raw \\\"text\\\"\"}\n");
+    ReplaySource source;
+    source.open(jsonl.path());
+    CHECK(source.size() == 3);
+    CHECK(source.hasTimestamps());
+    CHECK(std::fabs(source.spanSeconds() - 2.0) < 1e-6);
+
+    ReplayRecord record;
+    CHECK(source.next(record));
+    CHECK(std::string(record.method, record.method_size) == "POST");
+    CHECK(recordUrl(record) == "http://h/a");
+    CHECK(std::string(record.body, record.body_size) == "{\"x\": 1}");
+    CHECK(record.offset_ns == 0);
+    CHECK(source.next(record));
+    CHECK(recordUrl(record) == "http://h/b");
+    CHECK(record.body == nullptr);
+    CHECK(record.offset_ns == 500000000);
+    CHECK(source.next(record));
+    CHECK(record.body_escaped);
+    CHECK(!source.next(record));
+
+    // Доли распределённого теста: каждая N-я запись
+    source.setPartition(1, 2);
+    source.rewind();
+    CHECK(source.next(record));
+    CHECK(recordUrl(record) == "http://h/b");
+    CHECK(!source.next(record));
+}
+
+void testReplayHar() {
+    TempFile har(".har", R"({"log": {"version": "1.2", "entries": [
+        {"startedDateTime": "2024-01-01T00:00:00.000Z",
+         "request": {"method": "POST", "url": "http://h/one", "postData": {"text": "{\"a\":1}"}}},
+        {"startedDateTime": "2024-01-01T00:00:01.250Z",
+         "request": {"method": "GET", "url": "http://h/two"}}
+    ]}})");
+    ReplaySource source;
+    source.open(har.path());
+    CHECK(source.size() == 2);
+    CHECK(source.hasTimestamps());
+    CHECK(std::fabs(source.spanSeconds() - 1.25) < 1e-6);
+
+    ReplayRecord record;
+    CHECK(source.next(record));
+    CHECK(recordUrl(record) == "http://h/one");
+    CHECK(record.body != nullptr);
+    CHECK(source.next(record));
+    CHECK(std::string(record.method, record.method_size) == "GET");
+    CHECK(record.offset_ns == 1250000000);
+
+    TempFile empty(".jsonl", "\n\n");
+    CHECK(throwsAs<std::runtime_error>([&] { ReplaySource broken; broken.open(empty.path()); }));
+}
+
+// === Пороги регрессии ===
+
+nlohmann::json summary(double p99, double rps, double error_rate, long success) {
+    return {{"latency_ms", {{"p99", p99}}}, {"throughput", {{"rps", rps}}}, {"error_rate", error_rate},
+            {"requests", {{"completed", success}, {"success", success}}}};
+}
+
+const GateCheck* findCheck(const std::vector<GateCheck>& checks, const std::string& name) {
+    for (const auto& check : checks) {
+        if (check.name == name) {
+            return &check;
+        }
+    }
+    return nullptr;
+}
+
+void testRegressionGate() {
+    const nlohmann::json baseline = summary(10, 1000, 0.001, 10000);
+    GateThresholds thresholds;
+    thresholds.max_p99_increase = 20;
+    thresholds.max_throughput_drop = 5;
+    thresholds.max_error_rate = 0.5;
+
+    auto checks = checkGates(summary(11.9, 960, 0.004, 9600), &baseline, thresholds);
+    CHECK(checks.size() == 4);
+    for (const auto& check : checks) {
+        CHECK(check.passed);
+    }
+    CHECK(std::fabs(findCheck(checks, "p99_ms")->limit - 12) < 1e-9);
+    CHECK(std::fabs(findCheck(checks, "throughput_rps")->limit - 950) < 1e-9);
+    CHECK(std::fabs(findCheck(checks, "error_rate_pct")->current - 0.4) < 1e-9);
+
+    checks = checkGates(summary(12.1, 940, 0.006, 9400), &baseline, thresholds);
+    CHECK(!findCheck(checks, "p99_ms")->passed);
+    CHECK(!findCheck(checks, "throughput_rps")->passed);
+    CHECK(!findCheck(checks, "error_rate_pct")->passed);
+
+    // Без эталона проверяются только абсолютные пороги
+    thresholds.max_p99_ms = 5;
+    checks = checkGates(summary(4, 100, 0, 100), nullptr, thresholds);
+    CHECK(findCheck(checks, "p99_ms") == nullptr);
+    CHECK(findCheck(checks, "p99_ms_limit")->passed);
+
+    // Прогон без успешных ответов не проходит, даже если задержка и ошибки "в норме"
+    checks = checkGates(summary(0, 0, 0, 0), nullptr, GateThresholds{});
+    CHECK(checks.size() == 1);
+    CHECK(!findCheck(checks, "requests_succeeded")->passed);
+}
+
+} // namespace
+
+int main() {
+    const std::vector<std::pair<const char*, void (*)()>> tests = {
+        {"histogram buckets", testHistogramBuckets},
+        {"histogram percentiles", testHistogramPercentiles},
+        {"histogram merge", testHistogramMergeAndSubtract},
+        {"generator specs", testGeneratorSpecs},
+        {"generator values", testGeneratorValues},
+        {"zipf", testZipf},
+        {"data pool", testDataPool},
+        {"body templates", testBodyTemplates},
+        {"response matcher", testResponseMatcher},
+        {"alias sampler", testAliasSampler},
+        {"cpu list", testCpuList},
+        {"replay jsonl", testReplayJsonl},
+        {"replay har", testReplayHar},
+        {"regression gate", testRegressionGate},
+    };
+    for (const auto& [name, test] : tests) {
+        const int before = failures;
+        test();
+        std::printf("%-24s %s\n", name, failures == before ? "ok" : "FAILED");
+    }
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+    }
+    return failures > 0 ? 1 : 0;
+}
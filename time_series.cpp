@@ -0,0 +1,60 @@
+/// @file time_series.cpp
+/// @brief Реализация записи временного ряда метрик
+
+#include "time_series.hpp"
+
+#include <iomanip>
+
+/// @brief Оканчивается ли строка на suffix
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool TimeSeriesWriter::open(const std::string& path) {
+    out_.close();
+    out_.open(path, std::ios::trunc);
+    if (!out_) {
+        return false;
+    }
+    jsonl_ = endsWith(path, ".jsonl") || endsWith(path, ".ndjson");
+    if (!jsonl_) {
+        out_ << "unix_ms,elapsed_s,interval_s,attempted,completed,succeeded,check_failed,"
+                "http_errors,transport_errors,in_flight,rps,p50_ms,p90_ms,p99_ms,max_ms\n";
+        out_.flush();
+    }
+    return true;
+}
+
+void TimeSeriesWriter::write(const TimeSeriesRow& row) {
+    if (!out_.is_open()) {
+        return;
+    }
+
+    double rps = row.interval_seconds > 0 ? row.completed / row.interval_seconds : 0;
+    out_ << std::fixed << std::setprecision(3);
+    if (jsonl_) {
+        out_ << "{\"unix_ms\":" << row.unix_ms
+             << ",\"elapsed_s\":" << row.elapsed_seconds
+             << ",\"interval_s\":" << row.interval_seconds
+             << ",\"attempted\":" << row.attempted
+             << ",\"completed\":" << row.completed
+             << ",\"succeeded\":" << row.succeeded
+             << ",\"check_failed\":" << row.check_failed
+             << ",\"http_errors\":" << row.http_errors
+             << ",\"transport_errors\":" << row.transport_errors
+             << ",\"in_flight\":" << row.in_flight
+             << ",\"rps\":" << rps
+             << ",\"p50_ms\":" << row.p50_ns / 1e6
+             << ",\"p90_ms\":" << row.p90_ns / 1e6
+             << ",\"p99_ms\":" << row.p99_ns / 1e6
+             << ",\"max_ms\":" << row.max_ns / 1e6 << "}\n";
+    } else {
+        out_ << row.unix_ms << ',' << row.elapsed_seconds << ',' << row.interval_seconds << ','
+             << row.attempted << ',' << row.completed << ',' << row.succeeded << ','
+             << row.check_failed << ',' << row.http_errors << ',' << row.transport_errors << ','
+             << row.in_flight << ',' << rps << ',' << row.p50_ns / 1e6 << ','
+             << row.p90_ns / 1e6 << ',' << row.p99_ns / 1e6 << ',' << row.max_ns / 1e6 << '\n';
+    }
+    out_.flush();
+}
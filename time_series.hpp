@@ -0,0 +1,60 @@
+/// @file time_series.hpp
+/// @brief Посекундный временной ряд метрик теста
+
+#ifndef TIME_SERIES_HPP
+#define TIME_SERIES_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/**
+ * @struct TimeSeriesRow
+ * @brief Одна секунда теста
+ *
+ * Счётчики - приращения за интервал строки, задержки - перцентили
+ * запросов, завершённых в этом интервале.
+ */
+struct TimeSeriesRow {
+    int64_t unix_ms = 0;            //< Конец интервала, мс от эпохи UNIX (для сверки с логами сервера)
+    double elapsed_seconds = 0;     //< Конец интервала от начала теста
+    double interval_seconds = 0;    //< Длина интервала
+    long attempted = 0;             //< Отправлено запросов
+    long completed = 0;             //< Завершено (с ответом или с ошибкой)
+    long succeeded = 0;             //< Прошли проверки ответа
+    long check_failed = 0;          //< Не прошли проверки ответа
+    long http_errors = 0;           //< Недопустимый код HTTP
+    long transport_errors = 0;      //< Ошибки CURL
+    long in_flight = 0;             //< Запросов в полёте на конец интервала
+    uint64_t p50_ns = 0;
+    uint64_t p90_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+/**
+ * @class TimeSeriesWriter
+ * @brief Запись временного ряда в CSV или JSONL
+ *
+ * Формат выбирается по расширению файла: ".jsonl" или ".ndjson" - JSON Lines,
+ * иначе CSV с заголовком. Каждая строка сбрасывается на диск сразу, чтобы
+ * ряд можно было смотреть во время теста.
+ */
+class TimeSeriesWriter {
+public:
+    /// @brief Открывает файл (перезаписывает)
+    bool open(const std::string& path);
+
+    bool isOpen() const { return out_.is_open(); }
+
+    /// @brief Дописывает строку
+    void write(const TimeSeriesRow& row);
+
+    void close() { out_.close(); }
+
+private:
+    std::ofstream out_;
+    bool jsonl_ = false;
+};
+
+#endif // TIME_SERIES_HPP
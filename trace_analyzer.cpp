@@ -0,0 +1,327 @@
+/// @file trace_analyzer.cpp
+/// @brief Разбор двоичной трассы запросов: перцентили по окну времени и фильтрам
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "latency_histogram.hpp"
+#include "request_trace.hpp"
+
+namespace {
+
+constexpr size_t kOutcomeCount = static_cast<size_t>(TraceOutcome::Cancelled) + 1;
+
+enum class TimeBase { Scheduled, Start, End };
+
+/// @brief Фильтры и режим разбора
+struct Options {
+    std::string path;
+    double from_s = -1;             //< Начало окна от начала теста, с (отрицательное - с начала)
+    double to_s = -1;               //< Конец окна (отрицательное - до конца)
+    TimeBase by = TimeBase::End;    //< По какому моменту записи отбирать и группировать
+    bool service_time = false;      //< Задержка от фактической отправки, а не от запланированной
+    int scenario = -1;
+    int thread = -1;
+    int status = -1;
+    int outcome = -1;               //< TraceOutcome или -1
+    bool failed_only = false;       //< Только неудачные (HTTP, CURL, проверки)
+    double window_s = 0;            //< Длина интервала таблицы (0 - без таблицы)
+    unsigned threads = 0;           //< Потоков разбора (0 - по числу ядер)
+};
+
+/// @brief Итоги разбора части файла
+struct Accumulator {
+    LatencyHistogram latency;
+    uint64_t matched = 0;
+    uint64_t outcomes[kOutcomeCount] = {};
+    uint64_t new_connections = 0;
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+    int64_t first_ns = INT64_MAX;   //< Крайние моменты отобранных записей (от начала теста)
+    int64_t last_ns = INT64_MIN;
+    std::map<int64_t, std::unique_ptr<LatencyHistogram>> windows; //< Номер интервала - задержки
+
+    void merge(Accumulator& other) {
+        latency.merge(other.latency);
+        matched += other.matched;
+        for (size_t i = 0; i < kOutcomeCount; ++i) {
+            outcomes[i] += other.outcomes[i];
+        }
+        new_connections += other.new_connections;
+        bytes_received += other.bytes_received;
+        bytes_sent += other.bytes_sent;
+        first_ns = std::min(first_ns, other.first_ns);
+        last_ns = std::max(last_ns, other.last_ns);
+        for (auto& entry : other.windows) {
+            auto& target = windows[entry.first];
+            if (target) {
+                target->merge(*entry.second);
+            } else {
+                target = std::move(entry.second);
+            }
+        }
+    }
+};
+
+const char* outcomeName(size_t outcome) {
+    static const char* const kNames[kOutcomeCount] = {"success", "check_failed", "http_error",
+                                                      "transport_error", "cancelled"};
+    return outcome < kOutcomeCount ? kNames[outcome] : "unknown";
+}
+
+bool parseOutcome(const std::string& name, Options& options) {
+    for (size_t i = 0; i < kOutcomeCount; ++i) {
+        if (name == outcomeName(i)) {
+            options.outcome = static_cast<int>(i);
+            return true;
+        }
+    }
+    if (name == "failed") {
+        options.failed_only = true;
+        return true;
+    }
+    return false;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " TRACE [--from S] [--to S] [--by scheduled|start|end]\n"
+              << "       [--service-time] [--scenario N] [--thread N] [--status CODE]\n"
+              << "       [--outcome success|check_failed|http_error|transport_error|cancelled|failed]\n"
+              << "       [--window S] [--threads N]" << std::endl;
+}
+
+/// @brief Разбирает записи [begin, end) с учётом фильтров
+void scan(const TraceRecord* begin, const TraceRecord* end, int64_t origin_ns, const Options& options,
+          Accumulator& acc) {
+    const int64_t from_ns = options.from_s < 0 ? INT64_MIN : static_cast<int64_t>(options.from_s * 1e9);
+    const int64_t to_ns = options.to_s < 0 ? INT64_MAX : static_cast<int64_t>(options.to_s * 1e9);
+    const int64_t window_ns = static_cast<int64_t>(options.window_s * 1e9);
+    LatencyHistogram* window = nullptr;
+    int64_t window_index = INT64_MIN;
+
+    for (const TraceRecord* r = begin; r != end; ++r) {
+        const int64_t base = options.by == TimeBase::Scheduled ? r->scheduled_ns
+                           : options.by == TimeBase::Start ? r->start_ns : r->end_ns;
+        const int64_t t = base - origin_ns;
+        if (t < from_ns || t >= to_ns) {
+            continue;
+        }
+        const size_t outcome = static_cast<size_t>(r->outcome);
+        if ((options.scenario >= 0 && r->scenario != options.scenario) ||
+            (options.thread >= 0 && r->thread_id != options.thread) ||
+            (options.status >= 0 && r->status != options.status) ||
+            (options.outcome >= 0 && static_cast<int>(outcome) != options.outcome) ||
+            (options.failed_only && (r->outcome == TraceOutcome::Success || r->outcome == TraceOutcome::Cancelled))) {
+            continue;
+        }
+
+        ++acc.matched;
+        if (outcome < kOutcomeCount) {
+            ++acc.outcomes[outcome];
+        }
+        acc.new_connections += (r->flags & kTraceNewConnection) ? 1 : 0;
+        acc.bytes_received += r->bytes_received;
+        acc.bytes_sent += r->bytes_sent;
+        acc.first_ns = std::min(acc.first_ns, t);
+        acc.last_ns = std::max(acc.last_ns, t);
+
+        // Прерванные остановкой запросы в задержки не входят - как в итогах теста
+        if (r->outcome == TraceOutcome::Cancelled) {
+            continue;
+        }
+        const int64_t latency = r->end_ns - (options.service_time ? r->start_ns : r->scheduled_ns);
+        const uint64_t latency_ns = latency > 0 ? static_cast<uint64_t>(latency) : 0;
+        acc.latency.record(latency_ns);
+
+        if (window_ns > 0) {
+            // Записи почти упорядочены по времени - интервал обычно тот же, что у предыдущей
+            const int64_t index = t / window_ns;
+            if (index != window_index) {
+                auto& slot = acc.windows[index];
+                if (!slot) {
+                    slot = std::make_unique<LatencyHistogram>();
+                }
+                window = slot.get();
+                window_index = index;
+            }
+            window->record(latency_ns);
+        }
+    }
+}
+
+void printLatency(const char* label, const LatencyHistogram& latency) {
+    std::printf("%s count %llu  mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f ms\n",
+                label, static_cast<unsigned long long>(latency.count()), latency.mean() / 1e6,
+                latency.percentile(50) / 1e6, latency.percentile(90) / 1e6, latency.percentile(99) / 1e6,
+                latency.percentile(99.9) / 1e6, latency.max() / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "--from") == 0 && has_value) {
+            options.from_s = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--to") == 0 && has_value) {
+            options.to_s = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--by") == 0 && has_value) {
+            const std::string by = argv[++i];
+            if (by == "scheduled") {
+                options.by = TimeBase::Scheduled;
+            } else if (by == "start") {
+                options.by = TimeBase::Start;
+            } else if (by == "end") {
+                options.by = TimeBase::End;
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else if (std::strcmp(arg, "--service-time") == 0) {
+            options.service_time = true;
+        } else if (std::strcmp(arg, "--scenario") == 0 && has_value) {
+            options.scenario = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--thread") == 0 && has_value) {
+            options.thread = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--status") == 0 && has_value) {
+            options.status = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--outcome") == 0 && has_value) {
+            if (!parseOutcome(argv[++i], options)) {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else if (std::strcmp(arg, "--window") == 0 && has_value) {
+            options.window_s = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--threads") == 0 && has_value) {
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg[0] != '-' && options.path.empty()) {
+            options.path = arg;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.path.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    int fd = ::open(options.path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st {};
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "Cannot open " << options.path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    TraceFileHeader header;
+    if (size < sizeof(header) || ::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        std::memcmp(header.magic, TraceFileHeader::kMagic, sizeof(header.magic)) != 0) {
+        std::cerr << options.path << " is not a request trace" << std::endl;
+        return 1;
+    }
+    if (header.version != TraceFileHeader::kVersion || header.record_size != sizeof(TraceRecord)) {
+        std::cerr << "Unsupported trace version " << header.version << " (record size "
+                  << header.record_size << ")" << std::endl;
+        return 1;
+    }
+
+    // Незакрытый файл (тест прерван) читается по размеру, неполная последняя запись отбрасывается
+    size_t count = (size - sizeof(header)) / sizeof(TraceRecord);
+    if (header.record_count > 0 && header.record_count < count) {
+        count = static_cast<size_t>(header.record_count);
+    }
+    const TraceRecord* records = nullptr;
+    void* mapped = nullptr;
+    if (count > 0) {
+        mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Cannot map " << options.path << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        records = reinterpret_cast<const TraceRecord*>(static_cast<const char*>(mapped) + sizeof(header));
+    }
+    ::close(fd);
+
+    // Файл делится на равные куски по потокам; итоги кусков сливаются
+    unsigned threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, count / 65536)));
+    std::vector<Accumulator> parts(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        const size_t begin = count * t / threads;
+        const size_t end = count * (t + 1) / threads;
+        workers.emplace_back([&, t, begin, end] {
+            scan(records + begin, records + end, header.origin_ns, options, parts[t]);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    Accumulator total = std::move(parts.front());
+    for (unsigned t = 1; t < threads; ++t) {
+        total.merge(parts[t]);
+    }
+    if (mapped) {
+        munmap(mapped, size);
+    }
+
+    const time_t origin_s = static_cast<time_t>(header.origin_unix_ns / 1000000000);
+    char origin_text[64];
+    std::strftime(origin_text, sizeof(origin_text), "%Y-%m-%d %H:%M:%S", std::gmtime(&origin_s));
+    std::printf("Trace: %s, %zu records, test started %s UTC\n", options.path.c_str(), count, origin_text);
+    if (header.record_count == 0) {
+        std::printf("Trace was not closed cleanly: records counted by file size\n");
+    }
+    if (header.dropped > 0) {
+        std::printf("Dropped while recording: %llu\n", static_cast<unsigned long long>(header.dropped));
+    }
+
+    std::printf("Matched: %llu\n", static_cast<unsigned long long>(total.matched));
+    if (total.matched == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < kOutcomeCount; ++i) {
+        if (total.outcomes[i] > 0) {
+            std::printf("  %-16s %llu\n", outcomeName(i), static_cast<unsigned long long>(total.outcomes[i]));
+        }
+    }
+    const double span_s = (total.last_ns - total.first_ns) / 1e9;
+    std::printf("Span: %.3f .. %.3f s", total.first_ns / 1e9, total.last_ns / 1e9);
+    if (span_s > 0) {
+        std::printf(", %.1f requests/s", total.matched / span_s);
+    }
+    std::printf("\nNew connections: %llu\n", static_cast<unsigned long long>(total.new_connections));
+    std::printf("Bytes: %llu received, %llu sent\n", static_cast<unsigned long long>(total.bytes_received),
+                static_cast<unsigned long long>(total.bytes_sent));
+    printLatency(options.service_time ? "Service time:" : "Latency:", total.latency);
+
+    if (options.window_s > 0 && !total.windows.empty()) {
+        std::printf("\n%10s %10s %10s %10s %10s %10s\n", "from s", "count", "rps", "p50 ms", "p99 ms", "max ms");
+        for (const auto& entry : total.windows) {
+            const LatencyHistogram& window = *entry.second;
+            std::printf("%10.1f %10llu %10.1f %10.3f %10.3f %10.3f\n", entry.first * options.window_s,
+                        static_cast<unsigned long long>(window.count()), window.count() / options.window_s,
+                        window.percentile(50) / 1e6, window.percentile(99) / 1e6, window.max() / 1e6);
+        }
+    }
+    return 0;
+}
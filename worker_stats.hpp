@@ -0,0 +1,113 @@
+/// @file worker_stats.hpp
+/// @brief Счётчики рабочих потоков без разделяемых кэш-линий
+
+#ifndef WORKER_STATS_HPP
+#define WORKER_STATS_HPP
+
+#include <atomic>
+
+/// @brief Увеличивает счётчик, в который пишет только один поток
+/// @details relaxed load + store вместо fetch_add: без lock-префикса и
+/// без захвата кэш-линии в эксклюзивное владение у читателей
+inline void bumpCounter(std::atomic<long>& counter, long delta = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+struct CounterTotals;
+
+/**
+ * @struct WorkerCounters
+ * @brief Шард счётчиков одного рабочего потока
+ *
+ * Выровнен по кэш-линии, чтобы счётчики разных потоков не делили
+ * линию (false sharing). Пишет только поток-владелец, поток отчётов
+ * читает relaxed-загрузками и суммирует шарды.
+ */
+struct alignas(64) WorkerCounters {
+    std::atomic<long> requests_started{0};      //< Отправленные запросы
+    std::atomic<long> requests_sent{0};         //< Запросы с допустимым кодом HTTP
+    std::atomic<long> requests_failed{0};       //< Неудачные запросы
+    std::atomic<long> requests_cancelled{0};    //< Прерванные остановкой теста (не входят в итоги)
+    std::atomic<long> http_errors{0};           //< Из них: недопустимый код HTTP
+    std::atomic<long> transport_errors{0};      //< Из них: ошибки CURL
+    std::atomic<long> success_responses{0};     //< Ответы, прошедшие проверки
+    std::atomic<long> error_responses{0};       //< Ответы, не прошедшие проверки
+    std::atomic<long> connections_opened{0};    //< Открытые соединения
+    std::atomic<long> connections_reused{0};    //< Запросы по уже открытому соединению
+    std::atomic<long> http2_streams{0};         //< Ответы, полученные потоком HTTP/2
+
+    /// @brief Обнуляет шард (когда в него никто не пишет)
+    void reset();
+
+    /// @brief Атомарно прибавляет итоги (для редких слияний из нескольких потоков)
+    void accumulate(const CounterTotals& totals);
+};
+
+/**
+ * @struct CounterTotals
+ * @brief Сумма шардов счётчиков на момент чтения
+ */
+struct CounterTotals {
+    long requests_started = 0;
+    long requests_sent = 0;
+    long requests_failed = 0;
+    long requests_cancelled = 0;
+    long http_errors = 0;
+    long transport_errors = 0;
+    long success_responses = 0;
+    long error_responses = 0;
+    long connections_opened = 0;
+    long connections_reused = 0;
+    long http2_streams = 0;
+
+    /// @brief Прибавляет текущие значения шарда
+    void add(const WorkerCounters& c) {
+        requests_started += c.requests_started.load(std::memory_order_relaxed);
+        requests_sent += c.requests_sent.load(std::memory_order_relaxed);
+        requests_failed += c.requests_failed.load(std::memory_order_relaxed);
+        requests_cancelled += c.requests_cancelled.load(std::memory_order_relaxed);
+        http_errors += c.http_errors.load(std::memory_order_relaxed);
+        transport_errors += c.transport_errors.load(std::memory_order_relaxed);
+        success_responses += c.success_responses.load(std::memory_order_relaxed);
+        error_responses += c.error_responses.load(std::memory_order_relaxed);
+        connections_opened += c.connections_opened.load(std::memory_order_relaxed);
+        connections_reused += c.connections_reused.load(std::memory_order_relaxed);
+        http2_streams += c.http2_streams.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Завершённые запросы (с ответом или с ошибкой)
+    long completed() const { return requests_sent + requests_failed; }
+
+    /// @brief Запросы в полёте
+    long inFlight() const { return requests_started - completed() - requests_cancelled; }
+};
+
+inline void WorkerCounters::reset() {
+    requests_started.store(0, std::memory_order_relaxed);
+    requests_sent.store(0, std::memory_order_relaxed);
+    requests_failed.store(0, std::memory_order_relaxed);
+    requests_cancelled.store(0, std::memory_order_relaxed);
+    http_errors.store(0, std::memory_order_relaxed);
+    transport_errors.store(0, std::memory_order_relaxed);
+    success_responses.store(0, std::memory_order_relaxed);
+    error_responses.store(0, std::memory_order_relaxed);
+    connections_opened.store(0, std::memory_order_relaxed);
+    connections_reused.store(0, std::memory_order_relaxed);
+    http2_streams.store(0, std::memory_order_relaxed);
+}
+
+inline void WorkerCounters::accumulate(const CounterTotals& totals) {
+    requests_started.fetch_add(totals.requests_started, std::memory_order_relaxed);
+    requests_sent.fetch_add(totals.requests_sent, std::memory_order_relaxed);
+    requests_failed.fetch_add(totals.requests_failed, std::memory_order_relaxed);
+    requests_cancelled.fetch_add(totals.requests_cancelled, std::memory_order_relaxed);
+    http_errors.fetch_add(totals.http_errors, std::memory_order_relaxed);
+    transport_errors.fetch_add(totals.transport_errors, std::memory_order_relaxed);
+    success_responses.fetch_add(totals.success_responses, std::memory_order_relaxed);
+    error_responses.fetch_add(totals.error_responses, std::memory_order_relaxed);
+    connections_opened.fetch_add(totals.connections_opened, std::memory_order_relaxed);
+    connections_reused.fetch_add(totals.connections_reused, std::memory_order_relaxed);
+    http2_streams.fetch_add(totals.http2_streams, std::memory_order_relaxed);
+}
+
+#endif // WORKER_STATS_HPP